@@ -1,6 +1,10 @@
 #include "conf.hpp"
+#include <algorithm>
 #include <boost/program_options/parsers.hpp>
+#include <charconv>
 #include <expected>
+#include <optional>
+#include <ranges>
 #include <string_view>
 #include <unordered_set>
 
@@ -12,6 +16,130 @@ namespace po = boost::program_options;
 const static std::unordered_set<std::string_view> kValidLogLevels = {"trace",   "debug", "info",
                                                                      "warning", "error", "fatal"};
 
+const static std::unordered_set<std::string_view> kValidStorageBackends = {"redis", "log"};
+
+const static std::unordered_set<std::string_view> kValidRedisLayouts = {"keys", "buckets"};
+
+namespace
+{
+// Parses one "host:port" entry; nullopt if it is malformed.
+auto parse_redis_node(std::string_view entry) -> std::optional<RedisNode>
+{
+    const auto colon = entry.rfind(':');
+    if (colon == std::string_view::npos || colon == 0)
+    {
+        return std::nullopt;
+    }
+
+    int port = 0;
+    const auto port_text = entry.substr(colon + 1);
+    const auto [end, ec] = std::from_chars(port_text.data(), port_text.data() + port_text.size(), port);
+    if (ec != std::errc{} || end != port_text.data() + port_text.size() || port < kMinPort || port > kMaxPort)
+    {
+        return std::nullopt;
+    }
+
+    return RedisNode{.host = std::string{entry.substr(0, colon)}, .port = port};
+}
+
+// Parses a comma-separated "host:port" list; nullopt if any entry is malformed.
+auto parse_redis_nodes(std::string_view spec) -> std::optional<std::vector<RedisNode>>
+{
+    std::vector<RedisNode> nodes;
+    for (const auto part : std::views::split(spec, ','))
+    {
+        const std::string_view entry{part.begin(), part.end()};
+        if (entry.empty())
+        {
+            continue;
+        }
+
+        auto node = parse_redis_node(entry);
+        if (!node)
+        {
+            return std::nullopt;
+        }
+        if (std::ranges::any_of(nodes, [&](const RedisNode &other)
+                                { return other.host == node->host && other.port == node->port; }))
+        {
+            return std::nullopt; // a node listed twice would skew the hash ring
+        }
+        nodes.push_back(std::move(*node));
+    }
+    return nodes;
+}
+
+// Parses comma-separated replica groups, one per node in order, each a '|'-separated "host:port" list.
+// Empty groups are allowed for nodes without replicas; nullopt if any entry is malformed.
+auto parse_redis_replicas(std::string_view spec) -> std::optional<std::vector<std::vector<RedisNode>>>
+{
+    std::vector<std::vector<RedisNode>> groups;
+    if (spec.empty())
+    {
+        return groups;
+    }
+
+    for (const auto group_part : std::views::split(spec, ','))
+    {
+        auto &group = groups.emplace_back();
+        for (const auto part : std::views::split(std::string_view{group_part.begin(), group_part.end()}, '|'))
+        {
+            const std::string_view entry{part.begin(), part.end()};
+            if (entry.empty())
+            {
+                continue;
+            }
+
+            auto replica = parse_redis_node(entry);
+            if (!replica)
+            {
+                return std::nullopt;
+            }
+            group.push_back(std::move(*replica));
+        }
+    }
+    return groups;
+}
+
+// Parses a comma-separated CPU list with ranges ("0-3,8"); nullopt if any entry is malformed.
+auto parse_cpu_list(std::string_view spec) -> std::optional<std::vector<int>>
+{
+    auto parse_cpu = [](std::string_view text) -> std::optional<int>
+    {
+        int cpu = 0;
+        const auto [end, ec] = std::from_chars(text.data(), text.data() + text.size(), cpu);
+        if (ec != std::errc{} || end != text.data() + text.size() || cpu < 0)
+        {
+            return std::nullopt;
+        }
+        return cpu;
+    };
+
+    std::vector<int> cpus;
+    for (const auto part : std::views::split(spec, ','))
+    {
+        const std::string_view entry{part.begin(), part.end()};
+        if (entry.empty())
+        {
+            continue;
+        }
+
+        const auto dash = entry.find('-');
+        const auto first = parse_cpu(entry.substr(0, dash));
+        const auto last = dash == std::string_view::npos ? first : parse_cpu(entry.substr(dash + 1));
+        if (!first || !last || *last < *first)
+        {
+            return std::nullopt;
+        }
+        for (auto cpu = *first; cpu <= *last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+} // namespace
+
 // NOLINTNEXTLINE(cppcoreguidelines-avoid-c-arrays, modernize-avoid-c-arrays)
 auto Config::load(const int &argc, const char *argv[]) -> std::expected<void, ConfigError>
 {
@@ -23,11 +151,96 @@ auto Config::load(const int &argc, const char *argv[]) -> std::expected<void, Co
             "address,a", po::value<std::string>(&address_)->default_value(std::string(kDefaultAddress)),
             "Server bind address")("port,p", po::value<int>(&port_)->default_value(kDefaultPort), "Server port")(
             "threads,t", po::value<int>(&threads_)->default_value(kMinThreads), "Number of worker threads")(
+            "thread-per-core", po::bool_switch(&thread_per_core_),
+            "Give every worker thread its own io_context, SO_REUSEPORT acceptor and Redis connections")(
+            "cpu-affinity", po::value<std::string>(&cpu_affinity_spec_)->default_value(""),
+            "CPUs to pin worker threads to, e.g. 0-3,8 (default: unpinned, or one CPU each with --thread-per-core)")(
+            "max-body-bytes", po::value<std::size_t>(&max_body_bytes_)->default_value(kDefaultMaxBodyBytes),
+            "Maximum request body size in bytes")(
+            "batch-max-urls", po::value<int>(&batch_max_urls_)->default_value(kDefaultBatchMaxUrls),
+            "Maximum number of URLs in one batch create request")(
             "log-level,l", po::value<std::string>(&log_level_)->default_value(std::string(kDefaultLogLevel)),
             "Log level (trace, debug, info, warning, error, fatal)")(
+            "storage-backend",
+            po::value<std::string>(&storage_backend_)->default_value(std::string(kDefaultStorageBackend)),
+            "Storage backend (redis, log)")(
+            "log-store-path",
+            po::value<std::string>(&log_store_path_)->default_value(std::string(kDefaultLogStorePath)),
+            "Path of the embedded log store file (log backend)")(
+            "log-store-sync-ms", po::value<int>(&log_store_sync_ms_)->default_value(kDefaultLogStoreSyncMs),
+            "Milliseconds the log store waits to group writes into one fsync")(
             "redis-host", po::value<std::string>(&redis_host_)->default_value(std::string(kDefaultRedisHost)),
             "Redis server host address")("redis-port", po::value<int>(&redis_port_)->default_value(kDefaultRedisPort),
-                                         "Redis server port");
+                                         "Redis server port")(
+            "redis-nodes", po::value<std::string>(&redis_nodes_spec_)->default_value(""),
+            "Comma-separated host:port list of Redis nodes to shard links across "
+            "(overrides --redis-host/--redis-port)")(
+            "redis-previous-nodes", po::value<std::string>(&redis_previous_nodes_spec_)->default_value(""),
+            "Redis node list before a rebalance; lookups fall back to it while keys migrate")(
+            "redis-replicas", po::value<std::string>(&redis_replicas_spec_)->default_value(""),
+            "Read replicas per Redis node, comma-separated in node order; several replicas of one node are "
+            "separated by '|'")(
+            "redis-hedge-reads", po::bool_switch(&redis_hedge_reads_),
+            "Send a second replica read when the first one is slower than its recent p95")(
+            "redis-client-tracking", po::bool_switch(&redis_client_tracking_),
+            "Evict cached links when any client writes them, using Redis client-side caching invalidations")(
+            "redis-timeout-ms", po::value<int>(&redis_timeout_ms_)->default_value(kDefaultRedisTimeoutMs),
+            "Milliseconds a Redis command may take before it is cancelled (0 disables the deadline)")(
+            "redis-breaker-failure-rate",
+            po::value<int>(&redis_breaker_failure_rate_)->default_value(kDefaultRedisBreakerFailureRate),
+            "Percentage of failed or slow commands that trips a node's circuit breaker (0 disables it)")(
+            "redis-breaker-slow-ms", po::value<int>(&redis_breaker_slow_ms_)->default_value(kDefaultRedisBreakerSlowMs),
+            "Milliseconds after which a command counts as failed for the circuit breaker (0: only errors count)")(
+            "redis-breaker-open-ms", po::value<int>(&redis_breaker_open_ms_)->default_value(kDefaultRedisBreakerOpenMs),
+            "Milliseconds a tripped circuit breaker fails commands fast before probing the node again")(
+            "redis-layout", po::value<std::string>(&redis_layout_)->default_value(std::string(kDefaultRedisLayout)),
+            "Redis key layout (keys: one key per link, buckets: links grouped into small hashes)")(
+            "redis-bucket-size", po::value<int>(&redis_bucket_size_)->default_value(kDefaultRedisBucketSize),
+            "Links per hash with the buckets layout")(
+            "redis-previous-layout", po::value<std::string>(&redis_previous_layout_)->default_value(""),
+            "Redis key layout before a layout change; lookups fall back to it while links migrate")(
+            "migrate-layout", po::bool_switch(&migrate_layout_),
+            "Move links from the keys layout into buckets, then exit")(
+            "layout-report", po::value<int>(&layout_report_links_)->default_value(0),
+            "Write this many sample links in each layout, print bytes per link, then exit")(
+            "redis-connections", po::value<int>(&redis_connections_)->default_value(kDefaultRedisConnections),
+            "Number of pooled Redis connections (0 = one per worker thread)")(
+            "id-block-size", po::value<int>(&id_block_size_)->default_value(kDefaultIdBlockSize),
+            "Number of IDs leased from Redis per counter round trip")(
+            "cache-bytes", po::value<std::size_t>(&cache_bytes_)->default_value(kDefaultCacheBytes),
+            "Capacity of the in-process redirect cache in bytes (0 disables it)")(
+            "stale-cache-bytes", po::value<std::size_t>(&stale_cache_bytes_)->default_value(kDefaultStaleCacheBytes),
+            "Bytes of links dropped by client-tracking flushes kept to serve while Redis is failing (0 disables it)")(
+            "cache-snapshot-path", po::value<std::string>(&cache_snapshot_path_)->default_value(""),
+            "File the redirect cache's hot set is saved to periodically and restored from at startup")(
+            "cache-snapshot-interval",
+            po::value<int>(&cache_snapshot_interval_)->default_value(kDefaultCacheSnapshotInterval),
+            "Seconds between cache snapshots")(
+            "cache-warm-entries", po::value<int>(&cache_warm_entries_)->default_value(kDefaultCacheWarmEntries),
+            "Hottest cached links kept in the snapshot and re-read after a client-tracking flush")(
+            "click-flush-ms", po::value<int>(&click_flush_ms_)->default_value(kDefaultClickFlushMs),
+            "Milliseconds between writes of the per-link click counts to storage (0 disables click counting)")(
+            "hot-links", po::value<int>(&hot_links_)->default_value(kDefaultHotLinks),
+            "Number of most requested links tracked and reported at /api/hot-links (0 disables tracking)")(
+            "pin-hot-links", po::bool_switch(&pin_hot_links_),
+            "Keep the tracked hot links in the redirect cache and first in cache snapshots")(
+            "negative-cache-ttl", po::value<int>(&negative_cache_ttl_)->default_value(kDefaultNegativeCacheTtl),
+            "Seconds to remember short codes found missing (0 disables it)")(
+            "redis-batch-max-keys", po::value<int>(&redis_batch_max_keys_)->default_value(kDefaultRedisBatchMaxKeys),
+            "Maximum lookups merged into one Redis MGET (0 disables batching)")(
+            "redis-batch-delay-us", po::value<int>(&redis_batch_delay_us_)->default_value(kDefaultRedisBatchDelayUs),
+            "Maximum microseconds a lookup waits for its MGET batch to fill")(
+            "atomic-create", po::bool_switch(&atomic_create_),
+            "Create links with one atomic Redis script call (INCR + SET) instead of leased IDs")(
+            "url-compression", po::bool_switch(&url_compression_),
+            "Compress stored URLs with a shared dictionary (compressed values are always readable)")(
+            "dedup", po::bool_switch(&dedup_),
+            "Return the existing short code when a URL is submitted again (Redis storage only)")(
+            "dedup-cache-entries", po::value<int>(&dedup_cache_entries_)->default_value(kDefaultDedupCacheEntries),
+            "Number of recent URL digests cached in-process for deduplication (0 disables the cache)")(
+            "codec-benchmark", po::value<std::string>(&codec_benchmark_path_)->default_value(""),
+            "Benchmark URL compression on a file of URLs (one per line), then exit")(
+            "router-benchmark", po::bool_switch(&router_benchmark_), "Benchmark request routing, then exit");
 
         // Parse command line arguments
         boost::program_options::variables_map vmap;
@@ -35,6 +248,31 @@ auto Config::load(const int &argc, const char *argv[]) -> std::expected<void, Co
         boost::program_options::store(boost::program_options::parse_command_line(argc, argv, desc), vmap);
         boost::program_options::notify(vmap);
 
+        // Resolve the Redis node lists (a single node unless --redis-nodes is given)
+        auto nodes = parse_redis_nodes(redis_nodes_spec_);
+        auto previous_nodes = parse_redis_nodes(redis_previous_nodes_spec_);
+        if (!nodes || !previous_nodes)
+        {
+            return std::unexpected(ConfigError::InvalidRedisNodes);
+        }
+        redis_nodes_ = nodes->empty() ? std::vector<RedisNode>{{.host = redis_host_, .port = redis_port_}}
+                                      : std::move(*nodes);
+        redis_previous_nodes_ = std::move(*previous_nodes);
+
+        auto replicas = parse_redis_replicas(redis_replicas_spec_);
+        if (!replicas || replicas->size() > redis_nodes_.size())
+        {
+            return std::unexpected(ConfigError::InvalidRedisReplicas);
+        }
+        redis_replicas_ = std::move(*replicas);
+
+        auto cpus = parse_cpu_list(cpu_affinity_spec_);
+        if (!cpus)
+        {
+            return std::unexpected(ConfigError::InvalidCpuAffinity);
+        }
+        cpu_affinity_ = std::move(*cpus);
+
         // Validate configuration
         return is_valid();
     }
@@ -65,11 +303,26 @@ auto Config::is_valid() const -> std::expected<void, ConfigError>
         return std::unexpected(ConfigError::EmptyAddress);
     }
 
+    if (max_body_bytes_ == 0 || batch_max_urls_ < 1)
+    {
+        return std::unexpected(ConfigError::InvalidRequestLimits);
+    }
+
     if (!kValidLogLevels.contains(log_level_))
     {
         return std::unexpected(ConfigError::InvalidLogLevel);
     }
 
+    if (!kValidStorageBackends.contains(storage_backend_))
+    {
+        return std::unexpected(ConfigError::InvalidStorageBackend);
+    }
+
+    if (log_store_path_.empty() || log_store_sync_ms_ < 0)
+    {
+        return std::unexpected(ConfigError::InvalidLogStoreOptions);
+    }
+
     // Validate Redis configuration
     if (redis_host_.empty())
     {
@@ -81,6 +334,60 @@ auto Config::is_valid() const -> std::expected<void, ConfigError>
         return std::unexpected(ConfigError::InvalidPort);
     }
 
+    if (redis_connections_ < 0)
+    {
+        return std::unexpected(ConfigError::InvalidRedisConnections);
+    }
+
+    if (redis_timeout_ms_ < 0 || redis_breaker_failure_rate_ < 0 || redis_breaker_failure_rate_ > kMaxPercent ||
+        redis_breaker_slow_ms_ < 0 || redis_breaker_open_ms_ < 0)
+    {
+        return std::unexpected(ConfigError::InvalidRedisDeadlines);
+    }
+
+    if (!kValidRedisLayouts.contains(redis_layout_) || redis_bucket_size_ < 1 || layout_report_links_ < 0 ||
+        (!redis_previous_layout_.empty() &&
+         (!kValidRedisLayouts.contains(redis_previous_layout_) || redis_previous_layout_ == redis_layout_)) ||
+        (migrate_layout_ && redis_layout_ != "buckets"))
+    {
+        return std::unexpected(ConfigError::InvalidRedisLayout);
+    }
+
+    if (dedup_cache_entries_ < 0 || (dedup_ && storage_backend_ != "redis"))
+    {
+        return std::unexpected(ConfigError::InvalidDedupOptions);
+    }
+
+    if (cache_snapshot_interval_ < 1 || cache_warm_entries_ < 0)
+    {
+        return std::unexpected(ConfigError::InvalidCacheSnapshotOptions);
+    }
+
+    if (id_block_size_ < kMinIdBlockSize)
+    {
+        return std::unexpected(ConfigError::InvalidIdBlockSize);
+    }
+
+    if (click_flush_ms_ < 0)
+    {
+        return std::unexpected(ConfigError::InvalidClickFlushInterval);
+    }
+
+    if (hot_links_ < 0 || hot_links_ > kMaxHotLinks)
+    {
+        return std::unexpected(ConfigError::InvalidHotLinks);
+    }
+
+    if (negative_cache_ttl_ < 0)
+    {
+        return std::unexpected(ConfigError::InvalidNegativeCacheTtl);
+    }
+
+    if (redis_batch_max_keys_ < 0 || redis_batch_delay_us_ < 0)
+    {
+        return std::unexpected(ConfigError::InvalidBatchOptions);
+    }
+
     return {};
 }
 
@@ -3,9 +3,12 @@
 #include <boost/program_options/options_description.hpp>
 #include <boost/program_options/parsers.hpp>
 #include <boost/program_options/variables_map.hpp>
+#include <chrono>
+#include <cstddef>
 #include <expected>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace conf
 {
@@ -24,22 +27,97 @@ constexpr int kMinPort = 1;
 constexpr int kMaxPort = 65535;
 constexpr int kMinThreads = 1;
 
+// Request size limits (the body limit bounds every request; batch creates are the only large ones)
+constexpr std::size_t kDefaultMaxBodyBytes = 8UL * 1024 * 1024;
+constexpr int kDefaultBatchMaxUrls = 10000;
+
 // Redis configuration defaults
 constexpr std::string_view kDefaultRedisHost = "127.0.0.1"sv;
 constexpr int kDefaultRedisPort = 6379;
+constexpr int kDefaultRedisConnections = 0; // one per worker thread
+
+// Redis key layout defaults (buckets fit Redis' default hash-max-listpack-entries of 128)
+constexpr std::string_view kDefaultRedisLayout = "keys"sv;
+constexpr int kDefaultRedisBucketSize = 100;
+
+// Storage backend defaults
+constexpr std::string_view kDefaultStorageBackend = "redis"sv;
+constexpr std::string_view kDefaultLogStorePath = "swftly.log"sv;
+constexpr int kDefaultLogStoreSyncMs = 1;
+
+// ID allocation defaults
+constexpr int kDefaultIdBlockSize = 100;
+constexpr int kMinIdBlockSize = 1;
+
+// Redirect cache defaults
+constexpr std::size_t kDefaultCacheBytes = 64UL * 1024 * 1024;
+constexpr std::size_t kDefaultStaleCacheBytes = 16UL * 1024 * 1024;
+
+// Cache warming defaults (snapshots are opt-in)
+constexpr int kDefaultCacheSnapshotInterval = 60; // seconds
+constexpr int kDefaultCacheWarmEntries = 100000;
+
+// Negative lookup cache defaults
+constexpr int kDefaultNegativeCacheTtl = 10; // seconds
+
+// Create-time deduplication defaults (deduplication is opt-in)
+constexpr int kDefaultDedupCacheEntries = 100000;
+
+// Redis deadline and circuit breaker defaults
+constexpr int kDefaultRedisTimeoutMs = 1000;
+constexpr int kDefaultRedisBreakerFailureRate = 50; // percent of a window's commands
+constexpr int kDefaultRedisBreakerSlowMs = 500;
+constexpr int kDefaultRedisBreakerOpenMs = 5000;
+constexpr int kMaxPercent = 100;
+
+// Click counting defaults
+constexpr int kDefaultClickFlushMs = 1000;
+
+// Heavy-hitter tracking defaults
+constexpr int kDefaultHotLinks = 100;
+constexpr int kMaxHotLinks = 10000;
+
+// Lookup batching defaults (batching is opt-in)
+constexpr int kDefaultRedisBatchMaxKeys = 0;
+constexpr int kDefaultRedisBatchDelayUs = 200;
 
 /**
  * @brief Defines errors that can occur during configuration loading.
  */
 enum class ConfigError : std::uint8_t
 {
-    HelpRequested,   ///< The user requested the help message (--help). Not a true error.
-    InvalidPort,     ///< The specified port is outside the valid range (1-65535).
-    InvalidThreads,  ///< The specified thread count is not a positive number.
-    EmptyAddress,    ///< The server address string is empty.
-    ParseError,      ///< An error occurred while parsing command-line arguments.
-    InvalidLogLevel, ///< The specified log level is not one of the allowed values.
-    UnexpectedError  ///< An unknown or unexpected error occurred.
+    HelpRequested,               ///< The user requested the help message (--help). Not a true error.
+    InvalidPort,                 ///< The specified port is outside the valid range (1-65535).
+    InvalidThreads,              ///< The specified thread count is not a positive number.
+    EmptyAddress,                ///< The server address string is empty.
+    ParseError,                  ///< An error occurred while parsing command-line arguments.
+    InvalidLogLevel,             ///< The specified log level is not one of the allowed values.
+    InvalidIdBlockSize,          ///< The ID block size is not a positive number.
+    InvalidNegativeCacheTtl,     ///< The negative cache TTL is negative.
+    InvalidBatchOptions,         ///< The lookup batch size or delay is negative.
+    InvalidRedisConnections,     ///< The Redis connection count is negative.
+    InvalidStorageBackend,       ///< The storage backend is not one of the allowed values.
+    InvalidLogStoreOptions,      ///< The log store path is empty or its sync interval is negative.
+    InvalidRedisNodes,           ///< A Redis node list entry is malformed or listed twice.
+    InvalidRedisReplicas,        ///< A Redis replica entry is malformed or there are more replica groups than nodes.
+    InvalidRedisLayout,          ///< A layout is unknown, the bucket size is not positive or a layout tool is misused.
+    InvalidDedupOptions,         ///< Deduplication is enabled on the log store or its cache size is negative.
+    InvalidRequestLimits,        ///< The request body limit or the batch create size is not positive.
+    InvalidRedisDeadlines,       ///< A Redis timeout or breaker setting is negative or the failure rate exceeds 100.
+    InvalidClickFlushInterval,   ///< The click flush interval is negative.
+    InvalidCacheSnapshotOptions, ///< The cache snapshot interval is not positive or the warm count is negative.
+    InvalidHotLinks,             ///< The hot link count is negative or above kMaxHotLinks.
+    InvalidCpuAffinity,          ///< The CPU affinity list is malformed.
+    UnexpectedError              ///< An unknown or unexpected error occurred.
+};
+
+/**
+ * @brief Address of one Redis node.
+ */
+struct RedisNode
+{
+    std::string host; ///< Host name or address.
+    int port{};       ///< TCP port.
 };
 
 /**
@@ -80,6 +158,35 @@ class Config
         return threads_;
     }
 
+    /// @brief Checks whether every worker thread runs its own io_context and acceptor (thread-per-core mode).
+    [[nodiscard]] auto thread_per_core() const noexcept
+    {
+        return thread_per_core_;
+    }
+
+    /**
+     * @brief Gets the CPUs worker threads are pinned to; thread i runs on entry `i % size()`.
+     *
+     * Empty unless --cpu-affinity is given: threads are then not pinned, except
+     * in thread-per-core mode, where they take the process's allowed CPUs in order.
+     */
+    [[nodiscard]] auto cpu_affinity() const noexcept -> const std::vector<int> &
+    {
+        return cpu_affinity_;
+    }
+
+    /// @brief Gets the maximum size of a request body in bytes.
+    [[nodiscard]] auto max_body_bytes() const noexcept
+    {
+        return max_body_bytes_;
+    }
+
+    /// @brief Gets the maximum number of URLs in one batch create request.
+    [[nodiscard]] auto batch_max_urls() const noexcept
+    {
+        return batch_max_urls_;
+    }
+
     /// @brief Gets the configured log severity level.
     [[nodiscard]] auto log_level() const noexcept
     {
@@ -98,14 +205,284 @@ class Config
         return redis_port_;
     }
 
+    /// @brief Gets the storage backend name ("redis" or "log").
+    [[nodiscard]] auto storage_backend() const noexcept
+    {
+        return std::string_view{storage_backend_};
+    }
+
+    /// @brief Gets the path of the embedded log store (the index lives next to it with an `.idx` suffix).
+    [[nodiscard]] auto log_store_path() const noexcept
+    {
+        return std::string_view{log_store_path_};
+    }
+
+    /// @brief Gets how long the log store waits to group writes into one fsync.
+    [[nodiscard]] auto log_store_sync_interval() const noexcept
+    {
+        return std::chrono::milliseconds{log_store_sync_ms_};
+    }
+
+    /**
+     * @brief Gets the Redis nodes links are sharded across.
+     *
+     * The `--redis-nodes` list if given, otherwise the single `--redis-host`/`--redis-port` node.
+     * The ID counter lives on the first node.
+     */
+    [[nodiscard]] auto redis_nodes() const noexcept -> const std::vector<RedisNode> &
+    {
+        return redis_nodes_;
+    }
+
+    /// @brief Gets the node list before a rebalance; lookups fall back to it while keys migrate (empty if none).
+    [[nodiscard]] auto redis_previous_nodes() const noexcept -> const std::vector<RedisNode> &
+    {
+        return redis_previous_nodes_;
+    }
+
+    /**
+     * @brief Gets the read replicas of each Redis node.
+     *
+     * Group i holds the replicas of `redis_nodes()[i]`; nodes past the end of the list or with an
+     * empty group have no replicas and serve their reads themselves.
+     */
+    [[nodiscard]] auto redis_replicas() const noexcept -> const std::vector<std::vector<RedisNode>> &
+    {
+        return redis_replicas_;
+    }
+
+    /// @brief Checks whether cached links are invalidated by Redis client tracking (CLIENT TRACKING BCAST).
+    [[nodiscard]] auto redis_client_tracking() const noexcept
+    {
+        return redis_client_tracking_;
+    }
+
+    /// @brief Gets the deadline of every Redis command (0 disables it).
+    [[nodiscard]] auto redis_timeout() const noexcept
+    {
+        return std::chrono::milliseconds{redis_timeout_ms_};
+    }
+
+    /// @brief Gets the fraction of failed commands that trips a node's circuit breaker (0 disables it).
+    [[nodiscard]] auto redis_breaker_failure_ratio() const noexcept
+    {
+        return redis_breaker_failure_rate_ / static_cast<double>(kMaxPercent);
+    }
+
+    /// @brief Gets the latency above which a command counts as failed for the circuit breaker (0 disables it).
+    [[nodiscard]] auto redis_breaker_slow_call() const noexcept
+    {
+        return std::chrono::milliseconds{redis_breaker_slow_ms_};
+    }
+
+    /// @brief Gets how long a tripped circuit breaker fails commands fast before probing the node.
+    [[nodiscard]] auto redis_breaker_open_time() const noexcept
+    {
+        return std::chrono::milliseconds{redis_breaker_open_ms_};
+    }
+
+    /// @brief Checks whether slow replica reads are hedged with a second request.
+    [[nodiscard]] auto redis_hedge_reads() const noexcept
+    {
+        return redis_hedge_reads_;
+    }
+
+    /// @brief Gets the Redis key layout ("keys" or "buckets"; see storage::KeyLayout).
+    [[nodiscard]] auto redis_layout() const noexcept -> std::string_view
+    {
+        return redis_layout_;
+    }
+
+    /// @brief Gets the number of consecutive IDs grouped into one hash by the "buckets" layout.
+    [[nodiscard]] auto redis_bucket_size() const noexcept
+    {
+        return redis_bucket_size_;
+    }
+
+    /// @brief Gets the layout before a layout change; lookups fall back to it while links migrate (empty if none).
+    [[nodiscard]] auto redis_previous_layout() const noexcept -> std::string_view
+    {
+        return redis_previous_layout_;
+    }
+
+    /// @brief Checks whether to migrate links from the "keys" to the "buckets" layout and exit.
+    [[nodiscard]] auto migrate_layout() const noexcept
+    {
+        return migrate_layout_;
+    }
+
+    /// @brief Gets the number of sample links to measure bytes per link with, then exit (0 disables it).
+    [[nodiscard]] auto layout_report_links() const noexcept
+    {
+        return layout_report_links_;
+    }
+
+    /// @brief Checks whether stored URLs are compressed with the shared dictionary (see storage::UrlCodec).
+    [[nodiscard]] auto url_compression() const noexcept
+    {
+        return url_compression_;
+    }
+
+    /// @brief Checks whether submitting a URL again returns its existing short code.
+    [[nodiscard]] auto dedup() const noexcept
+    {
+        return dedup_;
+    }
+
+    /// @brief Gets the number of recent URL digests cached in-process for deduplication (0 disables the cache).
+    [[nodiscard]] auto dedup_cache_entries() const noexcept
+    {
+        return dedup_cache_entries_;
+    }
+
+    /// @brief Gets the file of sample URLs to benchmark URL compression with, then exit (empty disables it).
+    [[nodiscard]] auto codec_benchmark_path() const noexcept -> std::string_view
+    {
+        return codec_benchmark_path_;
+    }
+
+    /// @brief Checks whether to benchmark request routing, then exit.
+    [[nodiscard]] auto router_benchmark() const noexcept
+    {
+        return router_benchmark_;
+    }
+
+    /// @brief Gets the number of pooled Redis connections (0 means one per worker thread).
+    [[nodiscard]] auto redis_connections() const noexcept
+    {
+        return redis_connections_;
+    }
+
+    /// @brief Gets the number of IDs leased from Redis per counter round trip.
+    [[nodiscard]] auto id_block_size() const noexcept
+    {
+        return id_block_size_;
+    }
+
+    /// @brief Gets the capacity of the in-process redirect cache in bytes (0 disables it).
+    [[nodiscard]] auto cache_bytes() const noexcept
+    {
+        return cache_bytes_;
+    }
+
+    /// @brief Gets the capacity of the cache of links dropped by tracking flushes, served while storage fails.
+    [[nodiscard]] auto stale_cache_bytes() const noexcept
+    {
+        return stale_cache_bytes_;
+    }
+
+    /// @brief Gets the file the redirect cache's hot set is saved to and restored from (empty disables it).
+    [[nodiscard]] auto cache_snapshot_path() const noexcept
+    {
+        return std::string_view{cache_snapshot_path_};
+    }
+
+    /// @brief Gets the time between cache snapshots.
+    [[nodiscard]] auto cache_snapshot_interval() const noexcept
+    {
+        return std::chrono::seconds{cache_snapshot_interval_};
+    }
+
+    /// @brief Gets how many of the hottest cached links are snapshotted or re-read after a tracking flush.
+    [[nodiscard]] auto cache_warm_entries() const noexcept
+    {
+        return cache_warm_entries_;
+    }
+
+    /// @brief Gets the time between click count flushes (0 disables click counting).
+    [[nodiscard]] auto click_flush_interval() const noexcept
+    {
+        return std::chrono::milliseconds{click_flush_ms_};
+    }
+
+    /// @brief Gets how many of the most requested links are tracked (0 disables tracking).
+    [[nodiscard]] auto hot_links() const noexcept
+    {
+        return hot_links_;
+    }
+
+    /// @brief Checks whether the tracked hot links are pinned in the redirect cache.
+    [[nodiscard]] auto pin_hot_links() const noexcept
+    {
+        return pin_hot_links_;
+    }
+
+    /// @brief Gets how long IDs found missing are remembered, in seconds (0 disables it).
+    [[nodiscard]] auto negative_cache_ttl() const noexcept
+    {
+        return std::chrono::seconds{negative_cache_ttl_};
+    }
+
+    /// @brief Checks whether creates run as one atomic server-side script instead of ID lease + SET.
+    [[nodiscard]] auto atomic_create() const noexcept
+    {
+        return atomic_create_;
+    }
+
+    /// @brief Gets the maximum number of lookups merged into one MGET (0 or 1 disables batching).
+    [[nodiscard]] auto redis_batch_max_keys() const noexcept
+    {
+        return redis_batch_max_keys_;
+    }
+
+    /// @brief Gets the maximum time a lookup waits for its MGET batch to fill.
+    [[nodiscard]] auto redis_batch_delay() const noexcept
+    {
+        return std::chrono::microseconds{redis_batch_delay_us_};
+    }
+
   private:
     [[nodiscard]] auto is_valid() const -> std::expected<void, ConfigError>;
 
     std::string address_;
     int port_{};
     int threads_{};
+    bool thread_per_core_{};
+    std::string cpu_affinity_spec_;
+    std::vector<int> cpu_affinity_;
+    std::size_t max_body_bytes_{};
+    int batch_max_urls_{};
     std::string log_level_;
+    std::string storage_backend_;
+    std::string log_store_path_;
+    int log_store_sync_ms_{};
     std::string redis_host_;
     int redis_port_{};
+    std::string redis_nodes_spec_;
+    std::string redis_previous_nodes_spec_;
+    std::vector<RedisNode> redis_nodes_;
+    std::vector<RedisNode> redis_previous_nodes_;
+    std::string redis_replicas_spec_;
+    std::vector<std::vector<RedisNode>> redis_replicas_;
+    bool redis_hedge_reads_{};
+    bool redis_client_tracking_{};
+    int redis_timeout_ms_{};
+    int redis_breaker_failure_rate_{};
+    int redis_breaker_slow_ms_{};
+    int redis_breaker_open_ms_{};
+    std::string redis_layout_;
+    int redis_bucket_size_{};
+    std::string redis_previous_layout_;
+    bool migrate_layout_{};
+    int layout_report_links_{};
+    bool url_compression_{};
+    bool dedup_{};
+    int dedup_cache_entries_{};
+    std::string codec_benchmark_path_;
+    bool router_benchmark_{};
+    int redis_connections_{};
+    int id_block_size_{};
+    std::size_t cache_bytes_{};
+    std::size_t stale_cache_bytes_{};
+    std::string cache_snapshot_path_;
+    int cache_snapshot_interval_{};
+    int cache_warm_entries_{};
+    int negative_cache_ttl_{};
+    int click_flush_ms_{};
+    int hot_links_{};
+    bool pin_hot_links_{};
+    int redis_batch_max_keys_{};
+    int redis_batch_delay_us_{};
+    bool atomic_create_{};
 };
 } // namespace conf
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "batch_short_code_handler.hpp"
+#include "degraded.hpp"
+#include <boost/asio/awaitable.hpp>
+#include <boost/json.hpp>
+#include <boost/system/system_error.hpp>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http::handler
+{
+
+namespace json = boost::json;
+
+namespace
+{
+constexpr std::string_view kNdjsonContentType = "application/x-ndjson";
+
+// Appends the URL held by `entry` (a string, or an object with a string `url`); false if it has none.
+auto append_url(const json::value &entry, std::vector<std::string> &urls) -> bool
+{
+    const json::value *url_val = &entry;
+    if (entry.is_object())
+    {
+        url_val = entry.get_object().if_contains("url");
+    }
+
+    if (!url_val || !url_val->is_string() || url_val->get_string().empty())
+    {
+        return false;
+    }
+
+    urls.emplace_back(url_val->get_string());
+    return true;
+}
+} // namespace
+
+BatchShortCodeHandler::BatchShortCodeHandler(encode::Encoder encoder, storage::StorageService storage,
+                                             std::size_t max_urls)
+    : encoder_{std::move(encoder)}, storage_{std::move(storage)}, max_urls_{max_urls}
+{
+}
+
+auto BatchShortCodeHandler::operator()(const request_t *req, response_t *res) const -> boost::asio::awaitable<void>
+{
+    auto fail = [&](http::status status, std::string_view error_message)
+    {
+        res->result(status);
+        res->set(http::field::content_type, "application/json");
+        res->body() = json::serialize(json::object{{"error", error_message}});
+    };
+
+    const bool ndjson = req->base()[http::field::content_type].starts_with(kNdjsonContentType);
+
+    // Collect the URLs in request order, stopping at the first invalid entry.
+    std::vector<std::string> urls;
+    try
+    {
+        if (ndjson)
+        {
+            std::string_view body = req->body();
+            for (std::size_t line_number = 1; !body.empty(); ++line_number)
+            {
+                const auto eol = body.find('\n');
+                const auto line = body.substr(0, eol);
+                body.remove_prefix(eol == std::string_view::npos ? body.size() : eol + 1);
+
+                if (line.find_first_not_of(" \t\r") == std::string_view::npos)
+                {
+                    continue;
+                }
+                if (urls.size() == max_urls_)
+                {
+                    fail(http::status::payload_too_large, std::format("At most {} URLs per request.", max_urls_));
+                    co_return;
+                }
+                if (!append_url(json::parse(line), urls))
+                {
+                    fail(http::status::bad_request,
+                         std::format("Line {} must be a non-empty URL string or an object with one.", line_number));
+                    co_return;
+                }
+            }
+        }
+        else
+        {
+            const auto jv = json::parse(req->body());
+            const json::value *list = &jv;
+            if (jv.is_object())
+            {
+                list = jv.get_object().if_contains("urls");
+            }
+            if (!list || !list->is_array())
+            {
+                fail(http::status::bad_request,
+                     "Request body must be an array of URLs or an object with a 'urls' array.");
+                co_return;
+            }
+
+            const auto &entries = list->get_array();
+            if (entries.size() > max_urls_)
+            {
+                fail(http::status::payload_too_large, std::format("At most {} URLs per request.", max_urls_));
+                co_return;
+            }
+
+            urls.reserve(entries.size());
+            for (const auto &entry : entries)
+            {
+                if (!append_url(entry, urls))
+                {
+                    fail(http::status::bad_request,
+                         std::format("Entry {} must be a non-empty URL string or an object with one.", urls.size()));
+                    co_return;
+                }
+            }
+        }
+    }
+    catch (const boost::system::system_error &)
+    {
+        fail(http::status::bad_request,
+             ndjson ? "Invalid JSON on a line of the request body." : "Invalid JSON format in request body.");
+        co_return;
+    }
+
+    if (urls.empty())
+    {
+        fail(http::status::bad_request, "Request body contains no URLs.");
+        co_return;
+    }
+
+    // Now do the async storage operations
+    std::uint64_t first = 0;
+    try
+    {
+        first = co_await storage_.create_urls(urls);
+    }
+    catch (const storage::BackendUnavailable &e)
+    {
+        reject_unavailable(res, e);
+        co_return;
+    }
+    catch (const std::exception &e)
+    {
+        fail(http::status::internal_server_error, "Internal server error");
+        co_return;
+    }
+
+    std::string body;
+    if (ndjson)
+    {
+        for (std::size_t i = 0; i < urls.size(); ++i)
+        {
+            body += json::serialize(json::object{{"short_code", encoder_.encode(first + i)}, {"url", urls[i]}});
+            body += '\n';
+        }
+    }
+    else
+    {
+        json::array links;
+        links.reserve(urls.size());
+        for (std::size_t i = 0; i < urls.size(); ++i)
+        {
+            links.emplace_back(json::object{{"short_code", encoder_.encode(first + i)}, {"url", urls[i]}});
+        }
+        body = json::serialize(json::object{{"links", std::move(links)}});
+    }
+
+    res->result(http::status::created);
+    res->set(http::field::content_type, ndjson ? kNdjsonContentType : "application/json");
+    res->body() = std::move(body);
+}
+
+} // namespace http::handler
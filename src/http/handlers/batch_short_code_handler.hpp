@@ -0,0 +1,41 @@
+#pragma once
+
+#include "encode/encoder.hpp"
+#include "http/router.hpp"
+#include "storage/storage_service.hpp"
+#include <boost/asio/awaitable.hpp>
+#include <cstddef>
+
+namespace http::handler
+{
+
+/**
+ * @brief Handles requests to create many short codes at once.
+ *
+ * Accepts either a JSON body (an array of URLs, or an object with a `urls`
+ * array) or, with `Content-Type: application/x-ndjson`, one URL per line
+ * (a JSON string or an object with a `url` field). All links are created
+ * with one ID range reservation and pipelined storage writes, and returned
+ * in request order in the same format: `{"links": [...]}` or one object per
+ * line.
+ */
+class BatchShortCodeHandler
+{
+  public:
+    /**
+     * @brief Constructs the handler.
+     * @param encoder Encoder turning IDs into short codes.
+     * @param storage The storage service.
+     * @param max_urls Maximum number of URLs accepted per request.
+     */
+    BatchShortCodeHandler(encode::Encoder encoder, storage::StorageService storage, std::size_t max_urls);
+
+    auto operator()(const request_t *req, response_t *res) const -> boost::asio::awaitable<void>;
+
+  private:
+    encode::Encoder encoder_;
+    storage::StorageService storage_;
+    std::size_t max_urls_;
+};
+
+} // namespace http::handler
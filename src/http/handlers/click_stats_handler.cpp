@@ -0,0 +1,135 @@
+#include "click_stats_handler.hpp"
+#include "degraded.hpp"
+#include <boost/asio/awaitable.hpp>
+#include <boost/json.hpp>
+#include <boost/system/system_error.hpp>
+#include <cstdint>
+#include <format>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace http::handler
+{
+
+namespace json = boost::json;
+
+ClickStatsHandler::ClickStatsHandler(encode::Encoder encoder, storage::StorageService storage)
+    : encoder_{std::move(encoder)}, storage_{std::move(storage)}
+{
+}
+
+auto ClickStatsHandler::operator()(const request_t *req, response_t *res, RouteParams params) const
+    -> boost::asio::awaitable<void>
+{
+    auto fail = [&](http::status status, std::string_view error_message)
+    {
+        res->result(status);
+        res->set(http::field::content_type, "application/json");
+        res->body() = json::serialize(json::object{{"error", error_message}});
+    };
+
+    // GET /api/urls/{code}/stats binds one short code; POST /api/clicks lists them in the body.
+    const auto path_code = params.get("code");
+    std::vector<std::string> short_codes;
+    std::vector<std::uint64_t> ids;
+    if (!path_code.empty())
+    {
+        const auto id = encoder_.decode(path_code);
+        if (!id.has_value())
+        {
+            fail(http::status::not_found, "Not found");
+            co_return;
+        }
+        short_codes.emplace_back(path_code);
+        ids.push_back(id.value());
+    }
+    else
+    {
+        json::value jv;
+        try
+        {
+            jv = json::parse(req->body());
+        }
+        catch (const boost::system::system_error &)
+        {
+            fail(http::status::bad_request, "Invalid JSON format in request body.");
+            co_return;
+        }
+
+        const json::value *list = &jv;
+        if (jv.is_object())
+        {
+            list = jv.get_object().if_contains("short_codes");
+        }
+        if (!list || !list->is_array())
+        {
+            fail(http::status::bad_request,
+                 "Request body must be an array of short codes or an object with a 'short_codes' array.");
+            co_return;
+        }
+
+        const auto &entries = list->get_array();
+        if (entries.size() > kMaxShortCodes)
+        {
+            fail(http::status::payload_too_large, std::format("At most {} short codes per request.", kMaxShortCodes));
+            co_return;
+        }
+
+        short_codes.reserve(entries.size());
+        ids.reserve(entries.size());
+        for (const auto &entry : entries)
+        {
+            if (!entry.is_string())
+            {
+                fail(http::status::bad_request, std::format("Entry {} is not a short code string.", ids.size()));
+                co_return;
+            }
+
+            const std::string_view short_code = entry.get_string();
+            const auto id = encoder_.decode(short_code);
+            if (!id.has_value())
+            {
+                fail(http::status::bad_request, std::format("Entry {} is not a valid short code.", ids.size()));
+                co_return;
+            }
+            short_codes.emplace_back(short_code);
+            ids.push_back(id.value());
+        }
+    }
+
+    std::vector<std::uint64_t> clicks;
+    try
+    {
+        clicks = co_await storage_.click_counts(ids);
+    }
+    catch (const storage::BackendUnavailable &e)
+    {
+        reject_unavailable(res, e);
+        co_return;
+    }
+    catch (const std::exception &e)
+    {
+        fail(http::status::internal_server_error, "Internal server error");
+        co_return;
+    }
+
+    res->result(http::status::ok);
+    res->set(http::field::content_type, "application/json");
+    if (!path_code.empty())
+    {
+        res->body() = json::serialize(json::object{{"short_code", short_codes[0]}, {"clicks", clicks[0]}});
+        co_return;
+    }
+
+    json::array counts;
+    counts.reserve(ids.size());
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        counts.emplace_back(json::object{{"short_code", short_codes[i]}, {"clicks", clicks[i]}});
+    }
+
+    res->body() = json::serialize(json::object{{"clicks", std::move(counts)}});
+}
+
+} // namespace http::handler
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "encode/encoder.hpp"
+#include "http/router.hpp"
+#include "storage/storage_service.hpp"
+#include <boost/asio/awaitable.hpp>
+#include <cstddef>
+
+namespace http::handler
+{
+
+/**
+ * @brief Handles requests for the click counts of short codes.
+ *
+ * On `POST /api/clicks`, accepts a JSON array of short codes, or an object
+ * with a `short_codes` array, and returns
+ * `{"clicks": [{"short_code": ..., "clicks": ...}, ...]}` in request order.
+ * On `GET /api/urls/{code}/stats`, returns `{"short_code": ..., "clicks": ...}`
+ * for the bound code. Counts include clicks this server has not flushed to
+ * storage yet; clicks on other servers show up once they flush.
+ */
+class ClickStatsHandler
+{
+  public:
+    /**
+     * @brief Constructs the handler.
+     * @param encoder Encoder turning short codes into IDs.
+     * @param storage The storage service.
+     */
+    ClickStatsHandler(encode::Encoder encoder, storage::StorageService storage);
+
+    auto operator()(const request_t *req, response_t *res, RouteParams params) const
+        -> boost::asio::awaitable<void>;
+
+  private:
+    // Maximum number of short codes per request
+    static constexpr std::size_t kMaxShortCodes = 1000;
+
+    encode::Encoder encoder_;
+    storage::StorageService storage_;
+};
+
+} // namespace http::handler
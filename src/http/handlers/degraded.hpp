@@ -0,0 +1,28 @@
+#pragma once
+
+#include "http/router.hpp" // For response_t
+#include "storage/circuit_breaker.hpp"
+#include <string>
+
+namespace http::handler
+{
+
+/// @brief Header marking responses given while storage is failing (stale redirects, rejected writes).
+constexpr beast::string_view kDegradedHeader = "X-Storage-Degraded";
+
+/**
+ * @brief Answers a request that needs storage while storage is unavailable.
+ *
+ * Sets 503 Service Unavailable with the Retry-After suggested by `error` and
+ * marks the response as degraded, so clients can tell an outage from a bug.
+ */
+inline void reject_unavailable(response_t *res, const storage::BackendUnavailable &error)
+{
+    res->result(http::status::service_unavailable);
+    res->set(http::field::retry_after, std::to_string(error.retry_after().count()));
+    res->set(kDegradedHeader, "1");
+    res->set(http::field::content_type, "application/json");
+    res->body() = R"({"error":"Storage temporarily unavailable","degraded":true})";
+}
+
+} // namespace http::handler
@@ -0,0 +1,33 @@
+#include "hot_links_handler.hpp"
+#include <boost/json.hpp>
+
+namespace http::handler
+{
+
+namespace json = boost::json;
+
+HotLinksHandler::HotLinksHandler(encode::Encoder encoder, storage::StorageService storage)
+    : encoder_{std::move(encoder)}, storage_{std::move(storage)}
+{
+}
+
+auto HotLinksHandler::operator()([[maybe_unused]] const request_t *req, response_t *res) const
+    -> boost::asio::awaitable<void>
+{
+    const auto hot_links = storage_.hot_links();
+
+    json::array links;
+    links.reserve(hot_links.size());
+    for (const auto &link : hot_links)
+    {
+        links.emplace_back(json::object{{"short_code", encoder_.encode(link.id)}, {"hits", link.hits}});
+    }
+
+    res->result(http::status::ok);
+    res->set(http::field::content_type, "application/json");
+    res->body() = json::serialize(json::object{{"links", std::move(links)}});
+
+    co_return;
+}
+
+} // namespace http::handler
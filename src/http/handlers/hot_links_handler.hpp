@@ -0,0 +1,36 @@
+#pragma once
+
+#include "encode/encoder.hpp"
+#include "http/router.hpp" // For request_t and response_t
+#include "storage/storage_service.hpp"
+#include <boost/asio/awaitable.hpp>
+
+namespace http::handler
+{
+
+/**
+ * @brief Handles requests to the /api/hot-links endpoint.
+ *
+ * Returns this server's most requested links as of the last sketch merge,
+ * hottest first: `{"links": [{"short_code": ..., "hits": ...}, ...]}`. Hits
+ * are estimates that decay over time, meant for ranking rather than counting;
+ * use /api/clicks for exact totals.
+ */
+class HotLinksHandler
+{
+  public:
+    /**
+     * @brief Constructs the handler.
+     * @param encoder Encoder turning IDs into short codes.
+     * @param storage The storage service.
+     */
+    HotLinksHandler(encode::Encoder encoder, storage::StorageService storage);
+
+    auto operator()(const request_t *req, response_t *res) const -> boost::asio::awaitable<void>;
+
+  private:
+    encode::Encoder encoder_;
+    storage::StorageService storage_;
+};
+
+} // namespace http::handler
@@ -1,4 +1,5 @@
 #include "new_short_code_handler.hpp"
+#include "degraded.hpp"
 #include <boost/asio/awaitable.hpp>
 #include <boost/json.hpp>
 #include <boost/system/system_error.hpp>
@@ -65,19 +66,23 @@ auto NewShortCodeHandler::operator()(const request_t *req, response_t *res) cons
     // Now do the async Redis operations
     try
     {
-        auto index = co_await storage_.generate_next_id();
-        auto short_code = encoder_.encode(index);
-
-        co_await storage_.store_url(index, url);
+        const auto link = co_await storage_.find_or_create_url(url);
+        auto short_code = encoder_.encode(link.id);
 
         json::object success_body;
         success_body["short_code"] = short_code;
         success_body["url"] = url;
 
-        res->result(http::status::created);
+        // An existing link for the same URL is returned as is.
+        res->result(link.created ? http::status::created : http::status::ok);
         res->set(http::field::content_type, "application/json");
         res->body() = json::serialize(success_body);
     }
+    catch (const storage::BackendUnavailable &e)
+    {
+        // Creates are never queued: the client is told to retry once storage is back.
+        reject_unavailable(res, e);
+    }
     catch (const std::exception &e)
     {
         res->result(http::status::internal_server_error);
@@ -0,0 +1,19 @@
+#include "not_found_handler.hpp"
+#include <boost/json.hpp>
+
+namespace http::handler
+{
+
+namespace json = boost::json;
+
+auto NotFoundHandler::operator()([[maybe_unused]] const request_t *req, response_t *res) const
+    -> boost::asio::awaitable<void>
+{
+    res->result(http::status::not_found);
+    res->set(http::field::content_type, "application/json");
+    res->body() = json::serialize(json::object{{"error", "Not found"}});
+
+    co_return;
+}
+
+} // namespace http::handler
@@ -0,0 +1,18 @@
+#pragma once
+
+#include "http/router.hpp" // For request_t and response_t
+#include <boost/asio/awaitable.hpp>
+
+namespace http::handler
+{
+
+/**
+ * @brief Answers requests that match no route with 404 Not Found.
+ */
+class NotFoundHandler
+{
+  public:
+    auto operator()(const request_t *req, response_t *res) const -> boost::asio::awaitable<void>;
+};
+
+} // namespace http::handler
@@ -1,4 +1,6 @@
 #include "short_code_handler.hpp"
+#include "degraded.hpp"
+#include "http/redirect.hpp"
 #include <boost/json.hpp>
 
 namespace http::handler
@@ -12,72 +14,80 @@ ShortCodeHandler::ShortCodeHandler(boost::asio::any_io_executor executor, encode
 {
 }
 
-auto ShortCodeHandler::operator()(const request_t *req, response_t *res) const -> boost::asio::awaitable<void>
+auto ShortCodeHandler::operator()([[maybe_unused]] const request_t *req, response_t *res, RouteParams params) const
+    -> boost::asio::awaitable<void>
 {
+    // Answer cache hits in this frame: each nested coroutine would take another frame from the allocator.
+    const auto id = encoder_.decode(params.get("code"));
+    if (!id.has_value())
+    {
+        set_not_found(res);
+        co_return;
+    }
+    if (auto cached = storage_.cached_url(*id))
+    {
+        redirect(res, *id, {.url = std::move(cached)});
+        co_return;
+    }
+
     try
     {
-        if (co_await try_redirect(req->target(), res))
+        if (co_await try_redirect(*id, res))
         {
             co_return;
         }
     }
+    catch (const storage::BackendUnavailable &e)
+    {
+        // Storage is failing and no stale URL is known; ask the client to come back later.
+        reject_unavailable(res, e);
+        co_return;
+    }
     catch (const std::exception &)
     {
         res->result(http::status::internal_server_error);
         co_return;
     }
 
-    res->result(http::status::not_found);
-    res->set(http::field::content_type, "application/json");
-    res->body() = json::serialize(json::object{{"error", "Not found"}});
+    set_not_found(res);
     co_return;
 }
 
-auto ShortCodeHandler::try_redirect(std::string_view path, response_t *res) const -> boost::asio::awaitable<bool>
+auto ShortCodeHandler::try_redirect(std::uint64_t id, response_t *res) const -> boost::asio::awaitable<bool>
 {
-    // Extract short code from path (e.g., "/abc123" -> "abc123")
-    auto short_code = extract_short_code(path);
-
-    if (short_code.empty())
-    {
-        co_return false; // Not a valid short code format
-    }
-
-    // Try to decode the short code
-    auto decode_result = encoder_.decode(short_code);
-    if (!decode_result.has_value())
-    {
-        co_return false; // Invalid short code format
-    }
-
-    auto id = decode_result.value();
-
     // Look up the URL
-    auto url = co_await storage_.get_url(id);
-    if (!url.has_value())
+    auto lookup = co_await storage_.lookup_url(id);
+    if (!lookup.url)
     {
         co_return false; // Short code not found in storage
     }
 
-    // Return redirect response
-    res->result(http::status::found); // 302 redirect
-    res->set(http::field::location, url.value());
-    res->set(http::field::content_type, "text/html");
-
+    redirect(res, id, std::move(lookup));
     co_return true; // Successfully handled
 }
 
-auto ShortCodeHandler::extract_short_code(std::string_view path) const -> std::string_view
+void ShortCodeHandler::redirect(response_t *res, std::uint64_t id, storage::UrlLookup lookup) const
 {
-    // Remove leading slash: "/abc123" -> "abc123"
-    if (path.starts_with('/'))
+    set_redirect(res, std::move(lookup.url));
+
+    storage_.record_click(id);
+
+    // Redirects keep working while storage fails; say so when the answer may be out of date.
+    if (lookup.stale)
     {
-        path.remove_prefix(1);
+        res->set(http::field::warning, R"(110 - "Response is Stale")");
     }
+    if (lookup.stale || storage_.degraded())
+    {
+        res->set(kDegradedHeader, "1");
+    }
+}
 
-    // For now, assume the entire remaining path is the short code
-    // We could add more validation here (e.g., check length, character set)
-    return path;
+void ShortCodeHandler::set_not_found(response_t *res)
+{
+    res->result(http::status::not_found);
+    res->set(http::field::content_type, "application/json");
+    res->body() = json::serialize(json::object{{"error", "Not found"}});
 }
 
 } // namespace http::handler
\ No newline at end of file
@@ -10,29 +10,32 @@ namespace http::handler
 {
 
 /**
- * @brief Handles short code redirects and fallback 404 responses.
+ * @brief Handles short code redirects (`GET /{code}`).
  *
- * This handler first attempts to process the request as a short code redirect.
- * If the path looks like a valid short code and exists in storage, it performs the redirect.
- * Otherwise, it returns a 404 Not Found response.
+ * The router binds the short code as the `code` parameter (any query string
+ * is not part of it). If the code is valid and exists in storage, this
+ * handler performs the redirect. Otherwise, it returns a 404 Not Found response.
  */
 class ShortCodeHandler
 {
   public:
     ShortCodeHandler(boost::asio::any_io_executor executor, encode::Encoder encoder, storage::StorageService storage);
 
-    auto operator()(const request_t *req, response_t *res) const -> boost::asio::awaitable<void>;
+    auto operator()(const request_t *req, response_t *res, RouteParams params) const
+        -> boost::asio::awaitable<void>;
 
   private:
     boost::asio::any_io_executor executor_;
     encode::Encoder encoder_;
     storage::StorageService storage_;
 
-    // Check if path looks like a short code and handle redirect
-    [[nodiscard]] auto try_redirect(std::string_view path, response_t *res) const -> boost::asio::awaitable<bool>;
+    // Look the ID up in storage and handle redirect
+    [[nodiscard]] auto try_redirect(std::uint64_t id, response_t *res) const -> boost::asio::awaitable<bool>;
 
-    // Extract short code from path (e.g., "/abc123" -> "abc123")
-    [[nodiscard]] auto extract_short_code(std::string_view path) const -> std::string_view;
+    // Write the redirect to `lookup.url` and count the click
+    void redirect(response_t *res, std::uint64_t id, storage::UrlLookup lookup) const;
+
+    static void set_not_found(response_t *res);
 };
 
 } // namespace http::handler
\ No newline at end of file
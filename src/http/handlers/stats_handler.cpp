@@ -0,0 +1,151 @@
+#include "stats_handler.hpp"
+#include <boost/json.hpp>
+
+namespace http::handler
+{
+
+namespace json = boost::json;
+
+StatsHandler::StatsHandler(storage::StorageService storage) : storage_{std::move(storage)}
+{
+}
+
+auto StatsHandler::operator()([[maybe_unused]] const request_t *req, response_t *res) const
+    -> boost::asio::awaitable<void>
+{
+    const auto cache = storage_.cache_stats();
+
+    json::object cache_body;
+    cache_body["hits"] = cache.hits;
+    cache_body["misses"] = cache.misses;
+    cache_body["evictions"] = cache.evictions;
+    cache_body["entries"] = cache.entries;
+    cache_body["pinned"] = cache.pinned;
+    cache_body["size_bytes"] = cache.size_bytes;
+    cache_body["capacity_bytes"] = cache.capacity_bytes;
+
+    const auto filter = storage_.lookup_filter_stats();
+
+    json::object filter_body;
+    filter_body["high_water"] = filter.high_water;
+    filter_body["rejected_above_high_water"] = filter.rejected_above_high_water;
+    filter_body["rejected_known_missing"] = filter.rejected_known_missing;
+
+    const auto coalescing = storage_.lookup_coalescing_stats();
+
+    json::object coalescing_body;
+    coalescing_body["fetches"] = coalescing.fetches;
+    coalescing_body["coalesced"] = coalescing.coalesced;
+
+    const auto batching = storage_.lookup_batching_stats();
+
+    json::object batching_body;
+    batching_body["batches"] = batching.batches;
+    batching_body["keys"] = batching.keys;
+
+    const auto codec = storage_.url_codec_stats();
+
+    json::object codec_body;
+    codec_body["encoded"] = codec.encoded;
+    codec_body["raw_bytes"] = codec.raw_bytes;
+    codec_body["encoded_bytes"] = codec.encoded_bytes;
+
+    const auto dedup = storage_.dedup_stats();
+
+    json::object dedup_body;
+    dedup_body["local_hits"] = dedup.local_hits;
+    dedup_body["remote_hits"] = dedup.remote_hits;
+    dedup_body["created"] = dedup.created;
+
+    const auto invalidations = storage_.invalidation_stats();
+
+    json::object invalidations_body;
+    invalidations_body["messages"] = invalidations.messages;
+    invalidations_body["keys"] = invalidations.keys;
+    invalidations_body["flushes"] = invalidations.flushes;
+
+    const auto clicks = storage_.click_stats();
+
+    json::object clicks_body;
+    clicks_body["recorded"] = clicks.recorded;
+    clicks_body["flushed"] = clicks.flushed;
+    clicks_body["flushes"] = clicks.flushes;
+    clicks_body["flush_errors"] = clicks.flush_errors;
+
+    const auto hot_links = storage_.hot_link_stats();
+
+    json::object hot_links_body;
+    hot_links_body["recorded"] = hot_links.recorded;
+    hot_links_body["merges"] = hot_links.merges;
+    hot_links_body["tracked"] = hot_links.tracked;
+
+    const auto degraded = storage_.degraded_stats();
+
+    json::object degraded_body;
+    degraded_body["active"] = degraded.active;
+    degraded_body["episodes"] = degraded.episodes;
+    degraded_body["failed_ops"] = degraded.failed_ops;
+    degraded_body["stale_hits"] = degraded.stale_hits;
+    degraded_body["stale_entries"] = degraded.stale_entries;
+
+    json::array shards_body;
+    for (const auto &shard : storage_.shard_stats())
+    {
+        json::array connections_body;
+        for (const auto &connection : shard.connections)
+        {
+            connections_body.push_back(json::object{{"commands", connection.commands},
+                                                    {"errors", connection.errors},
+                                                    {"timeouts", connection.timeouts},
+                                                    {"in_flight", connection.in_flight}});
+        }
+
+        json::array breakers_body;
+        for (const auto &breaker : shard.breakers)
+        {
+            breakers_body.push_back(json::object{{"state", breaker.state},
+                                                 {"opened", breaker.opened},
+                                                 {"half_opened", breaker.half_opened},
+                                                 {"closed", breaker.closed},
+                                                 {"rejected", breaker.rejected}});
+        }
+
+        json::array replicas_body;
+        for (const auto &replica : shard.replicas)
+        {
+            replicas_body.emplace_back(replica);
+        }
+
+        shards_body.push_back(json::object{{"node", shard.node},
+                                           {"lookups", shard.lookups},
+                                           {"migrated", shard.migrated},
+                                           {"replicas", std::move(replicas_body)},
+                                           {"replica_reads", shard.replica_reads},
+                                           {"primary_fallbacks", shard.primary_fallbacks},
+                                           {"hedged_reads", shard.hedged_reads},
+                                           {"connections", std::move(connections_body)},
+                                           {"breakers", std::move(breakers_body)}});
+    }
+
+    json::object body;
+    body["storage_backend"] = storage_.backend_name();
+    body["redis_shards"] = std::move(shards_body);
+    body["cache"] = std::move(cache_body);
+    body["lookup_filter"] = std::move(filter_body);
+    body["lookup_coalescing"] = std::move(coalescing_body);
+    body["lookup_batching"] = std::move(batching_body);
+    body["url_compression"] = std::move(codec_body);
+    body["dedup"] = std::move(dedup_body);
+    body["invalidations"] = std::move(invalidations_body);
+    body["clicks"] = std::move(clicks_body);
+    body["hot_links"] = std::move(hot_links_body);
+    body["degraded"] = std::move(degraded_body);
+
+    res->result(http::status::ok);
+    res->set(http::field::content_type, "application/json");
+    res->body() = json::serialize(body);
+
+    co_return;
+}
+
+} // namespace http::handler
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "http/router.hpp" // For request_t and response_t
+#include "storage/storage_service.hpp"
+#include <boost/asio/awaitable.hpp>
+
+namespace http::handler
+{
+
+/**
+ * @brief Handles requests to the /api/stats endpoint.
+ *
+ * This handler reports runtime counters of the storage layer, such as
+ * Redis connection usage, redirect cache hits and misses or lookups
+ * rejected by the negative lookup filter, as a JSON object.
+ */
+class StatsHandler
+{
+  public:
+    explicit StatsHandler(storage::StorageService storage);
+
+    auto operator()(const request_t *req, response_t *res) const -> boost::asio::awaitable<void>;
+
+  private:
+    storage::StorageService storage_;
+};
+
+} // namespace http::handler
@@ -0,0 +1,136 @@
+#include "io_context_pool.hpp"
+#include "util/thread_slot.hpp"
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <pthread.h>
+#include <sched.h>
+#include <system_error>
+#include <thread>
+#include <utility>
+
+namespace http
+{
+
+namespace
+{
+// Lists the CPUs the process may run on, in ascending order.
+auto allowed_cpus() -> std::vector<int>
+{
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) != 0)
+    {
+        return cpus;
+    }
+    for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+    {
+        if (CPU_ISSET(cpu, &set))
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+} // namespace
+
+IoContextPool::IoContextPool(std::size_t threads, bool per_thread, std::vector<int> cpus, logging::logger_t logger)
+    : threads_{threads == 0 ? 1 : threads}, cpus_{std::move(cpus)}, logger_{std::move(logger)}
+{
+    if (per_thread)
+    {
+        // A concurrency hint of 1 tells asio that one thread runs each context. It does not disable locking
+        // (only BOOST_ASIO_CONCURRENCY_HINT_UNSAFE does), which is needed anyway: other threads post to these
+        // contexts, e.g. storage's background work and connections resuming lookups.
+        contexts_.reserve(threads_);
+        for (std::size_t i = 0; i < threads_; ++i)
+        {
+            contexts_.push_back(std::make_unique<boost::asio::io_context>(1));
+        }
+        if (cpus_.empty())
+        {
+            cpus_ = allowed_cpus();
+        }
+    }
+    else
+    {
+        contexts_.push_back(std::make_unique<boost::asio::io_context>());
+    }
+}
+
+auto IoContextPool::executors() const -> std::vector<boost::asio::any_io_executor>
+{
+    std::vector<boost::asio::any_io_executor> executors;
+    executors.reserve(contexts_.size());
+    for (const auto &context : contexts_)
+    {
+        executors.emplace_back(context->get_executor());
+    }
+    return executors;
+}
+
+auto IoContextPool::run() -> void
+{
+    std::vector<std::thread> threads;
+    threads.reserve(threads_ - 1);
+    for (std::size_t i = 1; i < threads_; ++i)
+    {
+        threads.emplace_back([this, i] { run_thread(i); });
+    }
+
+    // Run on the main thread
+    run_thread(0);
+
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+}
+
+auto IoContextPool::stop() noexcept -> void
+{
+    for (const auto &context : contexts_)
+    {
+        context->stop();
+    }
+}
+
+auto IoContextPool::run_thread(std::size_t index) -> void
+{
+    // Thread i uses shard i of every per-thread structure (Redis connection, counters, sketches).
+    if (contexts_.size() > 1)
+    {
+        util::bind_thread_slot(index);
+    }
+    if (!cpus_.empty())
+    {
+        pin_thread(index, cpus_[index % cpus_.size()]);
+    }
+
+    contexts_[index % contexts_.size()]->run();
+}
+
+auto IoContextPool::pin_thread(std::size_t index, int cpu) -> void
+{
+    if (cpu >= CPU_SETSIZE)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Not pinning worker thread " << index << ": CPU " << cpu << " is out of range";
+        return;
+    }
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (const auto rc = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set); rc != 0)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Pinning worker thread " << index << " to CPU " << cpu
+            << " failed: " << std::system_category().message(rc);
+        return;
+    }
+
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Worker thread " << index << " runs on CPU " << cpu;
+}
+
+} // namespace http
@@ -0,0 +1,79 @@
+#pragma once
+
+#include "logging/logger_setup.hpp"
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/io_context.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace http
+{
+
+/**
+ * @brief The io_contexts the server's worker threads run.
+ *
+ * In the default mode, all threads run one shared io_context, so any thread
+ * may pick up any handler. In thread-per-core mode, every thread runs its own
+ * single-threaded io_context (thread i runs context i and is bound to thread
+ * slot i), so work spawned on a context never leaves its thread.
+ *
+ * Threads can be pinned to CPUs: thread i runs on `cpus[i % cpus.size()]`.
+ * In thread-per-core mode without an explicit list, thread i takes the i-th
+ * CPU the process may run on.
+ */
+class IoContextPool
+{
+  public:
+    /**
+     * @brief Creates the io_contexts.
+     * @param threads Number of worker threads.
+     * @param per_thread Whether every thread gets its own io_context.
+     * @param cpus CPUs to pin the threads to (empty: see above).
+     * @param logger Logger for affinity failures.
+     */
+    IoContextPool(std::size_t threads, bool per_thread, std::vector<int> cpus, logging::logger_t logger);
+
+    IoContextPool(const IoContextPool &) = delete;
+    auto operator=(const IoContextPool &) -> IoContextPool & = delete;
+    IoContextPool(IoContextPool &&) = delete;
+    auto operator=(IoContextPool &&) -> IoContextPool & = delete;
+    ~IoContextPool() = default;
+
+    /// @brief Gets the number of io_contexts (1, or one per thread).
+    [[nodiscard]] auto size() const noexcept -> std::size_t
+    {
+        return contexts_.size();
+    }
+
+    /// @brief Gets io_context `i`.
+    [[nodiscard]] auto context(std::size_t i) noexcept -> boost::asio::io_context &
+    {
+        return *contexts_[i];
+    }
+
+    /// @brief Gets the executor of every io_context, indexed like the contexts.
+    [[nodiscard]] auto executors() const -> std::vector<boost::asio::any_io_executor>;
+
+    /**
+     * @brief Runs the worker threads until stop() is called; the calling thread is thread 0.
+     */
+    void run();
+
+    /// @brief Stops every io_context (thread-safe).
+    void stop() noexcept;
+
+  private:
+    // Binds the calling thread to its slot and CPU, then runs its io_context.
+    void run_thread(std::size_t index);
+
+    // Pins the calling thread to `cpu`; failures are logged.
+    void pin_thread(std::size_t index, int cpu);
+
+    std::size_t threads_;
+    std::vector<std::unique_ptr<boost::asio::io_context>> contexts_;
+    std::vector<int> cpus_;
+    mutable logging::logger_t logger_;
+};
+
+} // namespace http
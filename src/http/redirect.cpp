@@ -0,0 +1,51 @@
+#include "redirect.hpp"
+
+namespace http
+{
+
+namespace
+{
+constexpr beast::string_view kContentType = "text/html";
+
+// Everything the serializer would write before the Location value, given the fields add_redirect_fields() adds and
+// the Server header and Content-Length the server adds to every response.
+constexpr std::string_view kHead = "HTTP/1.1 302 Found\r\n"
+                                   "Server: Swftly\r\n"
+                                   "Content-Type: text/html\r\n"
+                                   "Content-Length: 0\r\n"
+                                   "Location: ";
+
+constexpr std::string_view kKeepAliveTail = "\r\n\r\n";
+constexpr std::string_view kCloseTail = "\r\nConnection: close\r\n\r\n";
+} // namespace
+
+void set_redirect(response_t *res, std::shared_ptr<const std::string> location)
+{
+    res->result(http::status::found);
+    res->redirect = std::move(location);
+}
+
+auto is_plain_redirect(const request_t &req, const response_t &res) noexcept -> bool
+{
+    return req.version() == 11 && res.redirect && res.result() == http::status::found && res.body().empty() &&
+           res.begin() == res.end();
+}
+
+void add_redirect_fields(response_t *res)
+{
+    if (!res->redirect)
+    {
+        return;
+    }
+    res->set(http::field::location, *res->redirect);
+    res->set(http::field::content_type, kContentType);
+}
+
+auto redirect_buffers(std::string_view location, bool keep_alive) noexcept
+    -> std::array<boost::asio::const_buffer, 3>
+{
+    const auto tail = keep_alive ? kKeepAliveTail : kCloseTail;
+    return {boost::asio::buffer(kHead), boost::asio::buffer(location), boost::asio::buffer(tail)};
+}
+
+} // namespace http
@@ -0,0 +1,50 @@
+#pragma once
+
+#include "router.hpp" // For request_t and response_t
+#include <array>
+#include <boost/asio/buffer.hpp>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace http
+{
+
+/**
+ * @brief Turns `res` into a plain redirect: 302 Found with a Location and an empty text/html body.
+ *
+ * Only the status is set; the location is shared into `res->redirect`
+ * rather than copied into the header fields. Handlers may add headers
+ * afterwards; the response is then no longer plain and is serialized by Beast
+ * like any other, after add_redirect_fields().
+ */
+void set_redirect(response_t *res, std::shared_ptr<const std::string> location);
+
+/**
+ * @brief Checks whether `res` answers `req` with a redirect that the server can send as the bytes of
+ * redirect_buffers(), in one gather write instead of through the serializer.
+ *
+ * True for HTTP/1.1 requests whose response was built by set_redirect() and
+ * has no header fields or body since.
+ */
+[[nodiscard]] auto is_plain_redirect(const request_t &req, const response_t &res) noexcept -> bool;
+
+/**
+ * @brief Adds the Location and Content-Type fields of a redirect set by set_redirect(), for Beast to serialize.
+ *
+ * Does nothing unless `res->redirect` is set.
+ */
+void add_redirect_fields(response_t *res);
+
+/**
+ * @brief Gets the wire bytes of a plain redirect as three buffers for one scatter-gather write.
+ *
+ * The status line and every header but Location are pre-built constants; only
+ * the Location value and the keep-alive choice vary. No bytes are copied.
+ * @param location The Location value; must outlive the write.
+ * @param keep_alive Whether the connection stays open afterwards.
+ */
+[[nodiscard]] auto redirect_buffers(std::string_view location, bool keep_alive) noexcept
+    -> std::array<boost::asio::const_buffer, 3>;
+
+} // namespace http
@@ -0,0 +1,169 @@
+#include "route_tree.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+namespace http
+{
+
+RouteTree::RouteTree() : nodes_(1)
+{
+}
+
+auto RouteTree::insert(boost::beast::http::verb method, std::string_view pattern, std::size_t index) -> void
+{
+    if (!pattern.starts_with('/'))
+    {
+        throw std::invalid_argument{"Route pattern must start with '/': " + std::string{pattern}};
+    }
+
+    const std::string full{pattern};
+    std::size_t node = 0;
+    std::size_t params = 0;
+    while (!pattern.empty())
+    {
+        const auto open = pattern.find('{');
+        node = insert_static(node, pattern.substr(0, open));
+        if (open == std::string_view::npos)
+        {
+            break;
+        }
+
+        // A parameter spans a whole segment: "/{name}" followed by '/' or the end.
+        const auto close = pattern.find('}', open);
+        const auto name = pattern.substr(open + 1, close == std::string_view::npos ? 0 : close - open - 1);
+        if (close == std::string_view::npos || name.empty() || pattern[open - 1] != '/' ||
+            (close + 1 < pattern.size() && pattern[close + 1] != '/') || name.find_first_of("{}/") != name.npos)
+        {
+            throw std::invalid_argument{"Malformed route parameter in " + full};
+        }
+        if (++params > kMaxRouteParams)
+        {
+            throw std::invalid_argument{"Too many route parameters in " + full};
+        }
+
+        if (nodes_[node].param_child == kNoRoute)
+        {
+            nodes_[node].param_name = name;
+            nodes_[node].param_child = nodes_.size();
+            nodes_.emplace_back();
+        }
+        else if (nodes_[node].param_name != name)
+        {
+            throw std::invalid_argument{"Route parameter {" + std::string{name} + "} in " + full +
+                                        " conflicts with {" + nodes_[node].param_name + "}"};
+        }
+        node = nodes_[node].param_child;
+        pattern.remove_prefix(close + 1);
+    }
+
+    auto &routes = nodes_[node].routes;
+    if (std::ranges::any_of(routes, [method](const auto &route) { return route.first == method; }))
+    {
+        throw std::invalid_argument{"Route is defined twice: " + full};
+    }
+    routes.emplace_back(method, index);
+}
+
+auto RouteTree::insert_static(std::size_t node, std::string_view text) -> std::size_t
+{
+    while (!text.empty())
+    {
+        const auto &children = nodes_[node].children;
+        const auto it = std::ranges::find_if(children, [&](std::size_t child)
+                                             { return nodes_[child].prefix.front() == text.front(); });
+        if (it == children.end())
+        {
+            const auto child = nodes_.size();
+            nodes_.emplace_back().prefix = text;
+            nodes_[node].children.push_back(child);
+            return child;
+        }
+
+        const auto child = *it;
+        const auto slot = static_cast<std::size_t>(it - children.begin());
+        const auto common = static_cast<std::size_t>(
+            std::ranges::mismatch(text, nodes_[child].prefix).in1 - text.begin());
+
+        if (common < nodes_[child].prefix.size())
+        {
+            // Split the edge: a new node takes the shared part and adopts the old child.
+            const auto split = nodes_.size();
+            auto prefix = nodes_[child].prefix.substr(0, common);
+            auto &shared = nodes_.emplace_back();
+            shared.prefix = std::move(prefix);
+            shared.children.push_back(child);
+            nodes_[child].prefix.erase(0, common);
+            nodes_[node].children[slot] = split;
+            node = split;
+        }
+        else
+        {
+            node = child;
+        }
+        text.remove_prefix(common);
+    }
+    return node;
+}
+
+auto RouteTree::find(boost::beast::http::verb method, std::string_view target, RouteParams &params) const noexcept
+    -> std::size_t
+{
+    const auto question = target.find('?');
+    if (question != std::string_view::npos)
+    {
+        params.query_ = target.substr(question + 1);
+        target = target.substr(0, question);
+    }
+    return match(0, method, target, params);
+}
+
+auto RouteTree::match(std::size_t node, boost::beast::http::verb method, std::string_view path,
+                      RouteParams &params) const noexcept -> std::size_t
+{
+    const auto &current = nodes_[node];
+    if (path.empty())
+    {
+        const auto it =
+            std::ranges::find_if(current.routes, [method](const auto &route) { return route.first == method; });
+        return it == current.routes.end() ? kNoRoute : it->second;
+    }
+
+    for (const auto child : current.children)
+    {
+        const auto &prefix = nodes_[child].prefix;
+        if (prefix.front() == path.front())
+        {
+            if (path.starts_with(prefix))
+            {
+                if (const auto index = match(child, method, path.substr(prefix.size()), params); index != kNoRoute)
+                {
+                    return index;
+                }
+            }
+            break; // Children have distinct first bytes
+        }
+    }
+
+    if (current.param_child != kNoRoute)
+    {
+        const auto value = path.substr(0, path.find('/'));
+        if (!value.empty())
+        {
+            params.params_[params.size_++] = {.name = current.param_name.data(),
+                                              .name_size = current.param_name.size(),
+                                              .value = value.data(),
+                                              .value_size = value.size()};
+            if (const auto index = match(current.param_child, method, path.substr(value.size()), params);
+                index != kNoRoute)
+            {
+                return index;
+            }
+            --params.size_;
+        }
+    }
+
+    return kNoRoute;
+}
+
+} // namespace http
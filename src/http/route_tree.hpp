@@ -0,0 +1,124 @@
+#pragma once
+
+#include <array>
+#include <boost/beast/http/verb.hpp>
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace http
+{
+
+constexpr std::size_t kMaxRouteParams = 4; ///< Most parameters a route pattern may have.
+
+/**
+ * @brief The parts of a request target a route matched: path parameters and the query string.
+ *
+ * Values are views into the request target and parameter names are views
+ * into the router, so nothing is copied; a RouteParams must not outlive the
+ * request it was matched from.
+ */
+class RouteParams
+{
+  public:
+    /// @brief Gets the value bound to parameter `name` (empty if the route has no such parameter).
+    [[nodiscard]] auto get(std::string_view name) const noexcept -> std::string_view
+    {
+        for (std::size_t i = 0; i < size_; ++i)
+        {
+            if (std::string_view{params_[i].name, params_[i].name_size} == name)
+            {
+                return {params_[i].value, params_[i].value_size};
+            }
+        }
+        return {};
+    }
+
+    /// @brief Gets the query string, without the '?' (empty if the target has none).
+    [[nodiscard]] auto query() const noexcept -> std::string_view
+    {
+        return query_;
+    }
+
+    /// @brief Gets the number of bound parameters.
+    [[nodiscard]] auto size() const noexcept -> std::size_t
+    {
+        return size_;
+    }
+
+  private:
+    friend class RouteTree;
+
+    // Trivially constructible, so that creating a RouteParams for every request writes nothing but size_ and
+    // query_ (zeroing the array costs more than a typical lookup); only the first size_ entries are set.
+    struct Param
+    {
+        const char *name;
+        std::size_t name_size;
+        const char *value;
+        std::size_t value_size;
+    };
+
+    std::array<Param, kMaxRouteParams> params_; // NOLINT(cppcoreguidelines-pro-type-member-init)
+    std::size_t size_{0};
+    std::string_view query_;
+};
+
+/**
+ * @brief A radix tree of route patterns, matched in O(path length).
+ *
+ * Patterns are paths whose segments may be parameters, such as
+ * `/api/urls/{code}/stats`; a parameter matches one non-empty path segment.
+ * Static text is stored on compressed edges, so a lookup compares every
+ * byte of the path about once. Where a static edge and a parameter both
+ * fit, the static edge is tried first and the parameter only if the rest of
+ * the path does not match under it, so `/ping` wins over `/{code}`.
+ *
+ * Every pattern may carry one route per method; routes are identified by the
+ * index given to insert().
+ */
+class RouteTree
+{
+  public:
+    static constexpr std::size_t kNoRoute = std::numeric_limits<std::size_t>::max();
+
+    RouteTree();
+
+    /**
+     * @brief Adds route `index` for `method` and `pattern`.
+     * @throws std::invalid_argument If the pattern is malformed, has more than kMaxRouteParams parameters,
+     *         names a parameter differently than an existing pattern at the same position, or is already routed.
+     */
+    void insert(boost::beast::http::verb method, std::string_view pattern, std::size_t index);
+
+    /**
+     * @brief Finds the route for `method` and `target`, binding its parameters and the query string.
+     * @return The route's index, or kNoRoute.
+     */
+    [[nodiscard]] auto find(boost::beast::http::verb method, std::string_view target, RouteParams &params) const
+        noexcept -> std::size_t;
+
+  private:
+    struct Node
+    {
+        std::string prefix;                                                 // Static edge label
+        std::vector<std::size_t> children;                                  // Static children, distinct first bytes
+        std::size_t param_child{kNoRoute};                                  // Child matching one segment
+        std::string param_name;                                             // Name bound by param_child
+        std::vector<std::pair<boost::beast::http::verb, std::size_t>> routes; // Routes ending here
+    };
+
+    // Walks (creating and splitting edges as needed) from `node` along static text; returns the final node.
+    auto insert_static(std::size_t node, std::string_view text) -> std::size_t;
+
+    // Matches the rest of the path below `node`.
+    [[nodiscard]] auto match(std::size_t node, boost::beast::http::verb method, std::string_view path,
+                             RouteParams &params) const noexcept -> std::size_t;
+
+    std::vector<Node> nodes_; // nodes_[0] is the root
+};
+
+} // namespace http
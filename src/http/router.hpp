@@ -1,12 +1,17 @@
 #pragma once
 
+#include "route_tree.hpp"
+#include <algorithm>
+#include <array>
 #include <boost/asio/awaitable.hpp>
 #include <boost/beast/http.hpp>
-#include <boost/container_hash/hash.hpp>
-#include <functional>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
 #include <string>
 #include <string_view>
-#include <unordered_map>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
 namespace http
@@ -15,114 +20,196 @@ namespace http
 namespace beast = boost::beast;
 namespace http = beast::http;
 
-using request_t = http::request<http::string_body>;
-using response_t = http::response<http::string_body>;
-using handler_t = std::function<boost::asio::awaitable<void>(const request_t *, response_t *)>;
+// Header fields draw from a polymorphic allocator, so the server can give them a per-connection arena.
+using fields_t = http::basic_fields<std::pmr::polymorphic_allocator<char>>;
+using request_t = http::request<http::string_body, fields_t>;
 
 /**
- * @brief A composite key used for routing lookups in the router's map.
+ * @brief The response a handler fills in, with a slot for the target of a redirect.
  *
- * This struct owns the target path string to ensure its lifetime persists
- * as long as the route exists in the router. It is constructed from a
- * string_view to allow for flexibility at the call site.
+ * set_redirect() records the target in `redirect` instead of the header
+ * fields, so a plain redirect is written by the server straight from it (see
+ * redirect.hpp); the fields are only filled if the response needs Beast.
  */
-struct RouteKey
+struct Response : http::response<http::string_body, fields_t>
 {
-    http::verb method_;
-    std::string target_; // The router must own the string.
+    using message_t = http::response<http::string_body, fields_t>;
+    using message_t::message_t;
 
-    /**
-     * @brief Constructs a RouteKey for storage in the router.
-     *
-     * This constructor is marked explicit to prevent accidental or inefficient conversions.
-     * @param method The HTTP method (verb) for the route.
-     * @param target The request path. The view's data will be copied into an owned string.
-     */
-    explicit RouteKey(http::verb method, std::string_view target) : method_(method), target_(target)
+    std::shared_ptr<const std::string> redirect; ///< Location of a redirect set by set_redirect(), or null.
+};
+using response_t = Response;
+
+/**
+ * @brief A route pattern literal usable as a template argument, as in `Route<verb::get, "/{code}", Handler>`.
+ */
+template <std::size_t N>
+struct RoutePath
+{
+    // NOLINTNEXTLINE(google-explicit-constructor, cppcoreguidelines-avoid-c-arrays)
+    consteval RoutePath(const char (&path)[N]) noexcept
+    {
+        std::copy_n(path, N, value);
+    }
+
+    [[nodiscard]] constexpr auto view() const noexcept -> std::string_view
     {
+        return {value, N - 1};
     }
+
+    char value[N]{}; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+};
+
+/**
+ * @brief A handler bound to one method and path pattern, both known at compile time.
+ *
+ * A handler is any object with `operator()(const request_t *, response_t *) const`
+ * returning `boost::asio::awaitable<void>`. Handlers that need the path
+ * parameters or the query string take a third `RouteParams` argument, by
+ * value (the router's copy is gone once the handler is suspended).
+ */
+template <http::verb Method, RoutePath Path, typename Handler>
+struct Route
+{
+    static constexpr http::verb kMethod = Method;
+    static constexpr std::string_view kPath = Path.view();
+
+    Handler handler; ///< Called for requests with this method whose path matches the pattern.
 };
 
 /**
- * @brief A high-performance HTTP request router.
+ * @brief Binds `handler` to a compile-time method and path: `route<verb::get, "/ping">(PingHandler{})`.
+ */
+template <http::verb Method, RoutePath Path, typename Handler>
+[[nodiscard]] auto route(Handler handler) -> Route<Method, Path, Handler>
+{
+    return {std::move(handler)};
+}
+
+/**
+ * @brief Dispatches requests to handlers.
  *
- * This class maps incoming requests based on their method and path to specific
- * handler functions. It uses C++20's transparent hashing and equality features
- * to perform lookups without allocating a new string for each request, which
- * significantly improves performance.
+ * The server only knows this interface; StaticRouter implements it for a
+ * route table fixed at compile time.
  */
 class Router
 {
   public:
-    /**
-     * @brief Constructs the router.
-     * @param not_found_handler A handler to be invoked when no route matches a request.
-     */
-    explicit Router(handler_t not_found_handler);
+    Router() = default;
+    virtual ~Router() = default;
 
-    /**
-     * @brief Adds a new route to the router's dispatch table.
-     * @param key The RouteKey specifying the method and path.
-     * @param handler The function to execute when the route is matched.
-     */
-    void add_route(RouteKey key, handler_t handler);
+    Router(const Router &) = delete;
+    auto operator=(const Router &) -> Router & = delete;
+    Router(Router &&) = delete;
+    auto operator=(Router &&) -> Router & = delete;
 
     /**
      * @brief Dispatches a request to the appropriate handler.
      *
      * The handler will directly modify the response object provided.
-     * If no route is found, the not_found_handler will be invoked.
+     * If no route is found, the not-found handler will be invoked.
      * @param req The incoming HTTP request.
      * @param res The response object to be populated by the handler.
      */
-    auto dispatch(const request_t *req, response_t *res) const -> boost::asio::awaitable<void>;
+    [[nodiscard]] virtual auto dispatch(const request_t *req, response_t *res) const
+        -> boost::asio::awaitable<void> = 0;
+};
 
-  private:
-    // A transparent hasher that can hash both RouteKey and temporary lookup pairs
-    // without allocating strings.
-    struct RouteKeyHash
+/**
+ * @brief A router over a route table fixed at compile time.
+ *
+ * Every route's method and pattern are template constants and its handler is
+ * stored by value, so there is no type erasure and no extra coroutine frame:
+ * the patterns are indexed in a RouteTree when the router is constructed, a
+ * request's path (the target without its query string) is looked up in it,
+ * and dispatch() returns the matched handler's awaitable directly. Duplicate
+ * routes are rejected at compile time, malformed patterns at construction.
+ *
+ * @tparam NotFound Handler invoked when no route matches.
+ * @tparam Routes The routes, as Route<...> types.
+ */
+template <typename NotFound, typename... Routes>
+class StaticRouter final : public Router
+{
+  public:
+    /**
+     * @brief Constructs the router.
+     * @param not_found A handler to be invoked when no route matches a request.
+     * @param routes The routes (see route()).
+     */
+    explicit StaticRouter(NotFound not_found, Routes... routes)
+        : not_found_{std::move(not_found)}, routes_{std::move(routes)...}
     {
-        using is_transparent = void;
+        static_assert(unique_routes(), "Every method and path may only be routed once");
 
-        // Hash for stored RouteKey
-        auto operator()(const RouteKey &k) const noexcept -> std::size_t
-        {
-            return boost::hash_value(std::tie(k.method_, k.target_));
-        }
+        std::size_t index = 0;
+        (tree_.insert(Routes::kMethod, Routes::kPath, index++), ...);
+    }
 
-        // Hash for temporary lookup pair (avoids string allocation)
-        auto operator()(const std::pair<http::verb, std::string_view> &k) const noexcept -> std::size_t
+    [[nodiscard]] auto dispatch(const request_t *req, response_t *res) const -> boost::asio::awaitable<void> override
+    {
+        const auto target = req->target();
+        RouteParams params;
+        const auto index = tree_.find(req->method(), std::string_view{target.data(), target.size()}, params);
+        return call(index == RouteTree::kNoRoute ? sizeof...(Routes) : index, req, res, params);
+    }
+
+  private:
+    // Checks that no two routes share a method and path.
+    [[nodiscard]] static consteval auto unique_routes() noexcept -> bool
+    {
+        constexpr std::array<std::pair<http::verb, std::string_view>, sizeof...(Routes)> keys{
+            std::pair{Routes::kMethod, Routes::kPath}...};
+        for (std::size_t i = 0; i < keys.size(); ++i)
         {
-            return boost::hash_value(k);
+            for (std::size_t j = i + 1; j < keys.size(); ++j)
+            {
+                if (keys[i] == keys[j])
+                {
+                    return false;
+                }
+            }
         }
-    };
+        return true;
+    }
 
-    // A transparent equality comparator that can compare both RouteKey and lookup pairs
-    struct RouteKeyEqual
+    // Calls the handler of route `index` (the not-found handler past the last route).
+    template <std::size_t I = 0>
+    [[nodiscard]] auto call(std::size_t index, const request_t *req, response_t *res, const RouteParams &params) const
+        -> boost::asio::awaitable<void>
     {
-        using is_transparent = void;
-
-        // Compare two RouteKeys
-        auto operator()(const RouteKey &lhs, const RouteKey &rhs) const noexcept -> bool
+        if constexpr (I == sizeof...(Routes))
         {
-            return lhs.method_ == rhs.method_ && lhs.target_ == rhs.target_;
+            return invoke(not_found_, req, res, params);
         }
-
-        // Compare lookup pair with RouteKey
-        auto operator()(const std::pair<http::verb, std::string_view> &lhs, const RouteKey &rhs) const noexcept -> bool
+        else
         {
-            return lhs.first == rhs.method_ && lhs.second == rhs.target_;
+            if (index == I)
+            {
+                return invoke(std::get<I>(routes_).handler, req, res, params);
+            }
+            return call<I + 1>(index, req, res, params);
         }
+    }
 
-        // Compare RouteKey with lookup pair (for symmetry)
-        auto operator()(const RouteKey &lhs, const std::pair<http::verb, std::string_view> &rhs) const noexcept -> bool
+    // Calls `handler` with the route parameters if it takes them.
+    template <typename Handler>
+    [[nodiscard]] static auto invoke(const Handler &handler, const request_t *req, response_t *res,
+                                     const RouteParams &params) -> boost::asio::awaitable<void>
+    {
+        if constexpr (std::is_invocable_v<const Handler &, const request_t *, response_t *, RouteParams>)
         {
-            return lhs.method_ == rhs.first && lhs.target_ == rhs.second;
+            return handler(req, res, params);
         }
-    };
+        else
+        {
+            return handler(req, res);
+        }
+    }
 
-    std::unordered_map<RouteKey, handler_t, RouteKeyHash, RouteKeyEqual> routes_;
-    handler_t not_found_handler_;
+    NotFound not_found_;
+    std::tuple<Routes...> routes_;
+    RouteTree tree_;
 };
 
-} // namespace http
\ No newline at end of file
+} // namespace http
@@ -0,0 +1,158 @@
+#include "router_benchmark.hpp"
+#include "router.hpp"
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/use_future.hpp>
+#include <boost/container_hash/hash.hpp>
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <functional>
+#include <iostream>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace http
+{
+
+namespace
+{
+constexpr std::chrono::milliseconds kMinRunTime{200};
+
+// Counts its calls, so the compiler cannot drop the dispatches.
+struct NoopHandler
+{
+    std::size_t *calls;
+
+    auto operator()(const request_t * /*req*/, response_t * /*res*/) const -> boost::asio::awaitable<void>
+    {
+        ++*calls;
+        co_return;
+    }
+};
+
+// The hash map router: std::function handlers keyed by exact method and target; short codes are not found.
+class MapRouter final : public Router
+{
+  public:
+    using handler_t = std::function<boost::asio::awaitable<void>(const request_t *, response_t *)>;
+
+    explicit MapRouter(handler_t not_found) : not_found_{std::move(not_found)}
+    {
+    }
+
+    void add_route(http::verb method, std::string_view target, handler_t handler)
+    {
+        routes_.emplace(key_t{method, target}, std::move(handler));
+    }
+
+    [[nodiscard]] auto dispatch(const request_t *req, response_t *res) const -> boost::asio::awaitable<void> override
+    {
+        const auto target = req->target();
+        if (const auto it = routes_.find(key_t{req->method(), {target.data(), target.size()}}); it != routes_.end())
+        {
+            co_await it->second(req, res);
+            co_return;
+        }
+
+        co_await not_found_(req, res);
+    }
+
+  private:
+    using key_t = std::pair<http::verb, std::string_view>;
+
+    std::unordered_map<key_t, handler_t, boost::hash<key_t>> routes_;
+    handler_t not_found_;
+};
+
+// Dispatches every request over and over until kMinRunTime has elapsed; returns nanoseconds per dispatch.
+auto time_per_dispatch(const Router &router, const std::vector<request_t> &requests)
+    -> boost::asio::awaitable<double>
+{
+    response_t response;
+    std::size_t rounds = 0;
+    const auto started = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::duration{};
+    do
+    {
+        for (const auto &request : requests)
+        {
+            co_await router.dispatch(&request, &response);
+        }
+        ++rounds;
+        elapsed = std::chrono::steady_clock::now() - started;
+    } while (elapsed < kMinRunTime);
+
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    co_return static_cast<double>(nanos) / static_cast<double>(rounds * requests.size());
+}
+
+auto measure(const Router &router, const std::vector<request_t> &requests) -> double
+{
+    boost::asio::io_context ioc{1};
+    auto result = boost::asio::co_spawn(ioc, time_per_dispatch(router, requests), boost::asio::use_future);
+    ioc.run();
+    return result.get();
+}
+} // namespace
+
+auto run_router_benchmark() -> int
+{
+    // The server's static routes, and the targets of its requests: every static route plus short codes.
+    constexpr std::array<std::pair<http::verb, std::string_view>, 7> kRoutes{{
+        {http::verb::get, "/"},
+        {http::verb::get, "/ping"},
+        {http::verb::post, "/api/urls"},
+        {http::verb::post, "/api/urls/batch"},
+        {http::verb::get, "/api/stats"},
+        {http::verb::post, "/api/clicks"},
+        {http::verb::get, "/api/hot-links"},
+    }};
+    constexpr std::array<std::string_view, 3> kShortCodes{"/abc123", "/Zx9Kq0", "/4fT"};
+
+    std::vector<request_t> requests;
+    for (const auto &[method, target] : kRoutes)
+    {
+        requests.emplace_back(method, beast::string_view{target.data(), target.size()}, 11);
+    }
+    for (const auto target : kShortCodes)
+    {
+        requests.emplace_back(http::verb::get, beast::string_view{target.data(), target.size()}, 11);
+    }
+
+    std::size_t calls = 0;
+    const NoopHandler noop{&calls};
+
+    const StaticRouter static_router{
+        noop,
+        route<http::verb::get, "/">(noop),
+        route<http::verb::get, "/ping">(noop),
+        route<http::verb::post, "/api/urls">(noop),
+        route<http::verb::post, "/api/urls/batch">(noop),
+        route<http::verb::get, "/api/stats">(noop),
+        route<http::verb::post, "/api/clicks">(noop),
+        route<http::verb::get, "/api/hot-links">(noop),
+        route<http::verb::get, "/{code}">(noop),
+    };
+
+    MapRouter map_router{noop};
+    for (const auto &[method, target] : kRoutes)
+    {
+        map_router.add_route(method, target, noop);
+    }
+
+    const auto static_ns = measure(static_router, requests);
+    const auto map_ns = measure(map_router, requests);
+
+    std::cout << std::format("Request mix:       {} static routes, {} short codes\n", kRoutes.size(),
+                             kShortCodes.size());
+    std::cout << std::format("Static router:     {:.1f} ns/dispatch\n", static_ns);
+    std::cout << std::format("Hash map router:   {:.1f} ns/dispatch\n", map_ns);
+    std::cout << std::format("Speedup:           {:.2f}x\n", map_ns / static_ns);
+    return calls > 0 ? 0 : 1;
+}
+
+} // namespace http
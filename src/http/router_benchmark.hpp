@@ -0,0 +1,20 @@
+#pragma once
+
+namespace http
+{
+
+/**
+ * @brief Measures request routing (--router-benchmark).
+ *
+ * Dispatches a fixed mix of requests (every static route of the server plus
+ * short codes) to no-op handlers, once through a StaticRouter with the
+ * server's route patterns and once through a hash map of std::function
+ * handlers keyed by exact method and target (the original router, where
+ * short codes fall through to the not-found handler), and prints the
+ * average time per dispatch of both.
+ *
+ * @return The process exit code.
+ */
+[[nodiscard]] auto run_router_benchmark() -> int;
+
+} // namespace http
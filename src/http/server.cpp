@@ -1,20 +1,26 @@
 #include "server.hpp"
+#include "redirect.hpp"
 #include <boost/asio/as_tuple.hpp>
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/co_spawn.hpp>
 #include <boost/asio/error.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/use_awaitable.hpp>
+#include <boost/asio/write.hpp>
 #include <boost/beast/core.hpp>
 #include <boost/beast/http.hpp>
 #include <boost/json.hpp>
 #include <boost/log/sources/record_ostream.hpp>
 #include <boost/log/trivial.hpp>
 #include <boost/system/system_error.hpp>
+#include <array>
 #include <csignal>
+#include <cstddef>
 #include <expected>
 #include <format>
-#include <thread>
+#include <memory_resource>
+#include <sys/socket.h>
+#include <tuple>
 #include <vector>
 
 namespace http
@@ -24,9 +30,45 @@ using namespace std::string_view_literals;
 using namespace std::chrono_literals;
 namespace json = boost::json;
 
+namespace
+{
+// SO_REUSEPORT as an asio SettableSocketOption; asio has no public option for it.
+class ReusePort
+{
+  public:
+    explicit ReusePort(bool enabled) : value_{enabled ? 1 : 0}
+    {
+    }
+
+    template <typename Protocol> [[nodiscard]] auto level(const Protocol & /*protocol*/) const -> int
+    {
+        return SOL_SOCKET;
+    }
+
+    template <typename Protocol> [[nodiscard]] auto name(const Protocol & /*protocol*/) const -> int
+    {
+        return SO_REUSEPORT;
+    }
+
+    template <typename Protocol> [[nodiscard]] auto data(const Protocol & /*protocol*/) const -> const int *
+    {
+        return &value_;
+    }
+
+    template <typename Protocol> [[nodiscard]] auto size(const Protocol & /*protocol*/) const -> std::size_t
+    {
+        return sizeof(value_);
+    }
+
+  private:
+    int value_;
+};
+} // namespace
+
 Server::Server(const conf::Config &config, logging::logger_t &logger, const Router &router,
-               boost::asio::io_context &ioc) noexcept
-    : config_(config), logger_(logger), router_(router), ioc_(ioc), signals_(ioc, SIGINT, SIGTERM)
+               IoContextPool &io_contexts) noexcept
+    : config_(config), logger_(logger), router_(router), io_contexts_(io_contexts),
+      signals_(io_contexts.context(0), SIGINT, SIGTERM)
 {
 }
 
@@ -34,8 +76,14 @@ auto Server::start() -> std::expected<void, ServerError>
 {
     try
     {
-        auto const address = boost::asio::ip::make_address(config_.address());
-        boost::asio::ip::tcp::endpoint endpoint{address, static_cast<std::uint16_t>(config_.port())};
+        // Bind every listener up front, so that bind errors are reported here.
+        const bool shared_port = io_contexts_.size() > 1;
+        std::vector<boost::asio::ip::tcp::acceptor> acceptors;
+        acceptors.reserve(io_contexts_.size());
+        for (std::size_t i = 0; i < io_contexts_.size(); ++i)
+        {
+            acceptors.push_back(make_acceptor(io_contexts_.context(i), shared_port));
+        }
 
         running_ = true;
 
@@ -46,41 +94,29 @@ auto Server::start() -> std::expected<void, ServerError>
         // Setup graceful shutdown
         setup_signal_handling();
 
-        // Spawn the listener coroutine using C++20 coroutines
-        boost::asio::co_spawn(ioc_, do_listen(),
-                              [this](std::exception_ptr e)
-                              {
-                                  if (e)
+        // Spawn one listener coroutine per io_context; each serves its connections on its own context
+        for (std::size_t i = 0; i < acceptors.size(); ++i)
+        {
+            boost::asio::co_spawn(io_contexts_.context(i), do_listen(std::move(acceptors[i])),
+                                  [this](std::exception_ptr e)
                                   {
-                                      try
-                                      {
-                                          std::rethrow_exception(e);
-                                      }
-                                      catch (const std::exception &ex)
+                                      if (e)
                                       {
-                                          BOOST_LOG_SEV(logger_, boost::log::trivial::error)
-                                              << "Listener exception: " << ex.what();
+                                          try
+                                          {
+                                              std::rethrow_exception(e);
+                                          }
+                                          catch (const std::exception &ex)
+                                          {
+                                              BOOST_LOG_SEV(logger_, boost::log::trivial::error)
+                                                  << "Listener exception: " << ex.what();
+                                          }
                                       }
-                                  }
-                              });
-
-        // Run the I/O service on multiple threads if configured
-        std::vector<std::thread> threads;
-        threads.reserve(config_.threads() - 1);
-
-        for (int i = config_.threads() - 1; i > 0; --i)
-        {
-            threads.emplace_back([this] { ioc_.run(); });
+                                  });
         }
 
-        // Run on the main thread
-        ioc_.run();
-
-        // Wait for all threads to finish
-        for (auto &t : threads)
-        {
-            t.join();
-        }
+        // Run the worker threads; the main thread is one of them
+        io_contexts_.run();
 
         return {};
     }
@@ -111,7 +147,7 @@ auto Server::start() -> std::expected<void, ServerError>
 void Server::stop() noexcept
 {
     running_ = false;
-    ioc_.stop();
+    io_contexts_.stop();
 }
 
 void Server::setup_signal_handling() noexcept
@@ -144,10 +180,9 @@ void Server::handle_signal(const boost::system::error_code &error, int signal_nu
     }
 }
 
-auto Server::do_listen() -> boost::asio::awaitable<void>
+auto Server::make_acceptor(boost::asio::io_context &ioc, bool shared_port) const -> boost::asio::ip::tcp::acceptor
 {
-    auto executor = co_await boost::asio::this_coro::executor;
-    boost::asio::ip::tcp::acceptor acceptor(executor);
+    boost::asio::ip::tcp::acceptor acceptor(ioc);
 
     // Get the endpoint from the config
     auto const address = boost::asio::ip::make_address(config_.address());
@@ -156,9 +191,20 @@ auto Server::do_listen() -> boost::asio::awaitable<void>
     // Configure acceptor
     acceptor.open(endpoint.protocol());
     acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+    if (shared_port)
+    {
+        acceptor.set_option(ReusePort(true));
+    }
     acceptor.bind(endpoint);
     acceptor.listen(boost::asio::socket_base::max_listen_connections);
 
+    return acceptor;
+}
+
+auto Server::do_listen(boost::asio::ip::tcp::acceptor acceptor) -> boost::asio::awaitable<void>
+{
+    auto executor = co_await boost::asio::this_coro::executor;
+
     BOOST_LOG_SEV(logger_, boost::log::trivial::trace) << "Listener started, accepting connections...";
 
     // Accept connections forever;
@@ -196,6 +242,9 @@ auto Server::do_listen() -> boost::asio::awaitable<void>
 auto Server::do_session(boost::beast::tcp_stream stream) -> boost::asio::awaitable<void>
 {
     boost::beast::flat_buffer buffer;
+    std::array<std::byte, kHeaderArenaBytes> arena_storage; // NOLINT(cppcoreguidelines-pro-type-member-init)
+    std::pmr::monotonic_buffer_resource arena{arena_storage.data(), arena_storage.size()};
+    const std::pmr::polymorphic_allocator<char> alloc{&arena};
 
     BOOST_LOG_SEV(logger_, boost::log::trivial::info)
         << std::format("New connection from {}", stream.socket().remote_endpoint().address().to_string());
@@ -205,13 +254,36 @@ auto Server::do_session(boost::beast::tcp_stream stream) -> boost::asio::awaitab
     {
         try
         {
+            // Nothing of the previous request is alive anymore, so its header fields can be discarded.
+            arena.release();
+
             // Set timeout for this request;
             stream.expires_after(kRequestTimeout);
 
-            // Read the request using C++20 co_await
-            boost::beast::http::request<boost::beast::http::string_body> req;
+            // Read the request using C++20 co_await; the parser enforces the body size limit
+            boost::beast::http::request_parser<boost::beast::http::string_body, fields_t::allocator_type> parser{
+                std::piecewise_construct, std::make_tuple(), std::make_tuple(alloc)};
+            parser.body_limit(config_.max_body_bytes());
             auto [ec, bytes_read] = co_await boost::beast::http::async_read(
-                stream, buffer, req, boost::asio::as_tuple(boost::asio::use_awaitable));
+                stream, buffer, parser, boost::asio::as_tuple(boost::asio::use_awaitable));
+
+            // The rest of an oversized body is never read, so answer and close the connection.
+            if (ec == boost::beast::http::error::body_limit)
+            {
+                BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+                    << std::format("Rejecting request body larger than {} bytes", config_.max_body_bytes());
+
+                response_t response{http::status::payload_too_large, parser.get().version()};
+                response.set(http::field::server, "Swftly");
+                response.set(http::field::content_type, "application/json");
+                response.body() = json::serialize(json::object{{"error", "Request body too large"}});
+                response.keep_alive(false);
+                response.prepare_payload();
+
+                co_await boost::beast::http::async_write(stream, response,
+                                                         boost::asio::as_tuple(boost::asio::use_awaitable));
+                break;
+            }
 
             if (ec)
             {
@@ -235,31 +307,47 @@ auto Server::do_session(boost::beast::tcp_stream stream) -> boost::asio::awaitab
                 co_return;
             }
 
+            const auto req = parser.release();
+
             // Log the request
-            BOOST_LOG_SEV(logger_, boost::log::trivial::info)
-                << std::format("REQ {} {} - processing", std::string(boost::beast::http::to_string(req.method())),
-                               std::string(req.target()));
+            BOOST_LOG_SEV(logger_, boost::log::trivial::debug)
+                << "REQ " << req.method_string() << ' ' << req.target() << " - processing";
 
             // Create the response object that the handler will populate.
-            response_t response;
+            response_t response{std::piecewise_construct, std::make_tuple(), std::make_tuple(alloc)};
 
             // Dispatch to the handler. The handler is responsible for the status,
             // content-type, and body.
             co_await router_.dispatch(&req, &response);
 
-            // The server is responsible for common headers.
-            response.set(http::field::server, "Swftly");
-            response.version(req.version());
-            response.keep_alive(req.keep_alive());
-            response.prepare_payload();
-
             // Log response status
-            BOOST_LOG_SEV(logger_, boost::log::trivial::info)
-                << std::format("RESP: {}", static_cast<unsigned>(response.result()));
+            BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "RESP: " << static_cast<unsigned>(response.result());
 
-            // Send response using C++20 co_await
-            auto [write_ec, bytes_written] = co_await boost::beast::http::async_write(
-                stream, response, boost::asio::as_tuple(boost::asio::use_awaitable));
+            boost::system::error_code write_ec;
+            bool close = false;
+            if (is_plain_redirect(req, response))
+            {
+                // Redirects are constant bytes around the Location value: send them with one gather write,
+                // without the serializer.
+                const auto buffers = redirect_buffers(*response.redirect, req.keep_alive());
+                std::tie(write_ec, std::ignore) = co_await boost::asio::async_write(
+                    stream, buffers, boost::asio::as_tuple(boost::asio::use_awaitable));
+                close = !req.keep_alive();
+            }
+            else
+            {
+                // The server is responsible for common headers.
+                add_redirect_fields(&response);
+                response.set(http::field::server, "Swftly");
+                response.version(req.version());
+                response.keep_alive(req.keep_alive());
+                response.prepare_payload();
+
+                // Send response using C++20 co_await
+                std::tie(write_ec, std::ignore) = co_await boost::beast::http::async_write(
+                    stream, response, boost::asio::as_tuple(boost::asio::use_awaitable));
+                close = response.need_eof();
+            }
 
             if (write_ec)
             {
@@ -267,7 +355,7 @@ auto Server::do_session(boost::beast::tcp_stream stream) -> boost::asio::awaitab
                 break;
             }
 
-            if (response.need_eof())
+            if (close)
             {
                 // Server decided to close (Connection: close header)
                 BOOST_LOG_SEV(logger_, boost::log::trivial::info) << "Closing connection (Connection: close)";
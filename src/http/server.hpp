@@ -1,13 +1,16 @@
 #pragma once
 
 #include "conf/conf.hpp"
+#include "io_context_pool.hpp"
 #include "logging/logger_setup.hpp"
 #include "router.hpp"
 #include <boost/asio/awaitable.hpp>
 #include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/signal_set.hpp>
 #include <boost/beast/core.hpp>
 #include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <expected>
 
@@ -17,6 +20,7 @@ namespace http
 using namespace std::string_view_literals;
 
 constexpr std::chrono::seconds kRequestTimeout = std::chrono::seconds(30);
+constexpr std::size_t kHeaderArenaBytes = 4096; ///< Per-connection arena for request and response header fields.
 
 /**
  * @brief Defines the possible errors that the Server can encounter during startup.
@@ -36,6 +40,12 @@ enum class ServerError : std::uint8_t
  * connections, and orchestrating the request/response cycle using C++20 coroutines.
  * It does not contain any application-specific routing logic, which is delegated
  * to a Router instance provided during construction.
+ *
+ * Every io_context of the pool gets its own listener, and connections are
+ * served on the io_context that accepted them. With one io_context per thread
+ * (thread-per-core mode), the listeners share the port with SO_REUSEPORT and
+ * the kernel spreads incoming connections over them, so a connection stays
+ * on one thread from accept to close.
  */
 class Server
 {
@@ -45,10 +55,10 @@ class Server
      * @param config The application configuration.
      * @param logger The logger instance to use.
      * @param router The router instance for dispatching requests.
-     * @param ioc The io_context to use for async operations.
+     * @param io_contexts The io_contexts to accept and serve connections on.
      */
     explicit Server(const conf::Config &config, logging::logger_t &logger, const Router &router,
-                    boost::asio::io_context &ioc) noexcept;
+                    IoContextPool &io_contexts) noexcept;
     ~Server() = default;
 
     Server(const Server &) = delete;
@@ -80,20 +90,34 @@ class Server
         return running_;
     }
 
+    /**
+     * @brief Serves one accepted connection until it closes.
+     *
+     * The listeners spawn this for every connection they accept. The header fields of each request and
+     * its response are allocated from a kHeaderArenaBytes arena in the coroutine frame that is reset
+     * between requests, so serving a keep-alive connection does not touch the heap for headers (larger
+     * header sets spill to the heap).
+     * @param stream The accepted connection.
+     */
+    auto do_session(boost::beast::tcp_stream stream) -> boost::asio::awaitable<void>;
+
   private:
     void setup_signal_handling() noexcept;
     void handle_signal(const boost::system::error_code &error, int signal_number) noexcept;
 
+    // Opens, binds and listens on the configured endpoint (with SO_REUSEPORT if the port is shared).
+    [[nodiscard]] auto make_acceptor(boost::asio::io_context &ioc, bool shared_port) const
+        -> boost::asio::ip::tcp::acceptor;
+
     // Coroutine-based operations
-    auto do_listen() -> boost::asio::awaitable<void>;
-    auto do_session(boost::beast::tcp_stream stream) -> boost::asio::awaitable<void>;
+    auto do_listen(boost::asio::ip::tcp::acceptor acceptor) -> boost::asio::awaitable<void>;
 
     const conf::Config &config_;
     bool running_ = false;
     logging::logger_t &logger_;
     const Router &router_;
 
-    boost::asio::io_context &ioc_;
+    IoContextPool &io_contexts_;
     boost::asio::signal_set signals_;
 };
 
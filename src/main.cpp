@@ -1,11 +1,20 @@
 #include "conf/conf.hpp"
 #include "encode/encoder.hpp"
+#include "http/handlers/batch_short_code_handler.hpp"
+#include "http/handlers/click_stats_handler.hpp"
+#include "http/handlers/hot_links_handler.hpp"
 #include "http/handlers/new_short_code_handler.hpp"
+#include "http/handlers/not_found_handler.hpp"
 #include "http/handlers/ping_handler.hpp"
 #include "http/handlers/root_handler.hpp"
 #include "http/handlers/short_code_handler.hpp"
+#include "http/handlers/stats_handler.hpp"
+#include "http/io_context_pool.hpp"
+#include "http/router_benchmark.hpp"
 #include "http/server.hpp"
 #include "logging/logger_setup.hpp"
+#include "storage/codec_benchmark.hpp"
+#include "storage/layout_tool.hpp"
 #include "storage/storage_service.hpp"
 #include "version.hpp"
 #include <boost/asio/io_context.hpp>
@@ -39,6 +48,61 @@ auto main(int argc, const char *argv[]) -> int
             std::cerr << "Error: Invalid log level. Must be one of: trace, debug, info, warning, error, "
                          "fatal\n";
             return 1;
+        case conf::ConfigError::InvalidIdBlockSize:
+            std::cerr << "Error: Invalid ID block size. Must be positive\n";
+            return 1;
+        case conf::ConfigError::InvalidNegativeCacheTtl:
+            std::cerr << "Error: Invalid negative cache TTL. Must not be negative\n";
+            return 1;
+        case conf::ConfigError::InvalidBatchOptions:
+            std::cerr << "Error: Invalid lookup batching options. Batch size and delay must not be negative\n";
+            return 1;
+        case conf::ConfigError::InvalidRedisConnections:
+            std::cerr << "Error: Invalid Redis connection count. Must not be negative\n";
+            return 1;
+        case conf::ConfigError::InvalidStorageBackend:
+            std::cerr << "Error: Invalid storage backend. Must be one of: redis, log\n";
+            return 1;
+        case conf::ConfigError::InvalidLogStoreOptions:
+            std::cerr << "Error: Invalid log store options. Path must not be empty and sync interval must not be "
+                         "negative\n";
+            return 1;
+        case conf::ConfigError::InvalidRedisNodes:
+            std::cerr << "Error: Invalid Redis node list. Expected distinct, comma-separated host:port entries\n";
+            return 1;
+        case conf::ConfigError::InvalidRedisReplicas:
+            std::cerr << "Error: Invalid Redis replica list. Expected at most one comma-separated group per node, "
+                         "each a '|'-separated list of host:port entries\n";
+            return 1;
+        case conf::ConfigError::InvalidRedisLayout:
+            std::cerr << "Error: Invalid Redis layout options. Layouts must be keys or buckets (the previous one "
+                         "different from the current one), the bucket size positive, and --migrate-layout "
+                         "needs --redis-layout buckets\n";
+            return 1;
+        case conf::ConfigError::InvalidRequestLimits:
+            std::cerr << "Error: Invalid request limits. The body size and batch URL count must be positive\n";
+            return 1;
+        case conf::ConfigError::InvalidDedupOptions:
+            std::cerr << "Error: Invalid deduplication options. --dedup needs the redis storage backend and the "
+                         "dedup cache size must not be negative\n";
+            return 1;
+        case conf::ConfigError::InvalidRedisDeadlines:
+            std::cerr << "Error: Invalid Redis deadline options. Timeouts and breaker times must not be negative and "
+                         "the breaker failure rate must be between 0 and 100\n";
+            return 1;
+        case conf::ConfigError::InvalidClickFlushInterval:
+            std::cerr << "Error: Invalid click flush interval. It must not be negative\n";
+            return 1;
+        case conf::ConfigError::InvalidCacheSnapshotOptions:
+            std::cerr << "Error: Invalid cache snapshot options. The snapshot interval must be positive and the "
+                         "warm entry count must not be negative\n";
+            return 1;
+        case conf::ConfigError::InvalidHotLinks:
+            std::cerr << "Error: Invalid hot link count. It must be between 0 and " << conf::kMaxHotLinks << "\n";
+            return 1;
+        case conf::ConfigError::InvalidCpuAffinity:
+            std::cerr << "Error: Invalid CPU affinity. Expected a comma-separated list of CPUs or ranges like 0-3,8\n";
+            return 1;
         case conf::ConfigError::UnexpectedError:
             std::cerr << "Error: Unexpected configuration error\n";
             return 1;
@@ -51,39 +115,69 @@ auto main(int argc, const char *argv[]) -> int
         logging::setup(config);
         logging::logger_t logger;
 
-        // Create io_context and executor first
-        boost::asio::io_context ioc;
-        auto executor = ioc.get_executor();
+        // One-shot tools run instead of the server
+        if (!config.codec_benchmark_path().empty())
+        {
+            return storage::run_codec_benchmark(config);
+        }
 
-        // Create services that need the executor
-        storage::StorageService storage{executor, logger};
+        if (config.router_benchmark())
+        {
+            return http::run_router_benchmark();
+        }
+
+        if (config.migrate_layout() || config.layout_report_links() > 0)
+        {
+            return storage::run_layout_tool(config, logger);
+        }
+
+        // Create the io_contexts (one shared, or one per thread with --thread-per-core) and executor first
+        http::IoContextPool io_contexts{static_cast<std::size_t>(config.threads()), config.thread_per_core(),
+                                        config.cpu_affinity(), logger};
+        auto executor = io_contexts.context(0).get_executor();
+
+        // Create services that need the executor; Redis connections are spread over all io_contexts
+        storage::StorageService storage{executor, logger, config, io_contexts.executors()};
         encode::Encoder encoder{};
 
-        // Connect to Redis
+        // Start the storage backend (Redis connections run and reconnect internally)
         BOOST_LOG_SEV(logger, boost::log::trivial::trace)
-            << std::format("Starting Redis connection to {}:{}", config.redis_host(), config.redis_port());
+            << std::format("Starting {} storage backend", config.storage_backend());
 
-        // Start Redis connection (async_run handles everything internally)
-        storage.connect(config.redis_host(), std::to_string(config.redis_port()));
+        storage.start();
 
-        BOOST_LOG_SEV(logger, boost::log::trivial::trace) << "Redis connection started";
+        BOOST_LOG_SEV(logger, boost::log::trivial::trace) << "Storage backend started";
 
-        // Setup routing
-        http::Router router{http::handler::ShortCodeHandler{executor, encoder, storage}};
-        router.add_route(http::RouteKey{http::beast::http::verb::get, "/"}, http::handler::RootHandler{});
-        router.add_route(http::RouteKey{http::beast::http::verb::get, "/ping"}, http::handler::PingHandler{});
-        router.add_route(http::RouteKey{http::beast::http::verb::post, "/api/urls"},
-                         http::handler::NewShortCodeHandler{executor, encoder, storage});
+        // Setup routing; the route table is fixed at compile time
+        using http::beast::http::verb;
+        const http::StaticRouter router{
+            http::handler::NotFoundHandler{},
+            http::route<verb::get, "/">(http::handler::RootHandler{}),
+            http::route<verb::get, "/ping">(http::handler::PingHandler{}),
+            http::route<verb::post, "/api/urls">(http::handler::NewShortCodeHandler{executor, encoder, storage}),
+            http::route<verb::post, "/api/urls/batch">(http::handler::BatchShortCodeHandler{
+                encoder, storage, static_cast<std::size_t>(config.batch_max_urls())}),
+            http::route<verb::get, "/api/stats">(http::handler::StatsHandler{storage}),
+            http::route<verb::post, "/api/clicks">(http::handler::ClickStatsHandler{encoder, storage}),
+            http::route<verb::get, "/api/urls/{code}/stats">(http::handler::ClickStatsHandler{encoder, storage}),
+            http::route<verb::get, "/api/hot-links">(http::handler::HotLinksHandler{encoder, storage}),
+            http::route<verb::get, "/{code}">(http::handler::ShortCodeHandler{executor, encoder, storage})};
 
         // Log available endpoints (where routes are actually defined)
         BOOST_LOG_SEV(logger, boost::log::trivial::info) << "Available endpoints:";
         BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - GET / - Server info";
         BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - GET /ping - Health check endpoint";
         BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - POST /api/urls - Create short URL";
-        BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - GET /<short_code> - Redirect to original URL";
+        BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - POST /api/urls/batch - Create short URLs in bulk";
+        BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - GET /api/stats - Runtime statistics";
+        BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - POST /api/clicks - Click counts of short codes";
+        BOOST_LOG_SEV(logger, boost::log::trivial::info)
+            << "   - GET /api/urls/{code}/stats - Click count of a short code";
+        BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - GET /api/hot-links - Most requested short codes";
+        BOOST_LOG_SEV(logger, boost::log::trivial::info) << "   - GET /{code} - Redirect to original URL";
 
         // Create server with io_context
-        http::Server server{config, logger, router, ioc};
+        http::Server server{config, logger, router, io_contexts};
         BOOST_LOG_SEV(logger, boost::log::trivial::info)
             << std::format("Starting Swftly v{} ({})", swftly::VERSION, swftly::GIT_HASH);
         if (auto result = server.start(); !result)
@@ -0,0 +1,182 @@
+#pragma once
+
+#include "click_counter.hpp"
+#include "connection_pool.hpp"
+#include "get_batcher.hpp"
+#include "invalidation_tracker.hpp"
+#include <boost/asio/awaitable.hpp>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Counters of one storage shard (a Redis node and its replicas).
+ */
+struct ShardStats
+{
+    std::string node;                          ///< Node address (host:port).
+    std::uint64_t lookups{0};                  ///< Lookups routed to this shard.
+    std::uint64_t migrated{0};                 ///< Keys copied here from their owner before a rebalance.
+    std::vector<std::string> replicas;         ///< Read replica addresses (host:port).
+    std::uint64_t replica_reads{0};            ///< Lookups served through a replica.
+    std::uint64_t primary_fallbacks{0};        ///< Replica misses confirmed on the primary.
+    std::uint64_t hedged_reads{0};             ///< Lookups that sent a second, hedging request.
+    std::vector<ConnectionStats> connections;  ///< Counters of the shard's pooled connections.
+    std::vector<CircuitBreakerStats> breakers; ///< Circuit breakers of the primary, then of each replica.
+};
+
+/**
+ * @brief Outcome of a deduplicated create.
+ */
+struct CreatedUrl
+{
+    std::uint64_t id{0}; ///< ID of the link.
+    bool created{false}; ///< False if the link already stored for the same URL was returned.
+};
+
+/**
+ * @brief Durable id→URL store behind StorageService.
+ *
+ * A backend only persists mappings and issues IDs; caching, negative lookups
+ * and request coalescing are layered on top by StorageService and work the
+ * same for every backend. All methods may be called concurrently from any io
+ * thread and throw on errors.
+ */
+class Backend
+{
+  public:
+    Backend() = default;
+    Backend(const Backend &) = delete;
+    Backend(Backend &&) = delete;
+    auto operator=(const Backend &) -> Backend & = delete;
+    auto operator=(Backend &&) -> Backend & = delete;
+    virtual ~Backend() = default;
+
+    /// @brief Gets the backend name reported in statistics ("redis", "log").
+    [[nodiscard]] virtual auto name() const noexcept -> std::string_view = 0;
+
+    /// @brief Connects or opens the store; called once before any other operation.
+    virtual void start() = 0;
+
+    /**
+     * @brief Reserves `count` consecutive IDs.
+     * @return The first ID of the reserved range [first, first + count)
+     */
+    [[nodiscard]] virtual auto reserve_ids(std::uint64_t count) -> boost::asio::awaitable<std::uint64_t> = 0;
+
+    /// @brief Returns the highest ID issued so far (0 if none).
+    [[nodiscard]] virtual auto high_water() -> boost::asio::awaitable<std::uint64_t> = 0;
+
+    /// @brief Stores `url` under `id`, replacing any previous mapping.
+    [[nodiscard]] virtual auto store_url(std::uint64_t id, std::string_view url) -> boost::asio::awaitable<void> = 0;
+
+    /**
+     * @brief Stores `urls[i]` under `first + i` for every i, replacing any previous mappings.
+     *
+     * The default implementation stores the links one by one; backends override
+     * it to batch the writes.
+     */
+    [[nodiscard]] virtual auto store_urls(std::uint64_t first, std::span<const std::string> urls)
+        -> boost::asio::awaitable<void>
+    {
+        for (std::size_t i = 0; i < urls.size(); ++i)
+        {
+            co_await store_url(first + i, urls[i]);
+        }
+    }
+
+    /**
+     * @brief Issues an ID and stores `url` under it as one atomic operation.
+     * @return The ID the URL was stored under
+     */
+    [[nodiscard]] virtual auto create_url(std::string_view url) -> boost::asio::awaitable<std::uint64_t> = 0;
+
+    /**
+     * @brief Returns the link recorded for `digest`, or creates one for `url` and records it.
+     *
+     * Backends with a reverse index check and insert atomically, so concurrent
+     * creates of one URL yield one link. The default implementation does not
+     * deduplicate and always creates.
+     *
+     * @param digest Hex digest of the normalized URL.
+     * @param url The value to store.
+     */
+    [[nodiscard]] virtual auto find_or_create_url(std::string_view /*digest*/, std::string_view url)
+        -> boost::asio::awaitable<CreatedUrl>
+    {
+        co_return CreatedUrl{.id = co_await create_url(url), .created = true};
+    }
+
+    /**
+     * @brief Delivers invalidations of links written by any client to `handler`, from start() on.
+     *
+     * Must be called before start(). The default implementation never
+     * invalidates, for backends whose links only change through this process.
+     */
+    virtual void track_invalidations(InvalidationHandler /*handler*/)
+    {
+    }
+
+    /// @brief Returns the URL stored under `id`, or nullopt if there is none.
+    [[nodiscard]] virtual auto get_url(std::uint64_t id) -> boost::asio::awaitable<std::optional<std::string>> = 0;
+
+    /**
+     * @brief Returns the URLs stored under `ids`, in order (nullopt where there is none).
+     *
+     * Used to warm caches in bulk. The default implementation reads the links
+     * one by one; backends override it to batch the reads.
+     */
+    [[nodiscard]] virtual auto get_urls(std::span<const std::uint64_t> ids)
+        -> boost::asio::awaitable<std::vector<std::optional<std::string>>>
+    {
+        std::vector<std::optional<std::string>> urls;
+        urls.reserve(ids.size());
+        for (const auto id : ids)
+        {
+            urls.push_back(co_await get_url(id));
+        }
+        co_return urls;
+    }
+
+    /// @brief Returns true if a URL is stored under `id`.
+    [[nodiscard]] virtual auto exists(std::uint64_t id) -> boost::asio::awaitable<bool> = 0;
+
+    /**
+     * @brief Adds click counts to the links' stored totals.
+     * @throws PartialWriteError If storage acknowledged some of the deltas before failing.
+     */
+    [[nodiscard]] virtual auto add_clicks(std::span<const ClickDelta> deltas) -> boost::asio::awaitable<void> = 0;
+
+    /// @brief Returns the stored click totals of `ids`, in order (zero for links never clicked).
+    [[nodiscard]] virtual auto get_clicks(std::span<const std::uint64_t> ids)
+        -> boost::asio::awaitable<std::vector<std::uint64_t>> = 0;
+
+    /// @brief Returns true if the store is reachable and healthy.
+    [[nodiscard]] virtual auto ping() -> boost::asio::awaitable<bool> = 0;
+
+    /// @brief Returns per-shard counters (empty for backends without shards).
+    [[nodiscard]] virtual auto shard_stats() const -> std::vector<ShardStats>
+    {
+        return {};
+    }
+
+    /// @brief Returns lookup batching counters (all zero for backends that do not batch).
+    [[nodiscard]] virtual auto batching_stats() const -> GetBatcherStats
+    {
+        return {};
+    }
+
+    /// @brief Returns invalidation tracking counters (all zero if tracking is off).
+    [[nodiscard]] virtual auto invalidation_stats() const -> InvalidationStats
+    {
+        return {};
+    }
+};
+
+} // namespace storage
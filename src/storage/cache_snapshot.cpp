@@ -0,0 +1,300 @@
+#include "cache_snapshot.hpp"
+#include <boost/crc.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <cstring>
+#include <exception>
+#include <fcntl.h>
+#include <format>
+#include <ranges>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace storage
+{
+
+namespace
+{
+
+constexpr std::uint64_t kSnapshotMagic = 0x31504e5354465753; // "SWFTSNP1"
+constexpr std::uint32_t kSnapshotVersion = 1;
+
+/// @brief Header at the start of a snapshot file.
+struct SnapshotHeader
+{
+    std::uint64_t magic;
+    std::uint32_t version;
+    std::uint32_t checksum; // CRC-32 of all records
+    std::uint64_t count;
+};
+static_assert(sizeof(SnapshotHeader) == 24);
+
+constexpr std::size_t kRecordPrefixBytes = sizeof(std::uint64_t) + sizeof(std::uint32_t);
+
+[[noreturn]] void throw_errno(std::string_view what)
+{
+    throw std::system_error(errno, std::generic_category(), std::string{what});
+}
+
+// Closes a file descriptor on scope exit.
+struct FileCloser
+{
+    int fd;
+
+    explicit FileCloser(int fd) : fd{fd}
+    {
+    }
+    FileCloser(const FileCloser &) = delete;
+    auto operator=(const FileCloser &) -> FileCloser & = delete;
+    ~FileCloser()
+    {
+        if (fd >= 0)
+        {
+            ::close(fd);
+        }
+    }
+};
+
+// Unmaps a read-only file mapping on scope exit.
+struct Mapping
+{
+    const char *data;
+    std::size_t size;
+
+    Mapping(const char *data, std::size_t size) : data{data}, size{size}
+    {
+    }
+    Mapping(const Mapping &) = delete;
+    auto operator=(const Mapping &) -> Mapping & = delete;
+    ~Mapping()
+    {
+        ::munmap(const_cast<char *>(data), size);
+    }
+};
+
+void write_all(int fd, const char *data, std::size_t size)
+{
+    while (size > 0)
+    {
+        const auto n = ::write(fd, data, size);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            throw_errno("Cache snapshot write failed");
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+    }
+}
+
+} // namespace
+
+void save_cache_snapshot(const std::filesystem::path &path, const SnapshotEntries &entries)
+{
+    std::string records;
+    for (const auto &[id, url] : entries)
+    {
+        const auto size = static_cast<std::uint32_t>(url.size());
+        records.append(reinterpret_cast<const char *>(&id), sizeof(id));
+        records.append(reinterpret_cast<const char *>(&size), sizeof(size));
+        records.append(url);
+    }
+
+    boost::crc_32_type crc;
+    crc.process_bytes(records.data(), records.size());
+    const SnapshotHeader header{
+        .magic = kSnapshotMagic,
+        .version = kSnapshotVersion,
+        .checksum = crc.checksum(),
+        .count = entries.size(),
+    };
+
+    auto temp_path = path;
+    temp_path += ".tmp";
+
+    {
+        const FileCloser file{::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644)};
+        if (file.fd < 0)
+        {
+            throw_errno("Cache snapshot open failed");
+        }
+
+        write_all(file.fd, reinterpret_cast<const char *>(&header), sizeof(header));
+        write_all(file.fd, records.data(), records.size());
+        if (::fsync(file.fd) != 0)
+        {
+            throw_errno("Cache snapshot fsync failed");
+        }
+    }
+
+    std::filesystem::rename(temp_path, path);
+}
+
+auto load_cache_snapshot(const std::filesystem::path &path) -> SnapshotEntries
+{
+    const FileCloser file{::open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (file.fd < 0)
+    {
+        if (errno == ENOENT)
+        {
+            return {};
+        }
+        throw_errno("Cache snapshot open failed");
+    }
+
+    struct stat st
+    {
+    };
+    if (::fstat(file.fd, &st) != 0)
+    {
+        throw_errno("Cache snapshot stat failed");
+    }
+
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size < sizeof(SnapshotHeader))
+    {
+        throw std::runtime_error("Cache snapshot is truncated");
+    }
+
+    void *base = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file.fd, 0);
+    if (base == MAP_FAILED)
+    {
+        throw_errno("Cache snapshot mmap failed");
+    }
+    const Mapping mapping{static_cast<const char *>(base), size};
+    const auto *const data = mapping.data;
+
+    SnapshotHeader header{};
+    std::memcpy(&header, data, sizeof(header));
+    if (header.magic != kSnapshotMagic || header.version != kSnapshotVersion)
+    {
+        throw std::runtime_error("Cache snapshot has an unknown format or version");
+    }
+
+    const std::string_view records{data + sizeof(header), size - sizeof(header)};
+    boost::crc_32_type crc;
+    crc.process_bytes(records.data(), records.size());
+    if (crc.checksum() != header.checksum)
+    {
+        throw std::runtime_error("Cache snapshot checksum mismatch");
+    }
+
+    // Every record takes at least its prefix, so a larger count is corrupt; check before reserving for it.
+    if (header.count > records.size() / kRecordPrefixBytes)
+    {
+        throw std::runtime_error("Cache snapshot is truncated");
+    }
+
+    SnapshotEntries entries;
+    entries.reserve(header.count);
+    std::size_t offset = 0;
+    for (std::uint64_t i = 0; i < header.count; ++i)
+    {
+        if (records.size() - offset < kRecordPrefixBytes)
+        {
+            throw std::runtime_error("Cache snapshot is truncated");
+        }
+
+        std::uint64_t id = 0;
+        std::uint32_t url_size = 0;
+        std::memcpy(&id, records.data() + offset, sizeof(id));
+        std::memcpy(&url_size, records.data() + offset + sizeof(id), sizeof(url_size));
+        offset += kRecordPrefixBytes;
+
+        if (records.size() - offset < url_size)
+        {
+            throw std::runtime_error("Cache snapshot is truncated");
+        }
+        entries.emplace_back(id, std::string{records.substr(offset, url_size)});
+        offset += url_size;
+    }
+
+    return entries;
+}
+
+CacheSnapshotter::CacheSnapshotter(std::filesystem::path path, std::chrono::seconds interval,
+                                   std::size_t max_entries, std::shared_ptr<UrlCache> cache,
+                                   logging::logger_t logger)
+    : path_{std::move(path)}, interval_{interval}, max_entries_{max_entries}, cache_{std::move(cache)},
+      logger_{std::move(logger)}
+{
+}
+
+CacheSnapshotter::~CacheSnapshotter()
+{
+    if (thread_.joinable())
+    {
+        thread_.request_stop();
+        thread_.join();
+    }
+}
+
+auto CacheSnapshotter::restore() -> std::size_t
+{
+    try
+    {
+        const auto entries = load_cache_snapshot(path_);
+
+        // Coldest first, so the hottest entries end up most recently used.
+        for (const auto &[id, url] : entries | std::views::reverse)
+        {
+            cache_->put(id, make_cached_url(url));
+        }
+
+        BOOST_LOG_SEV(logger_, boost::log::trivial::info)
+            << "Restored " << entries.size() << " cached URLs from " << path_.string();
+        return entries.size();
+    }
+    catch (const std::exception &e)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Ignoring cache snapshot " << path_.string() << ": " << e.what();
+        return 0;
+    }
+}
+
+auto CacheSnapshotter::start() -> void
+{
+    thread_ = std::jthread{[this](std::stop_token stop) { loop(std::move(stop)); }};
+}
+
+auto CacheSnapshotter::loop(std::stop_token stop) -> void
+{
+    while (!stop.stop_requested())
+    {
+        {
+            std::unique_lock lock{mutex_};
+            wakeup_.wait_for(lock, stop, interval_, [] { return false; });
+        }
+        save(); // the last one runs at shutdown
+    }
+}
+
+auto CacheSnapshotter::save() -> void
+{
+    try
+    {
+        SnapshotEntries entries;
+        for (const auto &[id, url] : cache_->hottest(max_entries_))
+        {
+            entries.emplace_back(id, *url);
+        }
+        save_cache_snapshot(path_, entries);
+
+        BOOST_LOG_SEV(logger_, boost::log::trivial::debug)
+            << "Saved " << entries.size() << " cached URLs to " << path_.string();
+    }
+    catch (const std::exception &e)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << "Saving the cache snapshot failed: " << e.what();
+    }
+}
+
+} // namespace storage
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "logging/logger_setup.hpp"
+#include "url_cache.hpp"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace storage
+{
+
+using SnapshotEntries = std::vector<std::pair<std::uint64_t, std::string>>;
+
+/**
+ * @brief Writes cache entries to a snapshot file, replacing it atomically.
+ *
+ * Layout (host byte order): a 24-byte header { magic "SWFTSNP1", u32 version,
+ * u32 CRC-32 of the records, u64 entry count } followed by one record
+ * { u64 id, u32 size, URL bytes } per entry, hottest first. The file is
+ * written next to `path` and renamed over it after an fsync, so readers never
+ * see a partial snapshot.
+ *
+ * @throws std::runtime_error on I/O errors
+ */
+void save_cache_snapshot(const std::filesystem::path &path, const SnapshotEntries &entries);
+
+/**
+ * @brief Reads a snapshot written by save_cache_snapshot() (memory-mapped).
+ * @return The entries, hottest first; empty if the file does not exist.
+ * @throws std::runtime_error if the file is truncated, has an unknown version or fails its checksum
+ */
+[[nodiscard]] auto load_cache_snapshot(const std::filesystem::path &path) -> SnapshotEntries;
+
+/**
+ * @brief Keeps a snapshot of the redirect cache's hot set on disk for warm restarts.
+ *
+ * restore() fills the cache from the last snapshot; it runs before the server
+ * accepts connections, so a restarted node serves its working set from
+ * memory right away instead of sending every redirect to storage. A
+ * background thread then rewrites the snapshot every `interval`, and once
+ * more when the snapshotter is destroyed at shutdown.
+ */
+class CacheSnapshotter
+{
+  public:
+    /**
+     * @brief Constructs the snapshotter.
+     * @param path Snapshot file.
+     * @param interval Time between snapshots.
+     * @param max_entries Maximum number of entries per snapshot.
+     * @param cache The cache to snapshot and restore.
+     * @param logger Logger for snapshot events.
+     */
+    CacheSnapshotter(std::filesystem::path path, std::chrono::seconds interval, std::size_t max_entries,
+                     std::shared_ptr<UrlCache> cache, logging::logger_t logger);
+
+    /// @brief Stops the background thread after writing a final snapshot.
+    ~CacheSnapshotter();
+
+    CacheSnapshotter(const CacheSnapshotter &) = delete;
+    auto operator=(const CacheSnapshotter &) -> CacheSnapshotter & = delete;
+    CacheSnapshotter(CacheSnapshotter &&) = delete;
+    auto operator=(CacheSnapshotter &&) -> CacheSnapshotter & = delete;
+
+    /**
+     * @brief Loads the last snapshot into the cache.
+     *
+     * A missing or corrupt snapshot is logged and leaves the cache empty.
+     * @return Number of entries loaded
+     */
+    auto restore() -> std::size_t;
+
+    /// @brief Starts writing snapshots periodically.
+    void start();
+
+  private:
+    void loop(std::stop_token stop);
+
+    // Writes a snapshot; failures are logged.
+    void save();
+
+    std::filesystem::path path_;
+    std::chrono::seconds interval_;
+    std::size_t max_entries_;
+    std::shared_ptr<UrlCache> cache_;
+    logging::logger_t logger_;
+
+    std::mutex mutex_;
+    std::condition_variable_any wakeup_;
+    std::jthread thread_;
+};
+
+} // namespace storage
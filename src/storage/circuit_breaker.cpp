@@ -0,0 +1,148 @@
+#include "circuit_breaker.hpp"
+#include <algorithm>
+
+namespace storage
+{
+
+namespace
+{
+template <typename Duration>
+auto to_ticks(Duration duration) noexcept -> std::int64_t
+{
+    return std::chrono::duration_cast<std::chrono::steady_clock::duration>(duration).count();
+}
+} // namespace
+
+CircuitBreaker::CircuitBreaker(CircuitBreakerOptions options)
+    : options_{options}, window_start_{ticks(std::chrono::steady_clock::now())}
+{
+}
+
+auto CircuitBreaker::allow() noexcept -> bool
+{
+    if (options_.failure_ratio <= 0 || state_.load(std::memory_order_acquire) == State::Closed)
+    {
+        return true;
+    }
+
+    const auto now = std::chrono::steady_clock::now();
+    const std::lock_guard lock{mutex_};
+    const auto state = state_.load(std::memory_order_relaxed);
+    if (state == State::Closed)
+    {
+        return true;
+    }
+
+    if (state == State::Open && ticks(now) - opened_at_.load(std::memory_order_relaxed) >= to_ticks(options_.open_time))
+    {
+        state_.store(State::HalfOpen, std::memory_order_release);
+        half_opened_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    rejected_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void CircuitBreaker::record(bool success, std::chrono::steady_clock::duration latency) noexcept
+{
+    if (options_.failure_ratio <= 0)
+    {
+        return;
+    }
+
+    const bool failed = !success || (options_.slow_call.count() > 0 && latency > options_.slow_call);
+    const auto now = std::chrono::steady_clock::now();
+
+    if (state_.load(std::memory_order_acquire) != State::Closed)
+    {
+        // Only the probe's outcome matters; calls that were in flight when it tripped are ignored.
+        const std::lock_guard lock{mutex_};
+        if (state_.load(std::memory_order_relaxed) != State::HalfOpen)
+        {
+            return;
+        }
+
+        if (failed)
+        {
+            trip(now);
+            return;
+        }
+
+        window_start_.store(ticks(now), std::memory_order_relaxed);
+        calls_.store(0, std::memory_order_relaxed);
+        failures_.store(0, std::memory_order_relaxed);
+        state_.store(State::Closed, std::memory_order_release);
+        closed_.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Start a new window once the current one is over; one caller wins the reset.
+    auto start = window_start_.load(std::memory_order_relaxed);
+    if (ticks(now) - start >= to_ticks(kWindow) &&
+        window_start_.compare_exchange_strong(start, ticks(now), std::memory_order_relaxed))
+    {
+        calls_.store(0, std::memory_order_relaxed);
+        failures_.store(0, std::memory_order_relaxed);
+    }
+
+    const auto calls = calls_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (!failed)
+    {
+        return;
+    }
+
+    const auto failures = failures_.fetch_add(1, std::memory_order_relaxed) + 1;
+    if (calls >= kMinCalls && static_cast<double>(failures) >= options_.failure_ratio * static_cast<double>(calls))
+    {
+        const std::lock_guard lock{mutex_};
+        if (state_.load(std::memory_order_relaxed) == State::Closed)
+        {
+            trip(now);
+        }
+    }
+}
+
+void CircuitBreaker::trip(std::chrono::steady_clock::time_point now) noexcept
+{
+    opened_at_.store(ticks(now), std::memory_order_relaxed);
+    state_.store(State::Open, std::memory_order_release);
+    opened_.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto CircuitBreaker::remaining_open_time() const noexcept -> std::chrono::steady_clock::duration
+{
+    if (state_.load(std::memory_order_acquire) != State::Open)
+    {
+        return std::chrono::steady_clock::duration::zero();
+    }
+
+    const auto elapsed = ticks(std::chrono::steady_clock::now()) - opened_at_.load(std::memory_order_relaxed);
+    return std::chrono::steady_clock::duration{std::max<std::int64_t>(to_ticks(options_.open_time) - elapsed, 0)};
+}
+
+auto CircuitBreaker::stats() const noexcept -> CircuitBreakerStats
+{
+    std::string_view state = "closed";
+    switch (state_.load(std::memory_order_relaxed))
+    {
+    case State::Closed:
+        break;
+    case State::Open:
+        state = "open";
+        break;
+    case State::HalfOpen:
+        state = "half_open";
+        break;
+    }
+
+    return CircuitBreakerStats{
+        .state = state,
+        .opened = opened_.load(std::memory_order_relaxed),
+        .half_opened = half_opened_.load(std::memory_order_relaxed),
+        .closed = closed_.load(std::memory_order_relaxed),
+        .rejected = rejected_.load(std::memory_order_relaxed),
+    };
+}
+
+} // namespace storage
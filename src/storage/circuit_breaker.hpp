@@ -0,0 +1,123 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+namespace storage
+{
+
+/**
+ * @brief Thrown when a storage node is not answering: a command missed its
+ * deadline or the node's circuit breaker is open.
+ *
+ * HTTP handlers answer it with 503 Service Unavailable instead of 500.
+ */
+class BackendUnavailable : public std::runtime_error
+{
+  public:
+    BackendUnavailable(const std::string &what, std::chrono::seconds retry_after)
+        : std::runtime_error{what}, retry_after_{retry_after}
+    {
+    }
+
+    /// @brief Gets how long clients should wait before retrying.
+    [[nodiscard]] auto retry_after() const noexcept -> std::chrono::seconds
+    {
+        return retry_after_;
+    }
+
+  private:
+    std::chrono::seconds retry_after_;
+};
+
+/**
+ * @brief When a circuit breaker trips and how long it stays open.
+ */
+struct CircuitBreakerOptions
+{
+    double failure_ratio{0};                ///< Failed fraction of a window's calls that trips it (0 disables it).
+    std::chrono::milliseconds slow_call{0}; ///< Calls slower than this count as failed (0: latency is ignored).
+    std::chrono::milliseconds open_time{0}; ///< Time calls fail fast before a single probe call is let through.
+};
+
+/**
+ * @brief State-change and rejection counters of a circuit breaker.
+ */
+struct CircuitBreakerStats
+{
+    std::string_view state{"closed"}; ///< "closed", "open" or "half_open".
+    std::uint64_t opened{0};          ///< Times it tripped (including failed probes).
+    std::uint64_t half_opened{0};     ///< Probe calls let through while open.
+    std::uint64_t closed{0};          ///< Times a successful probe closed it again.
+    std::uint64_t rejected{0};        ///< Calls failed fast while open.
+};
+
+/**
+ * @brief Fails calls to a struggling node fast instead of letting them queue up.
+ *
+ * Closed, it counts calls and failures (errors, timeouts and, optionally,
+ * slow calls) in fixed windows of kWindow; once a window has seen at least
+ * kMinCalls calls and the failed fraction reaches the configured ratio, it
+ * opens. Open, allow() rejects every call until the open time has passed,
+ * then lets exactly one probe call through (half-open): its success closes
+ * the breaker, its failure opens it again.
+ *
+ * The closed path is lock-free; state changes take a mutex.
+ */
+class CircuitBreaker
+{
+  public:
+    explicit CircuitBreaker(CircuitBreakerOptions options);
+
+    /// @brief Returns true if the call may proceed; false (and counts a rejection) if it must fail fast.
+    [[nodiscard]] auto allow() noexcept -> bool;
+
+    /// @brief Records the outcome of a call that allow() let through.
+    void record(bool success, std::chrono::steady_clock::duration latency) noexcept;
+
+    /// @brief Gets the time left until the breaker lets a probe through (zero unless open).
+    [[nodiscard]] auto remaining_open_time() const noexcept -> std::chrono::steady_clock::duration;
+
+    /// @brief Returns the current state and counters.
+    [[nodiscard]] auto stats() const noexcept -> CircuitBreakerStats;
+
+  private:
+    enum class State : std::uint8_t
+    {
+        Closed,
+        Open,
+        HalfOpen,
+    };
+
+    static constexpr std::chrono::seconds kWindow{10};
+    static constexpr std::uint64_t kMinCalls = 20;
+
+    // Opens the breaker; the caller holds mutex_.
+    void trip(std::chrono::steady_clock::time_point now) noexcept;
+
+    [[nodiscard]] static auto ticks(std::chrono::steady_clock::time_point time) noexcept -> std::int64_t
+    {
+        return time.time_since_epoch().count();
+    }
+
+    CircuitBreakerOptions options_;
+
+    std::atomic<State> state_{State::Closed};
+    std::atomic<std::int64_t> window_start_;
+    std::atomic<std::uint64_t> calls_{0};
+    std::atomic<std::uint64_t> failures_{0};
+    std::atomic<std::int64_t> opened_at_{0};
+    std::mutex mutex_;
+
+    std::atomic<std::uint64_t> opened_{0};
+    std::atomic<std::uint64_t> half_opened_{0};
+    std::atomic<std::uint64_t> closed_{0};
+    std::atomic<std::uint64_t> rejected_{0};
+};
+
+} // namespace storage
@@ -0,0 +1,230 @@
+#include "click_counter.hpp"
+#include "util/thread_slot.hpp"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <bit>
+#include <exception>
+#include <utility>
+
+namespace storage
+{
+
+ClickCounter::ClickCounter(boost::asio::any_io_executor executor, flush_fn_t flush, std::chrono::milliseconds interval,
+                           std::size_t shards, logging::logger_t logger)
+    : executor_{std::move(executor)}, flush_{std::move(flush)}, interval_{interval}, logger_{std::move(logger)}
+{
+    shards_.reserve(shards == 0 ? 1 : shards);
+    for (std::size_t i = 0; i < shards_.capacity(); ++i)
+    {
+        shards_.push_back(std::make_unique<Shard>());
+    }
+}
+
+auto ClickCounter::start() -> void
+{
+    boost::asio::co_spawn(executor_, run(shared_from_this()), boost::asio::detached);
+}
+
+auto ClickCounter::record(std::uint64_t id) -> void
+{
+    auto &shard = *shards_[util::thread_slot() % shards_.size()];
+    {
+        const std::lock_guard lock{shard.mutex};
+        add(shard, id, 1);
+    }
+    recorded_.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto ClickCounter::pending(std::span<const std::uint64_t> ids) const -> std::vector<std::uint64_t>
+{
+    std::vector<std::uint64_t> counts(ids.size(), 0);
+    for (const auto &shard : shards_)
+    {
+        const std::lock_guard lock{shard->mutex};
+        for (std::size_t i = 0; i < ids.size(); ++i)
+        {
+            counts[i] += count(*shard, ids[i]);
+        }
+    }
+    return counts;
+}
+
+auto ClickCounter::stats() const noexcept -> ClickStats
+{
+    return ClickStats{
+        .recorded = recorded_.load(std::memory_order_relaxed),
+        .flushed = flushed_.load(std::memory_order_relaxed),
+        .flushes = flushes_.load(std::memory_order_relaxed),
+        .flush_errors = flush_errors_.load(std::memory_order_relaxed),
+    };
+}
+
+auto ClickCounter::run(std::shared_ptr<ClickCounter> self) -> boost::asio::awaitable<void>
+{
+    boost::asio::steady_timer timer{self->executor_};
+    for (;;)
+    {
+        timer.expires_after(self->interval_);
+        co_await timer.async_wait(boost::asio::use_awaitable);
+
+        auto batch = self->take();
+        if (batch.empty())
+        {
+            continue;
+        }
+
+        std::uint64_t clicks = 0;
+        for (const auto &delta : batch)
+        {
+            clicks += delta.clicks;
+        }
+
+        try
+        {
+            co_await self->flush_(batch);
+            self->flushes_.fetch_add(1, std::memory_order_relaxed);
+            self->flushed_.fetch_add(clicks, std::memory_order_relaxed);
+        }
+        catch (const PartialWriteError &e)
+        {
+            // The acknowledged deltas are in the stored totals already; restoring them would count them twice.
+            std::vector<ClickDelta> unwritten;
+            unwritten.reserve(e.unacknowledged().size());
+            for (const auto position : e.unacknowledged())
+            {
+                unwritten.push_back(batch.at(position));
+            }
+            self->fail(clicks, unwritten, e);
+        }
+        catch (const std::exception &e)
+        {
+            self->fail(clicks, batch, e);
+        }
+    }
+}
+
+auto ClickCounter::fail(std::uint64_t clicks, const std::vector<ClickDelta> &unwritten, const std::exception &error)
+    -> void
+{
+    std::uint64_t unwritten_clicks = 0;
+    for (const auto &delta : unwritten)
+    {
+        unwritten_clicks += delta.clicks;
+    }
+
+    flush_errors_.fetch_add(1, std::memory_order_relaxed);
+    flushed_.fetch_add(clicks - unwritten_clicks, std::memory_order_relaxed);
+    BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+        << "Flushing " << unwritten_clicks << " of " << clicks
+        << " clicks failed, retrying with the next batch: " << error.what();
+    restore(unwritten);
+}
+
+auto ClickCounter::take() -> std::vector<ClickDelta>
+{
+    std::unordered_map<std::uint64_t, std::uint64_t> merged;
+    std::vector<ClickDelta> taken;
+    taken.reserve(kMaxUsedSlots);
+    for (const auto &shard : shards_)
+    {
+        std::unordered_map<std::uint64_t, std::uint64_t> overflow;
+        {
+            const std::lock_guard lock{shard->mutex};
+            for (auto &slot : shard->slots)
+            {
+                if (slot.clicks != 0)
+                {
+                    taken.push_back(slot);
+                    slot = ClickDelta{};
+                }
+            }
+            shard->used = 0;
+            overflow.swap(shard->overflow);
+        }
+
+        for (const auto &delta : taken)
+        {
+            merged[delta.id] += delta.clicks;
+        }
+        for (const auto &[id, clicks] : overflow)
+        {
+            merged[id] += clicks;
+        }
+        taken.clear();
+    }
+
+    std::vector<ClickDelta> batch;
+    batch.reserve(merged.size());
+    for (const auto &[id, clicks] : merged)
+    {
+        batch.push_back(ClickDelta{.id = id, .clicks = clicks});
+    }
+    return batch;
+}
+
+auto ClickCounter::restore(const std::vector<ClickDelta> &batch) -> void
+{
+    auto &shard = *shards_.front();
+    const std::lock_guard lock{shard.mutex};
+    for (const auto &delta : batch)
+    {
+        add(shard, delta.id, delta.clicks);
+    }
+}
+
+auto ClickCounter::add(Shard &shard, std::uint64_t id, std::uint64_t clicks) -> void
+{
+    // The load limit leaves free slots, so every probe ends.
+    for (auto slot = home_slot(id);; slot = (slot + 1) & (kShardSlots - 1))
+    {
+        auto &entry = shard.slots[slot];
+        if (entry.clicks == 0)
+        {
+            if (shard.used == kMaxUsedSlots)
+            {
+                break;
+            }
+            entry = ClickDelta{.id = id, .clicks = clicks};
+            ++shard.used;
+            return;
+        }
+        if (entry.id == id)
+        {
+            entry.clicks += clicks;
+            return;
+        }
+    }
+    shard.overflow[id] += clicks;
+}
+
+auto ClickCounter::count(const Shard &shard, std::uint64_t id) -> std::uint64_t
+{
+    for (auto slot = home_slot(id);; slot = (slot + 1) & (kShardSlots - 1))
+    {
+        const auto &entry = shard.slots[slot];
+        if (entry.clicks == 0)
+        {
+            break;
+        }
+        if (entry.id == id)
+        {
+            return entry.clicks;
+        }
+    }
+    const auto it = shard.overflow.find(id);
+    return it == shard.overflow.end() ? 0 : it->second;
+}
+
+auto ClickCounter::home_slot(std::uint64_t id) noexcept -> std::size_t
+{
+    // Fibonacci hashing spreads sequential IDs (the common case) over the table.
+    constexpr std::uint64_t kMultiplier = 0x9E3779B97F4A7C15ULL;
+    constexpr auto kShift = 64 - std::bit_width(kShardSlots - 1);
+    return static_cast<std::size_t>((id * kMultiplier) >> kShift);
+}
+
+} // namespace storage
@@ -0,0 +1,159 @@
+#pragma once
+
+#include "logging/logger_setup.hpp"
+#include <array>
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Clicks counted for one link since the last flush.
+ */
+struct ClickDelta
+{
+    std::uint64_t id;     ///< Link ID.
+    std::uint64_t clicks; ///< Clicks to add to its total.
+};
+
+/**
+ * @brief Thrown by a batch write that failed after storage acknowledged part of the batch.
+ *
+ * Storage writes a batch in several requests; when one fails, the commands of
+ * the requests answered before it have been applied and must not be repeated
+ * (adding click deltas twice counts the clicks twice).
+ */
+class PartialWriteError : public std::runtime_error
+{
+  public:
+    PartialWriteError(const std::string &what, std::vector<std::size_t> unacknowledged)
+        : std::runtime_error{what}, unacknowledged_{std::move(unacknowledged)}
+    {
+    }
+
+    /// @brief Gets the positions in the batch of the entries that may not have been written.
+    [[nodiscard]] auto unacknowledged() const noexcept -> const std::vector<std::size_t> &
+    {
+        return unacknowledged_;
+    }
+
+  private:
+    std::vector<std::size_t> unacknowledged_;
+};
+
+/**
+ * @brief Counters of click counting.
+ */
+struct ClickStats
+{
+    std::uint64_t recorded{0};     ///< Clicks recorded in this process.
+    std::uint64_t flushed{0};      ///< Clicks written to storage.
+    std::uint64_t flushes{0};      ///< Flush batches written.
+    std::uint64_t flush_errors{0}; ///< Flush batches that failed (their unwritten clicks are kept for the next one).
+};
+
+/**
+ * @brief Counts redirects per link in memory and writes them to storage in batches.
+ *
+ * Clicks go into per-thread shards (`thread_slot() % shards`), each on its
+ * own cache line with its own lock. A shard counts in a fixed table of
+ * kShardSlots entries with open addressing, so recording a click costs one
+ * uncontended lock and a short probe and never allocates; only links past
+ * the table's load limit within one interval spill into a hash map. A
+ * background coroutine empties every shard every flush interval and hands
+ * the deltas to the flush function as one batch; the deltas of a failed batch that storage did not
+ * acknowledge (all of them, unless the flush throws PartialWriteError) are
+ * merged back and retried with the next one. Totals in storage therefore lag by about one interval, and
+ * clicks recorded since the last flush are lost if the process dies.
+ */
+class ClickCounter : public std::enable_shared_from_this<ClickCounter>
+{
+  public:
+    /// @brief Adds a batch of deltas to the stored totals (the batch outlives the returned awaitable).
+    using flush_fn_t = std::function<boost::asio::awaitable<void>(std::span<const ClickDelta>)>;
+
+    /**
+     * @brief Constructs the counter.
+     * @param executor Executor the flush coroutine runs on.
+     * @param flush Function writing a batch of deltas to storage.
+     * @param interval Time between flushes.
+     * @param shards Number of shards (typically the number of io threads).
+     * @param logger Logger for flush failures.
+     */
+    ClickCounter(boost::asio::any_io_executor executor, flush_fn_t flush, std::chrono::milliseconds interval,
+                 std::size_t shards, logging::logger_t logger);
+
+    /// @brief Starts flushing periodically (until the executor's context stops).
+    void start();
+
+    /// @brief Counts one click on `id`.
+    void record(std::uint64_t id);
+
+    /// @brief Returns the clicks on each of `ids` recorded but not flushed yet.
+    [[nodiscard]] auto pending(std::span<const std::uint64_t> ids) const -> std::vector<std::uint64_t>;
+
+    /// @brief Returns the counters.
+    [[nodiscard]] auto stats() const noexcept -> ClickStats;
+
+  private:
+    static constexpr std::size_t kCacheLineSize = 64;
+    static constexpr std::size_t kShardSlots = 4096;               // power of two
+    static constexpr std::size_t kMaxUsedSlots = kShardSlots / 4 * 3; // load limit, keeps probes short
+
+    struct alignas(kCacheLineSize) Shard
+    {
+        mutable std::mutex mutex;
+        std::array<ClickDelta, kShardSlots> slots{};               // Open addressing; clicks == 0 marks a free slot
+        std::size_t used{0};                                       // Slots taken since the last flush
+        std::unordered_map<std::uint64_t, std::uint64_t> overflow; // Links counted while the table was full
+    };
+
+    // Adds `clicks` to the delta of `id` in `shard` (whose lock is held).
+    static void add(Shard &shard, std::uint64_t id, std::uint64_t clicks);
+
+    // Gets the delta of `id` in `shard` (whose lock is held).
+    [[nodiscard]] static auto count(const Shard &shard, std::uint64_t id) -> std::uint64_t;
+
+    // Gets the first slot probed for `id`.
+    [[nodiscard]] static auto home_slot(std::uint64_t id) noexcept -> std::size_t;
+
+    // Flush coroutine; keeps the counter alive and never throws.
+    static auto run(std::shared_ptr<ClickCounter> self) -> boost::asio::awaitable<void>;
+
+    // Takes every shard's deltas, merged into one batch.
+    [[nodiscard]] auto take() -> std::vector<ClickDelta>;
+
+    // Counts a failed flush of `clicks` clicks and puts its unwritten deltas back.
+    void fail(std::uint64_t clicks, const std::vector<ClickDelta> &unwritten, const std::exception &error);
+
+    // Puts the deltas of a failed batch back.
+    void restore(const std::vector<ClickDelta> &batch);
+
+    boost::asio::any_io_executor executor_;
+    flush_fn_t flush_;
+    std::chrono::milliseconds interval_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    mutable logging::logger_t logger_;
+
+    std::atomic<std::uint64_t> recorded_{0};
+    std::atomic<std::uint64_t> flushed_{0};
+    std::atomic<std::uint64_t> flushes_{0};
+    std::atomic<std::uint64_t> flush_errors_{0};
+};
+
+} // namespace storage
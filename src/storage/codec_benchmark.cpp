@@ -0,0 +1,109 @@
+#include "codec_benchmark.hpp"
+#include "url_codec.hpp"
+#include <chrono>
+#include <cstddef>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace storage
+{
+
+namespace
+{
+constexpr std::chrono::milliseconds kMinRunTime{200};
+
+// Runs `pass` over the whole sample until kMinRunTime has elapsed; returns nanoseconds per item.
+template <typename Pass>
+auto time_per_item(std::size_t items, Pass pass) -> double
+{
+    std::size_t rounds = 0;
+    const auto started = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::duration{};
+    do
+    {
+        pass();
+        ++rounds;
+        elapsed = std::chrono::steady_clock::now() - started;
+    } while (elapsed < kMinRunTime);
+
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+    return static_cast<double>(nanos) / static_cast<double>(rounds * items);
+}
+} // namespace
+
+auto run_codec_benchmark(const conf::Config &config) -> int
+{
+    std::ifstream input{std::string{config.codec_benchmark_path()}};
+    if (!input)
+    {
+        std::cerr << std::format("Error: Cannot open {}\n", config.codec_benchmark_path());
+        return 1;
+    }
+
+    std::vector<std::string> urls;
+    for (std::string line; std::getline(input, line);)
+    {
+        if (!line.empty())
+        {
+            urls.push_back(std::move(line));
+        }
+    }
+    if (urls.empty())
+    {
+        std::cerr << std::format("Error: No URLs in {}\n", config.codec_benchmark_path());
+        return 1;
+    }
+
+    const UrlCodec codec{true};
+    std::vector<std::string> encoded;
+    encoded.reserve(urls.size());
+    std::size_t raw_bytes = 0;
+    std::size_t encoded_bytes = 0;
+    for (const auto &url : urls)
+    {
+        encoded.push_back(codec.encode(url));
+        raw_bytes += url.size();
+        encoded_bytes += encoded.back().size();
+
+        if (codec.decode(encoded.back()) != url)
+        {
+            std::cerr << std::format("Error: Round trip failed for {}\n", url);
+            return 1;
+        }
+    }
+
+    // Sum the output sizes so the compiler cannot drop the work.
+    std::size_t sink = 0;
+    const auto encode_ns = time_per_item(urls.size(),
+                                         [&]
+                                         {
+                                             for (const auto &url : urls)
+                                             {
+                                                 sink += codec.encode(url).size();
+                                             }
+                                         });
+    const auto decode_ns = time_per_item(encoded.size(),
+                                         [&]
+                                         {
+                                             for (const auto &value : encoded)
+                                             {
+                                                 sink += codec.decode(value).size();
+                                             }
+                                         });
+
+    const auto count = static_cast<double>(urls.size());
+    std::cout << std::format("URLs:              {}\n", urls.size());
+    std::cout << std::format("Dictionary:        v{}\n", UrlCodec::current_version());
+    std::cout << std::format("Avg raw bytes:     {:.1f}\n", static_cast<double>(raw_bytes) / count);
+    std::cout << std::format("Avg stored bytes:  {:.1f}\n", static_cast<double>(encoded_bytes) / count);
+    std::cout << std::format("Compression ratio: {:.2f}x\n",
+                             static_cast<double>(raw_bytes) / static_cast<double>(encoded_bytes));
+    std::cout << std::format("Encode:            {:.0f} ns/URL\n", encode_ns);
+    std::cout << std::format("Decode:            {:.0f} ns/URL\n", decode_ns);
+    return sink > 0 ? 0 : 1;
+}
+
+} // namespace storage
@@ -0,0 +1,19 @@
+#pragma once
+
+#include "conf/conf.hpp"
+
+namespace storage
+{
+
+/**
+ * @brief Measures UrlCodec on a file of sample URLs (--codec-benchmark).
+ *
+ * Reads one URL per line, then prints the compression ratio and the average
+ * encode and decode time per URL. Decode time is what every redirect served
+ * from storage pays (cached redirects are stored decoded).
+ *
+ * @return The process exit code.
+ */
+[[nodiscard]] auto run_codec_benchmark(const conf::Config &config) -> int;
+
+} // namespace storage
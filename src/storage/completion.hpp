@@ -0,0 +1,26 @@
+#pragma once
+
+#include <boost/asio/any_completion_handler.hpp>
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/post.hpp>
+#include <utility>
+
+namespace storage
+{
+
+/**
+ * @brief Completes a stored handler on its own associated executor.
+ *
+ * Used by components that park coroutines and later resume them from
+ * whichever thread produced the result: posting keeps each waiter on the
+ * executor it suspended on instead of running it inline on the producer.
+ */
+template <typename... Args>
+void post_completion(boost::asio::any_completion_handler<void(Args...)> handler, Args... args)
+{
+    auto executor = boost::asio::get_associated_executor(handler);
+    boost::asio::post(executor, [handler = std::move(handler), ... args = std::move(args)]() mutable
+                      { std::move(handler)(std::move(args)...); });
+}
+
+} // namespace storage
@@ -0,0 +1,105 @@
+#include "connection_pool.hpp"
+#include <algorithm>
+#include <boost/asio/consign.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/redis/logger.hpp>
+#include <chrono>
+#include <format>
+
+namespace storage
+{
+
+namespace
+{
+constexpr std::chrono::seconds kHealthCheckInterval{2};
+constexpr std::chrono::seconds kReconnectWaitInterval{1};
+constexpr std::chrono::seconds kTimeoutRetryAfter{1};
+} // namespace
+
+ConnectionPool::ConnectionPool(boost::asio::any_io_executor executor, std::size_t size, logging::logger_t logger,
+                               std::chrono::milliseconds timeout, CircuitBreakerOptions breaker)
+    : ConnectionPool(std::vector<boost::asio::any_io_executor>{std::move(executor)}, size, std::move(logger), timeout,
+                     breaker)
+{
+}
+
+ConnectionPool::ConnectionPool(const std::vector<boost::asio::any_io_executor> &executors, std::size_t size,
+                               logging::logger_t logger, std::chrono::milliseconds timeout,
+                               CircuitBreakerOptions breaker)
+    : timeout_{timeout}, breaker_{std::make_unique<CircuitBreaker>(breaker)}, logger_{std::move(logger)}
+{
+    slots_.reserve(size == 0 ? 1 : size);
+    for (std::size_t i = 0; i < slots_.capacity(); ++i)
+    {
+        // A lone executor may be run by several threads; one executor per thread needs no strand.
+        auto slot = std::make_unique<Slot>();
+        slot->conn = std::make_shared<boost::redis::connection>(
+            executors.size() > 1 ? executors[i % executors.size()]
+                                 : boost::asio::any_io_executor{boost::asio::make_strand(executors.front())});
+        slots_.push_back(std::move(slot));
+    }
+}
+
+auto ConnectionPool::connect(std::string_view host, std::string_view port) -> void
+{
+    name_ = std::format("{}:{}", host, port);
+    BOOST_LOG_SEV(logger_, boost::log::trivial::info)
+        << "Connecting " << slots_.size() << " Redis connection(s) to " << host << ":" << port;
+
+    for (std::size_t i = 0; i < slots_.size(); ++i)
+    {
+        boost::redis::config cfg;
+        cfg.addr.host = host;
+        cfg.addr.port = port;
+        cfg.health_check_id = std::format("swftly-{}", i);
+        cfg.health_check_interval = kHealthCheckInterval;
+        cfg.reconnect_wait_interval = kReconnectWaitInterval;
+        cfg.log_prefix = std::format("(Boost.Redis #{}) ", i);
+
+        // Each connection reconnects on its own; a dead socket does not affect the others.
+        const auto &conn = slots_[i]->conn;
+        conn->async_run(cfg, boost::redis::logger{boost::redis::logger::level::err},
+                        boost::asio::consign(boost::asio::detached, conn));
+    }
+}
+
+auto ConnectionPool::stats() const -> std::vector<ConnectionStats>
+{
+    std::vector<ConnectionStats> stats;
+    stats.reserve(slots_.size());
+    for (const auto &slot : slots_)
+    {
+        stats.push_back(ConnectionStats{
+            .commands = slot->commands.load(std::memory_order_relaxed),
+            .errors = slot->errors.load(std::memory_order_relaxed),
+            .timeouts = slot->timeouts.load(std::memory_order_relaxed),
+            .in_flight = slot->in_flight.load(std::memory_order_relaxed),
+        });
+    }
+    return stats;
+}
+
+auto ConnectionPool::breaker_stats() const -> CircuitBreakerStats
+{
+    return breaker_->stats();
+}
+
+void ConnectionPool::throw_circuit_open() const
+{
+    // Rounded up, so clients do not come back while it is still open.
+    const auto retry_after = std::chrono::ceil<std::chrono::seconds>(breaker_->remaining_open_time());
+    throw BackendUnavailable{std::format("Circuit breaker for Redis {} is open", name_),
+                             std::max(retry_after, std::chrono::seconds{1})};
+}
+
+void ConnectionPool::throw_timed_out() const
+{
+    BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+        << "Redis request to " << name_ << " timed out after " << timeout_.count() << " ms";
+    throw BackendUnavailable{std::format("Redis request to {} timed out", name_), kTimeoutRetryAfter};
+}
+
+} // namespace storage
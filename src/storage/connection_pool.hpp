@@ -0,0 +1,186 @@
+#pragma once
+
+#include "circuit_breaker.hpp"
+#include "logging/logger_setup.hpp"
+#include "util/thread_slot.hpp"
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/experimental/awaitable_operators.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/redis/connection.hpp>
+#include <boost/redis/request.hpp>
+#include <cstddef>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Counters of one pooled Redis connection.
+ */
+struct ConnectionStats
+{
+    std::uint64_t commands{0};  ///< Requests executed on this connection.
+    std::uint64_t errors{0};    ///< Requests that failed with an exception (including timeouts).
+    std::uint64_t timeouts{0};  ///< Requests abandoned at their deadline.
+    std::uint64_t in_flight{0}; ///< Requests currently awaiting a reply.
+};
+
+/**
+ * @brief A fixed-size pool of Redis connections with per-thread affinity.
+ *
+ * Every connection has its own async_run loop, so reconnects and health
+ * checks are handled independently per connection. Each io thread prefers
+ * connection `thread_slot() % size()`, which spreads threads evenly over the
+ * pool and keeps a thread on the same socket. Given one executor per io
+ * thread (thread-per-core mode), connection i runs on executor
+ * `i % executors.size()`, so with one connection per thread every request
+ * stays on the thread that issued it and is executed without a hop. Given a
+ * single executor, which several threads may run, every connection runs on a
+ * strand of its own.
+ *
+ * Requests may be given a deadline, after which they are cancelled and fail
+ * with BackendUnavailable, and the pool may guard its node with a
+ * CircuitBreaker, so a stalled node fails requests fast instead of letting
+ * them pile up.
+ */
+class ConnectionPool
+{
+  public:
+    /**
+     * @brief Constructs the pool.
+     * @param executor The executor connections (and their strands) are created on.
+     * @param size Number of connections (at least one).
+     * @param logger Logger for connection events.
+     * @param timeout Deadline of every request (zero: no deadline).
+     * @param breaker Circuit breaker settings (a zero failure ratio disables it).
+     */
+    ConnectionPool(boost::asio::any_io_executor executor, std::size_t size, logging::logger_t logger,
+                   std::chrono::milliseconds timeout = {}, CircuitBreakerOptions breaker = {});
+
+    /**
+     * @brief Constructs the pool with connections spread over several executors.
+     * @param executors Executors connection i is created on (`i % executors.size()`; at least one). If there are
+     *        several, each must be run by a single thread.
+     * @param size Number of connections (at least one).
+     * @param logger Logger for connection events.
+     * @param timeout Deadline of every request (zero: no deadline).
+     * @param breaker Circuit breaker settings (a zero failure ratio disables it).
+     */
+    ConnectionPool(const std::vector<boost::asio::any_io_executor> &executors, std::size_t size,
+                   logging::logger_t logger, std::chrono::milliseconds timeout = {},
+                   CircuitBreakerOptions breaker = {});
+
+    /**
+     * @brief Starts every connection's run loop (with automatic reconnects).
+     * @param host Redis server host
+     * @param port Redis server port
+     */
+    void connect(std::string_view host, std::string_view port);
+
+    /**
+     * @brief Executes a request on the calling thread's preferred connection.
+     *
+     * The request is started on the connection's executor, so the pool may be
+     * used from coroutines on any thread; from the connection's own executor,
+     * it is started directly.
+     * @throws BackendUnavailable if the request misses its deadline or the circuit breaker is open
+     * @throws std::exception on connection errors
+     */
+    template <typename Response>
+    auto exec(const boost::redis::request &req, Response &resp) const -> boost::asio::awaitable<void>
+    {
+        using namespace boost::asio::experimental::awaitable_operators;
+
+        if (!breaker_->allow())
+        {
+            throw_circuit_open();
+        }
+
+        auto &slot = *slots_[util::thread_slot() % slots_.size()];
+        slot.commands.fetch_add(1, std::memory_order_relaxed);
+        slot.in_flight.fetch_add(1, std::memory_order_relaxed);
+        const auto started = std::chrono::steady_clock::now();
+
+        try
+        {
+            // A connection must only be used from its executor: call it directly when already there, and hop to
+            // it through a spawned coroutine otherwise.
+            const auto executor = co_await boost::asio::this_coro::executor;
+            auto command = slot.conn->get_executor() == executor
+                               ? slot.conn->async_exec(req, resp, boost::asio::use_awaitable)
+                               : boost::asio::co_spawn(slot.conn->get_executor(),
+                                                       slot.conn->async_exec(req, resp, boost::asio::use_awaitable),
+                                                       boost::asio::use_awaitable);
+            if (timeout_.count() > 0)
+            {
+                // The losing operation is cancelled; a cancelled request is dropped from the connection's queue.
+                boost::asio::steady_timer deadline{executor, timeout_};
+                const auto result = co_await (std::move(command) || deadline.async_wait(boost::asio::use_awaitable));
+                if (result.index() == 1)
+                {
+                    slot.timeouts.fetch_add(1, std::memory_order_relaxed);
+                    throw_timed_out();
+                }
+            }
+            else
+            {
+                co_await std::move(command);
+            }
+        }
+        catch (...)
+        {
+            slot.errors.fetch_add(1, std::memory_order_relaxed);
+            slot.in_flight.fetch_sub(1, std::memory_order_relaxed);
+            breaker_->record(false, std::chrono::steady_clock::now() - started);
+            throw;
+        }
+
+        slot.in_flight.fetch_sub(1, std::memory_order_relaxed);
+        breaker_->record(true, std::chrono::steady_clock::now() - started);
+    }
+
+    /// @brief Gets the number of connections in the pool.
+    [[nodiscard]] auto size() const noexcept -> std::size_t
+    {
+        return slots_.size();
+    }
+
+    /// @brief Returns per-connection counters, indexed like the pool.
+    [[nodiscard]] auto stats() const -> std::vector<ConnectionStats>;
+
+    /// @brief Returns the state and counters of the pool's circuit breaker.
+    [[nodiscard]] auto breaker_stats() const -> CircuitBreakerStats;
+
+  private:
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    [[noreturn]] void throw_circuit_open() const;
+    [[noreturn]] void throw_timed_out() const;
+
+    struct alignas(kCacheLineSize) Slot
+    {
+        std::shared_ptr<boost::redis::connection> conn;
+        std::atomic<std::uint64_t> commands{0};
+        std::atomic<std::uint64_t> errors{0};
+        std::atomic<std::uint64_t> timeouts{0};
+        std::atomic<std::uint64_t> in_flight{0};
+    };
+
+    std::vector<std::unique_ptr<Slot>> slots_;
+    std::string name_;
+    std::chrono::milliseconds timeout_;
+    std::unique_ptr<CircuitBreaker> breaker_;
+    mutable logging::logger_t logger_;
+};
+
+} // namespace storage
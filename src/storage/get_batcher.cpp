@@ -0,0 +1,158 @@
+#include "get_batcher.hpp"
+#include "completion.hpp"
+#include "redis_script.hpp"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/dispatch.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/redis/request.hpp>
+#include <boost/redis/response.hpp>
+#include <stdexcept>
+#include <string_view>
+
+using namespace std::string_view_literals;
+
+namespace storage
+{
+
+namespace
+{
+// KEYS[i] = hash key, ARGV[i] = field. Missing fields come back as nil
+// (false converts to a nil reply), so the reply lines up with the keys like MGET's.
+constexpr std::string_view kHashGetScript = R"lua(
+local values = {}
+for i = 1, #KEYS do
+    values[i] = redis.call('HGET', KEYS[i], ARGV[i])
+end
+return values
+)lua";
+} // namespace
+
+GetBatcher::GetBatcher(boost::asio::any_io_executor executor, std::shared_ptr<ConnectionPool> pool,
+                       std::size_t max_keys, std::chrono::microseconds max_delay, logging::logger_t logger)
+    : strand_{boost::asio::make_strand(std::move(executor))}, timer_{strand_}, pool_{std::move(pool)},
+      max_keys_{max_keys}, max_delay_{max_delay}, logger_{std::move(logger)}
+{
+}
+
+auto GetBatcher::get(std::string key, std::string field) -> boost::asio::awaitable<std::optional<std::string>>
+{
+    co_return co_await boost::asio::async_initiate<decltype(boost::asio::use_awaitable), signature_t>(
+        [self = shared_from_this()](auto handler, std::string key, std::string field)
+        {
+            boost::asio::dispatch(
+                self->strand_,
+                [self, pending = Pending{std::move(key), std::move(field), handler_t{std::move(handler)}}]() mutable
+                { self->enqueue(std::move(pending)); });
+        },
+        boost::asio::use_awaitable, std::move(key), std::move(field));
+}
+
+auto GetBatcher::stats() const noexcept -> GetBatcherStats
+{
+    return GetBatcherStats{
+        .batches = batches_.load(std::memory_order_relaxed),
+        .keys = keys_.load(std::memory_order_relaxed),
+    };
+}
+
+void GetBatcher::enqueue(Pending pending)
+{
+    pending_.push_back(std::move(pending));
+
+    if (pending_.size() >= max_keys_)
+    {
+        flush();
+        return;
+    }
+
+    // The first lookup of a batch bounds how long the whole batch may wait.
+    if (pending_.size() == 1)
+    {
+        timer_.expires_after(max_delay_);
+        timer_.async_wait(
+            [self = shared_from_this(), generation = generation_](const boost::system::error_code &ec)
+            {
+                if (!ec && generation == self->generation_)
+                {
+                    self->flush();
+                }
+            });
+    }
+}
+
+void GetBatcher::flush()
+{
+    ++generation_;
+    timer_.cancel();
+
+    std::vector<Pending> batch;
+    batch.swap(pending_);
+    boost::asio::co_spawn(strand_, execute(shared_from_this(), std::move(batch)), boost::asio::detached);
+}
+
+auto GetBatcher::execute(std::shared_ptr<GetBatcher> self, std::vector<Pending> batch)
+    -> boost::asio::awaitable<void>
+{
+    static const RedisScript hash_get_script{kHashGetScript};
+
+    // A backend uses one key layout, so a batch holds either plain keys or hash fields only.
+    const bool hashed = !batch.front().field.empty();
+
+    std::vector<std::string_view> keys;
+    std::vector<std::string_view> fields;
+    keys.reserve(batch.size());
+    for (const auto &pending : batch)
+    {
+        keys.emplace_back(pending.key);
+        if (hashed)
+        {
+            fields.emplace_back(pending.field);
+        }
+    }
+
+    boost::redis::response<std::vector<std::optional<std::string>>> resp;
+    std::exception_ptr error;
+    try
+    {
+        if (hashed)
+        {
+            co_await hash_get_script.exec(*self->pool_, std::move(keys), std::move(fields), resp);
+        }
+        else
+        {
+            boost::redis::request req;
+            req.push_range("MGET"sv, keys);
+            co_await self->pool_->exec(req, resp);
+        }
+
+        const auto &result = std::get<0>(resp);
+        if (!result.has_value() || result.value().size() != batch.size())
+        {
+            throw std::runtime_error("Redis batched lookup returned unexpected response");
+        }
+    }
+    catch (const std::exception &e)
+    {
+        BOOST_LOG_SEV(self->logger_, boost::log::trivial::error)
+            << "Batched lookup of " << batch.size() << " keys failed: " << e.what();
+        error = std::current_exception();
+    }
+
+    self->batches_.fetch_add(1, std::memory_order_relaxed);
+    self->keys_.fetch_add(batch.size(), std::memory_order_relaxed);
+
+    for (std::size_t i = 0; i < batch.size(); ++i)
+    {
+        std::optional<std::string> value;
+        if (!error)
+        {
+            value = std::move(std::get<0>(resp).value()[i]);
+        }
+        post_completion(std::move(batch[i].handler), error, std::move(value));
+    }
+}
+
+} // namespace storage
@@ -0,0 +1,105 @@
+#pragma once
+
+#include "connection_pool.hpp"
+#include "logging/logger_setup.hpp"
+#include <atomic>
+#include <boost/asio/any_completion_handler.hpp>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Counters of a GetBatcher.
+ */
+struct GetBatcherStats
+{
+    std::uint64_t batches{0}; ///< MGET commands sent.
+    std::uint64_t keys{0};    ///< Keys fetched through those commands.
+};
+
+/**
+ * @brief Merges concurrent single-key GETs into MGET commands.
+ *
+ * Lookups of hash fields (the bucket layout, see KeyLayout) are merged the
+ * same way, into one server-side script that HGETs every pair.
+ *
+ * Lookups are queued on a strand. The first queued lookup arms a timer of
+ * `max_delay`; the queue is flushed as one MGET when the timer fires or as
+ * soon as it holds `max_keys` keys, whichever comes first. Every waiting
+ * coroutine is then resumed on its own executor with its slot of the reply.
+ *
+ * This trades up to `max_delay` of added latency for far fewer commands per
+ * second on the Redis side, which matters when Redis CPU is the bottleneck.
+ */
+class GetBatcher : public std::enable_shared_from_this<GetBatcher>
+{
+  public:
+    /**
+     * @brief Constructs the batcher.
+     * @param executor Executor the batching strand and timer run on.
+     * @param pool Redis connections MGETs are sent over.
+     * @param max_keys Maximum number of keys per MGET.
+     * @param max_delay Maximum time a lookup waits for its batch to fill.
+     * @param logger Logger for batch failures.
+     */
+    GetBatcher(boost::asio::any_io_executor executor, std::shared_ptr<ConnectionPool> pool,
+               std::size_t max_keys, std::chrono::microseconds max_delay, logging::logger_t logger);
+
+    /**
+     * @brief Fetches one key (or one hash field) as part of the next batch.
+     * @param key The Redis key to GET.
+     * @param field The hash field to HGET from `key`, or empty to GET `key` itself.
+     * @return The value, or nullopt if the key or field does not exist.
+     * @throws std::exception if the batch's command fails
+     */
+    [[nodiscard]] auto get(std::string key, std::string field = {})
+        -> boost::asio::awaitable<std::optional<std::string>>;
+
+    /// @brief Returns the batcher's counters.
+    [[nodiscard]] auto stats() const noexcept -> GetBatcherStats;
+
+  private:
+    using signature_t = void(std::exception_ptr, std::optional<std::string>);
+    using handler_t = boost::asio::any_completion_handler<signature_t>;
+
+    struct Pending
+    {
+        std::string key;
+        std::string field; // empty for plain keys
+        handler_t handler;
+    };
+
+    // The following run on the strand only.
+    void enqueue(Pending pending);
+    void flush();
+
+    // Sends one MGET (or HGET script) for the batch and completes every waiter in it.
+    static auto execute(std::shared_ptr<GetBatcher> self, std::vector<Pending> batch) -> boost::asio::awaitable<void>;
+
+    boost::asio::strand<boost::asio::any_io_executor> strand_;
+    boost::asio::steady_timer timer_;
+    std::shared_ptr<ConnectionPool> pool_;
+    std::size_t max_keys_;
+    std::chrono::microseconds max_delay_;
+    logging::logger_t logger_;
+
+    std::vector<Pending> pending_;
+    std::uint64_t generation_{0}; // bumped on every flush so stale timer expiries are ignored
+
+    std::atomic<std::uint64_t> batches_{0};
+    std::atomic<std::uint64_t> keys_{0};
+};
+
+} // namespace storage
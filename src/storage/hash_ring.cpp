@@ -0,0 +1,66 @@
+#include "hash_ring.hpp"
+#include <algorithm>
+
+namespace storage
+{
+
+namespace
+{
+constexpr std::uint64_t kFnvOffset = 0xcbf29ce484222325ULL;
+constexpr std::uint64_t kFnvPrime = 0x100000001b3ULL;
+
+// splitmix64 finalizer; turns FNV and sequential IDs into well-spread ring positions.
+constexpr auto mix(std::uint64_t x) noexcept -> std::uint64_t
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31U);
+}
+} // namespace
+
+HashRing::HashRing(const std::vector<std::string> &nodes) : node_count_{nodes.size()}
+{
+    points_.reserve(nodes.size() * kVirtualNodes);
+    for (std::size_t node = 0; node < nodes.size(); ++node)
+    {
+        for (std::size_t replica = 0; replica < kVirtualNodes; ++replica)
+        {
+            points_.emplace_back(hash_name(nodes[node], replica), node);
+        }
+    }
+    std::ranges::sort(points_);
+}
+
+auto HashRing::owner(std::uint64_t id) const noexcept -> std::size_t
+{
+    if (node_count_ <= 1)
+    {
+        return 0;
+    }
+
+    const auto hash = hash_id(id);
+    auto it = std::ranges::lower_bound(points_, hash, {}, &std::pair<std::uint64_t, std::size_t>::first);
+    if (it == points_.end())
+    {
+        it = points_.begin(); // wrap around
+    }
+    return it->second;
+}
+
+auto HashRing::hash_name(std::string_view name, std::size_t replica) noexcept -> std::uint64_t
+{
+    auto hash = kFnvOffset;
+    for (const auto c : name)
+    {
+        hash = (hash ^ static_cast<unsigned char>(c)) * kFnvPrime;
+    }
+    return mix(hash ^ replica);
+}
+
+auto HashRing::hash_id(std::uint64_t id) noexcept -> std::uint64_t
+{
+    return mix(id);
+}
+
+} // namespace storage
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Consistent-hash ring mapping IDs to nodes.
+ *
+ * Every node is placed on the ring at `kVirtualNodes` points derived from its
+ * name, and an ID belongs to the first node point at or after the ID's hash.
+ * Adding a node to a ring of N moves only about 1/(N+1) of the IDs, all of
+ * them to the new node. Hashes are computed with fixed functions (not
+ * std::hash), so every process agrees on the mapping.
+ */
+class HashRing
+{
+  public:
+    /**
+     * @brief Builds the ring.
+     * @param nodes Node names (e.g. "host:port"); node `i` is reported as owner index `i`.
+     */
+    explicit HashRing(const std::vector<std::string> &nodes);
+
+    /// @brief Returns the index of the node owning `id`.
+    [[nodiscard]] auto owner(std::uint64_t id) const noexcept -> std::size_t;
+
+    /// @brief Gets the number of nodes on the ring.
+    [[nodiscard]] auto size() const noexcept -> std::size_t
+    {
+        return node_count_;
+    }
+
+  private:
+    static constexpr std::size_t kVirtualNodes = 160;
+
+    [[nodiscard]] static auto hash_name(std::string_view name, std::size_t replica) noexcept -> std::uint64_t;
+    [[nodiscard]] static auto hash_id(std::uint64_t id) noexcept -> std::uint64_t;
+
+    std::vector<std::pair<std::uint64_t, std::size_t>> points_; // (hash, node index), sorted by hash
+    std::size_t node_count_;
+};
+
+} // namespace storage
@@ -0,0 +1,203 @@
+#include "hot_links.hpp"
+#include "util/thread_slot.hpp"
+#include <algorithm>
+#include <bit>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <unordered_map>
+#include <utility>
+
+namespace storage
+{
+
+HotLinkTracker::HotLinkTracker(boost::asio::any_io_executor executor, std::size_t top_k, std::size_t shards,
+                               merged_fn_t on_merged, logging::logger_t logger)
+    : executor_{std::move(executor)}, top_k_{top_k},
+      candidate_mask_{std::bit_ceil(std::max<std::size_t>(top_k, 1) * kCandidatesPerLink) - 1},
+      on_merged_{std::move(on_merged)}, logger_{std::move(logger)}
+{
+    const auto count = shards == 0 ? 1 : shards;
+    sketches_.reserve(count);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        auto sketch = std::make_unique<Sketch>();
+        sketch->candidates = std::make_unique<std::atomic<std::uint64_t>[]>(candidate_mask_ + 1);
+        for (std::size_t slot = 0; slot <= candidate_mask_; ++slot)
+        {
+            sketch->candidates[slot].store(kNoId, std::memory_order_relaxed);
+        }
+        sketches_.push_back(std::move(sketch));
+    }
+}
+
+auto HotLinkTracker::start() -> void
+{
+    boost::asio::co_spawn(executor_, run(shared_from_this()), boost::asio::detached);
+}
+
+auto HotLinkTracker::hash(std::uint64_t id, std::size_t row) noexcept -> std::uint64_t
+{
+    // splitmix64 finalizer with a different offset per row.
+    auto h = id + (row + 1) * 0x9e3779b97f4a7c15ULL;
+    h = (h ^ (h >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    h = (h ^ (h >> 27U)) * 0x94d049bb133111ebULL;
+    return h ^ (h >> 31U);
+}
+
+auto HotLinkTracker::estimate(const Sketch &sketch, std::uint64_t id) noexcept -> std::uint32_t
+{
+    auto hits = std::numeric_limits<std::uint32_t>::max();
+    for (std::size_t row = 0; row < kDepth; ++row)
+    {
+        const auto &counter = sketch.counters[row * kWidth + (hash(id, row) & (kWidth - 1))];
+        hits = std::min(hits, counter.load(std::memory_order_relaxed));
+    }
+    return hits;
+}
+
+auto HotLinkTracker::record(std::uint64_t id) noexcept -> void
+{
+    auto &sketch = *sketches_[util::thread_slot() % sketches_.size()];
+
+    auto hits = std::numeric_limits<std::uint32_t>::max();
+    for (std::size_t row = 0; row < kDepth; ++row)
+    {
+        auto &counter = sketch.counters[row * kWidth + (hash(id, row) & (kWidth - 1))];
+        hits = std::min(hits, counter.fetch_add(1, std::memory_order_relaxed) + 1);
+    }
+    sketch.recorded.fetch_add(1, std::memory_order_relaxed);
+
+    offer(sketch, id, hits);
+}
+
+auto HotLinkTracker::offer(Sketch &sketch, std::uint64_t id, std::uint32_t hits) noexcept -> void
+{
+    const auto h = hash(id, kDepth);
+    auto &first = sketch.candidates[h & candidate_mask_];
+    auto &second = sketch.candidates[(h >> 32U) & candidate_mask_];
+
+    const auto first_id = first.load(std::memory_order_relaxed);
+    const auto second_id = second.load(std::memory_order_relaxed);
+    if (first_id == id || second_id == id)
+    {
+        return;
+    }
+
+    const auto first_hits = first_id == kNoId ? 0 : estimate(sketch, first_id);
+    const auto second_hits = second_id == kNoId ? 0 : estimate(sketch, second_id);
+    auto &victim = first_hits <= second_hits ? first : second;
+    if (std::min(first_hits, second_hits) < hits)
+    {
+        // A racing offer may overwrite this one; the hotter link wins the slot back on its next redirect.
+        victim.store(id, std::memory_order_relaxed);
+    }
+}
+
+auto HotLinkTracker::run(std::shared_ptr<HotLinkTracker> self) -> boost::asio::awaitable<void>
+{
+    boost::asio::steady_timer timer{self->executor_};
+    for (;;)
+    {
+        timer.expires_after(kMergeInterval);
+        co_await timer.async_wait(boost::asio::use_awaitable);
+        self->merge();
+    }
+}
+
+auto HotLinkTracker::merge() -> void
+{
+    std::unordered_map<std::uint64_t, std::uint64_t> hits;
+    for (const auto &sketch : sketches_)
+    {
+        for (std::size_t slot = 0; slot <= candidate_mask_; ++slot)
+        {
+            if (const auto id = sketch->candidates[slot].load(std::memory_order_relaxed); id != kNoId)
+            {
+                hits.try_emplace(id, 0);
+            }
+        }
+    }
+
+    std::vector<HotLink> links;
+    links.reserve(hits.size());
+    for (auto &[id, total] : hits)
+    {
+        for (const auto &sketch : sketches_)
+        {
+            total += estimate(*sketch, id);
+        }
+        if (total > 0)
+        {
+            links.push_back(HotLink{.id = id, .hits = total});
+        }
+    }
+
+    const auto count = std::min(links.size(), top_k_);
+    std::partial_sort(links.begin(), links.begin() + static_cast<std::ptrdiff_t>(count), links.end(),
+                      [](const HotLink &a, const HotLink &b) { return a.hits > b.hits; });
+    links.resize(count);
+
+    {
+        const std::lock_guard lock{mutex_};
+        top_ = links;
+    }
+
+    if (merges_.fetch_add(1, std::memory_order_relaxed) % kDecayMerges == kDecayMerges - 1)
+    {
+        decay();
+    }
+
+    if (on_merged_)
+    {
+        on_merged_(links);
+    }
+
+    BOOST_LOG_SEV(logger_, boost::log::trivial::trace)
+        << "Merged hot links: " << hits.size() << " candidates, " << links.size() << " in the top list";
+}
+
+auto HotLinkTracker::decay() noexcept -> void
+{
+    for (const auto &sketch : sketches_)
+    {
+        for (auto &counter : sketch->counters)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) / 2, std::memory_order_relaxed);
+        }
+        for (std::size_t slot = 0; slot <= candidate_mask_; ++slot)
+        {
+            auto id = sketch->candidates[slot].load(std::memory_order_relaxed);
+            if (id != kNoId && estimate(*sketch, id) == 0)
+            {
+                sketch->candidates[slot].compare_exchange_strong(id, kNoId, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+auto HotLinkTracker::top() const -> std::vector<HotLink>
+{
+    const std::lock_guard lock{mutex_};
+    return top_;
+}
+
+auto HotLinkTracker::stats() const -> HotLinkStats
+{
+    HotLinkStats stats{};
+    for (const auto &sketch : sketches_)
+    {
+        stats.recorded += sketch->recorded.load(std::memory_order_relaxed);
+    }
+    stats.merges = merges_.load(std::memory_order_relaxed);
+    {
+        const std::lock_guard lock{mutex_};
+        stats.tracked = top_.size();
+    }
+    return stats;
+}
+
+} // namespace storage
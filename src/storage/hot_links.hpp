@@ -0,0 +1,130 @@
+#pragma once
+
+#include "logging/logger_setup.hpp"
+#include <array>
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief One of the most requested links.
+ */
+struct HotLink
+{
+    std::uint64_t id;   ///< Link ID.
+    std::uint64_t hits; ///< Estimated recent redirects (an upper bound; counts decay over time).
+};
+
+/**
+ * @brief Counters of heavy-hitter tracking.
+ */
+struct HotLinkStats
+{
+    std::uint64_t recorded{0}; ///< Redirects fed to the tracker.
+    std::uint64_t merges{0};   ///< Times the per-thread sketches were merged into a new top list.
+    std::uint64_t tracked{0};  ///< Links in the current top list.
+};
+
+/**
+ * @brief Finds the most requested links in the redirect stream with bounded memory.
+ *
+ * Every io thread (`thread_slot() % shards`) records redirects into its own
+ * count-min sketch of kDepth rows of kWidth relaxed atomic counters, plus a
+ * small table of candidate IDs: a link takes a candidate slot (one of two,
+ * chosen by hash) when its estimate beats the slot's current occupant. No
+ * locks are taken on the redirect path.
+ *
+ * Every kMergeInterval a background coroutine merges the sketches: each
+ * candidate's count is the sum of its per-thread estimates, and the top_k
+ * highest become the published top list. Every kDecayMerges merges all
+ * counters are halved, so links that cool down drop out of the list. Halving
+ * races with concurrent increments and may lose a few of them, which only
+ * makes an estimate slightly lower.
+ */
+class HotLinkTracker : public std::enable_shared_from_this<HotLinkTracker>
+{
+  public:
+    /// @brief Receives every newly merged top list, hottest first, on the merge coroutine.
+    using merged_fn_t = std::function<void(const std::vector<HotLink> &)>;
+
+    /**
+     * @brief Constructs the tracker.
+     * @param executor Executor the merge coroutine runs on.
+     * @param top_k Number of links in the top list.
+     * @param shards Number of per-thread sketches (typically the number of io threads).
+     * @param on_merged Called after every merge (may be empty).
+     * @param logger Logger for merge events.
+     */
+    HotLinkTracker(boost::asio::any_io_executor executor, std::size_t top_k, std::size_t shards,
+                   merged_fn_t on_merged, logging::logger_t logger);
+
+    /// @brief Starts merging periodically (until the executor's context stops).
+    void start();
+
+    /// @brief Counts one redirect to `id`.
+    void record(std::uint64_t id) noexcept;
+
+    /// @brief Returns the top list of the last merge, hottest first.
+    [[nodiscard]] auto top() const -> std::vector<HotLink>;
+
+    /// @brief Returns the counters.
+    [[nodiscard]] auto stats() const -> HotLinkStats;
+
+  private:
+    static constexpr std::size_t kDepth = 4;
+    static constexpr std::size_t kWidth = 2048; // power of two
+    static constexpr std::size_t kCandidatesPerLink = 4;
+    static constexpr std::chrono::seconds kMergeInterval{1};
+    static constexpr std::uint64_t kDecayMerges = 10;
+    static constexpr std::uint64_t kNoId = std::numeric_limits<std::uint64_t>::max();
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    struct alignas(kCacheLineSize) Sketch
+    {
+        std::array<std::atomic<std::uint32_t>, kDepth * kWidth> counters{};
+        std::unique_ptr<std::atomic<std::uint64_t>[]> candidates; // NOLINT(cppcoreguidelines-avoid-c-arrays)
+        std::atomic<std::uint64_t> recorded{0};
+    };
+
+    // Hashes `id` for sketch row `row` (row kDepth picks candidate slots).
+    [[nodiscard]] static auto hash(std::uint64_t id, std::size_t row) noexcept -> std::uint64_t;
+
+    // Gets the count-min estimate of `id` in one sketch.
+    [[nodiscard]] static auto estimate(const Sketch &sketch, std::uint64_t id) noexcept -> std::uint32_t;
+
+    // Makes `id` a candidate of `sketch` if it is hotter than the colder of its two slots' occupants.
+    void offer(Sketch &sketch, std::uint64_t id, std::uint32_t hits) noexcept;
+
+    // Merge coroutine; keeps the tracker alive.
+    static auto run(std::shared_ptr<HotLinkTracker> self) -> boost::asio::awaitable<void>;
+
+    // Merges the sketches into a new top list and publishes it.
+    void merge();
+
+    // Halves every counter and frees the candidate slots of links whose estimate reached zero.
+    void decay() noexcept;
+
+    boost::asio::any_io_executor executor_;
+    std::size_t top_k_;
+    std::size_t candidate_mask_;
+    std::vector<std::unique_ptr<Sketch>> sketches_;
+    merged_fn_t on_merged_;
+    mutable logging::logger_t logger_;
+
+    mutable std::mutex mutex_;
+    std::vector<HotLink> top_;
+    std::atomic<std::uint64_t> merges_{0};
+};
+
+} // namespace storage
@@ -0,0 +1,121 @@
+#include "id_allocator.hpp"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+
+namespace storage
+{
+
+namespace
+{
+// Start refilling once a quarter of the block is left.
+constexpr std::uint64_t kRefillDivisor = 4;
+
+std::atomic<std::uint64_t> next_instance_id{1};
+} // namespace
+
+IdAllocator::IdAllocator(boost::asio::any_io_executor executor, block_fetcher_t fetch_block,
+                         std::uint64_t block_size, logging::logger_t logger)
+    : instance_id_{next_instance_id.fetch_add(1, std::memory_order_relaxed)}, executor_{std::move(executor)},
+      fetch_block_{std::move(fetch_block)}, block_size_{block_size}, refill_threshold_{block_size / kRefillDivisor},
+      logger_{std::move(logger)}
+{
+}
+
+auto IdAllocator::next() -> boost::asio::awaitable<std::uint64_t>
+{
+    auto &lease = local_lease();
+    if (lease.next == lease.end)
+    {
+        take_spare(lease);
+    }
+
+    if (lease.next != lease.end) [[likely]]
+    {
+        const auto id = lease.next++;
+        if (lease.end - lease.next <= refill_threshold_ && !lease.refill_pending.load(std::memory_order_acquire))
+        {
+            start_refill(lease);
+        }
+        co_return id;
+    }
+
+    // Cold path: nothing leased on this thread yet, or the last refill failed.
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "No leased IDs available, fetching a block";
+
+    const auto first = co_await fetch_block_(block_size_);
+
+    // The coroutine may have resumed on a different thread, so resolve the lease again.
+    // If that lease got refilled meanwhile, the rest of this block is left unused.
+    auto &current = local_lease();
+    if (current.next == current.end)
+    {
+        current.next = first + 1;
+        current.end = first + block_size_;
+    }
+
+    co_return first;
+}
+
+auto IdAllocator::local_lease() -> Lease &
+{
+    thread_local std::uint64_t cached_instance = 0;
+    thread_local Lease *cached_lease = nullptr;
+
+    if (cached_instance == instance_id_) [[likely]]
+    {
+        return *cached_lease;
+    }
+
+    std::lock_guard lock{leases_mutex_};
+    auto &lease = leases_[std::this_thread::get_id()];
+    if (!lease)
+    {
+        lease = std::make_unique<Lease>();
+    }
+
+    cached_instance = instance_id_;
+    cached_lease = lease.get();
+    return *lease;
+}
+
+void IdAllocator::take_spare(Lease &lease) noexcept
+{
+    const auto spare_end = lease.spare_end.load(std::memory_order_acquire);
+    if (spare_end == 0)
+    {
+        return;
+    }
+
+    lease.next = lease.spare_begin.load(std::memory_order_relaxed);
+    lease.end = spare_end;
+    lease.spare_end.store(0, std::memory_order_relaxed);
+    lease.refill_pending.store(false, std::memory_order_release);
+}
+
+void IdAllocator::start_refill(Lease &lease)
+{
+    lease.refill_pending.store(true, std::memory_order_relaxed);
+    boost::asio::co_spawn(executor_, refill(shared_from_this(), &lease), boost::asio::detached);
+}
+
+auto IdAllocator::refill(std::shared_ptr<IdAllocator> self, Lease *lease) -> boost::asio::awaitable<void>
+{
+    try
+    {
+        const auto first = co_await self->fetch_block_(self->block_size_);
+        lease->spare_begin.store(first, std::memory_order_relaxed);
+        lease->spare_end.store(first + self->block_size_, std::memory_order_release);
+
+        BOOST_LOG_SEV(self->logger_, boost::log::trivial::debug)
+            << "Leased ID block [" << first << ", " << first + self->block_size_ << ")";
+    }
+    catch (const std::exception &e)
+    {
+        BOOST_LOG_SEV(self->logger_, boost::log::trivial::warning) << "Failed to lease ID block: " << e.what();
+        lease->refill_pending.store(false, std::memory_order_release);
+    }
+}
+
+} // namespace storage
@@ -0,0 +1,98 @@
+#pragma once
+
+#include "logging/logger_setup.hpp"
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace storage
+{
+
+/**
+ * @brief Hands out unique IDs from blocks leased from a shared counter.
+ *
+ * Instead of one counter round trip per created link, every thread leases a
+ * contiguous block of IDs (e.g. `INCRBY url_counter N`) and serves IDs from it
+ * without any synchronization. When a thread's block runs low, the next block
+ * is fetched in the background, so in steady state next() completes without
+ * touching the network.
+ *
+ * IDs that are leased but never handed out (e.g. on shutdown) are not reissued,
+ * so the ID space may contain gaps. Uniqueness is preserved across nodes because
+ * every block comes from the same atomic counter.
+ */
+class IdAllocator : public std::enable_shared_from_this<IdAllocator>
+{
+  public:
+    /// @brief Leases `count` consecutive IDs and returns the first one of the block.
+    using block_fetcher_t = std::function<boost::asio::awaitable<std::uint64_t>(std::uint64_t count)>;
+
+    /**
+     * @brief Constructs the allocator.
+     * @param executor Executor used to run background refills.
+     * @param fetch_block Function that leases a block of IDs from the shared counter.
+     * @param block_size Number of IDs leased per round trip (must be positive).
+     * @param logger Logger for allocation events.
+     */
+    IdAllocator(boost::asio::any_io_executor executor, block_fetcher_t fetch_block, std::uint64_t block_size,
+                logging::logger_t logger);
+
+    /**
+     * @brief Returns the next unique ID.
+     *
+     * Completes synchronously while the calling thread holds a non-empty lease;
+     * only waits on the counter when no leased block is available at all.
+     * @throws std::exception if a block has to be fetched and the fetch fails
+     */
+    [[nodiscard]] auto next() -> boost::asio::awaitable<std::uint64_t>;
+
+  private:
+    /**
+     * @brief Per-thread lease state.
+     *
+     * `next`/`end` are only touched by the owning thread. The spare block is
+     * published by the background refill and consumed by the owner, which is
+     * why it is exchanged through atomics.
+     */
+    struct Lease
+    {
+        std::uint64_t next{0};
+        std::uint64_t end{0}; // exclusive
+        std::atomic<std::uint64_t> spare_begin{0};
+        std::atomic<std::uint64_t> spare_end{0}; // 0 while no spare block is published
+        std::atomic<bool> refill_pending{false};
+    };
+
+    // Returns the calling thread's lease, registering it on first use.
+    [[nodiscard]] auto local_lease() -> Lease &;
+
+    // Moves a published spare block into the active range, if there is one.
+    static void take_spare(Lease &lease) noexcept;
+
+    // Starts a background refill of the lease's spare block.
+    void start_refill(Lease &lease);
+
+    // Background refill coroutine; keeps the allocator alive and never throws.
+    static auto refill(std::shared_ptr<IdAllocator> self, Lease *lease) -> boost::asio::awaitable<void>;
+
+    // Distinguishes allocator instances in the per-thread lease cache.
+    std::uint64_t instance_id_;
+
+    boost::asio::any_io_executor executor_;
+    block_fetcher_t fetch_block_;
+    std::uint64_t block_size_;
+    std::uint64_t refill_threshold_;
+    logging::logger_t logger_;
+
+    // Leases are created once per thread and never erased, so references stay valid.
+    std::mutex leases_mutex_;
+    std::unordered_map<std::thread::id, std::unique_ptr<Lease>> leases_;
+};
+
+} // namespace storage
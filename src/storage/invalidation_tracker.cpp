@@ -0,0 +1,175 @@
+#include "invalidation_tracker.hpp"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/consign.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/redis/logger.hpp>
+#include <boost/redis/request.hpp>
+#include <chrono>
+#include <exception>
+#include <format>
+#include <string_view>
+
+using namespace std::string_view_literals;
+
+namespace storage
+{
+
+namespace
+{
+constexpr std::chrono::seconds kHealthCheckInterval{2};
+constexpr std::chrono::seconds kReconnectWaitInterval{1};
+constexpr std::chrono::seconds kRetryInterval{1};
+} // namespace
+
+InvalidationTracker::InvalidationTracker(boost::asio::any_io_executor executor, std::vector<KeyLayout> layouts,
+                                         InvalidationHandler handler, logging::logger_t logger)
+    : conn_{std::make_shared<boost::redis::connection>(boost::asio::make_strand(executor))},
+      layouts_{std::move(layouts)}, handler_{std::move(handler)}, logger_{std::move(logger)}
+{
+}
+
+auto InvalidationTracker::start(const std::string &host, const std::string &port) -> void
+{
+    name_ = std::format("{}:{}", host, port);
+
+    boost::redis::config cfg;
+    cfg.addr.host = host;
+    cfg.addr.port = port;
+    cfg.health_check_id = "swftly-tracking";
+    cfg.health_check_interval = kHealthCheckInterval;
+    cfg.reconnect_wait_interval = kReconnectWaitInterval;
+    cfg.log_prefix = "(Boost.Redis tracking) ";
+
+    conn_->async_run(cfg, boost::redis::logger{boost::redis::logger::level::err},
+                     boost::asio::consign(boost::asio::detached, conn_));
+    boost::asio::co_spawn(conn_->get_executor(), run(),
+                          boost::asio::consign(boost::asio::detached, shared_from_this()));
+}
+
+auto InvalidationTracker::run() -> boost::asio::awaitable<void>
+{
+    std::vector<std::string> args{"TRACKING", "ON", "BCAST"};
+    for (const auto &layout : layouts_)
+    {
+        args.emplace_back("PREFIX");
+        args.emplace_back(layout.key_prefix());
+    }
+
+    boost::redis::request req;
+    req.push_range("CLIENT"sv, args);
+
+    boost::redis::generic_response pushes;
+    conn_->set_receive_response(pushes);
+
+    while (conn_->will_reconnect())
+    {
+        // Waits for the connection to be (re-)established; tracking is per connection.
+        boost::redis::response<std::string> resp;
+        bool enabled = false;
+        try
+        {
+            co_await conn_->async_exec(req, resp, boost::asio::use_awaitable);
+            enabled = std::get<0>(resp).has_value();
+        }
+        catch (const std::exception &e)
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "CLIENT TRACKING on " << name_ << ": " << e.what();
+        }
+
+        if (!enabled)
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+                << "Enabling client tracking on " << name_ << " failed; retrying";
+            boost::asio::steady_timer timer{conn_->get_executor(), kRetryInterval};
+            co_await timer.async_wait(boost::asio::use_awaitable);
+            continue;
+        }
+
+        BOOST_LOG_SEV(logger_, boost::log::trivial::info) << "Tracking link keys on " << name_;
+        flush();
+
+        for (;;)
+        {
+            try
+            {
+                co_await conn_->async_receive(boost::asio::use_awaitable);
+            }
+            catch (const std::exception &)
+            {
+                break; // connection lost; re-enable tracking once it is back
+            }
+
+            if (pushes.has_value())
+            {
+                dispatch(pushes.value());
+                pushes.value().clear();
+            }
+            else
+            {
+                pushes = boost::redis::generic_response{};
+            }
+        }
+
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Lost client tracking connection to " << name_ << "; cached links will be dropped on reconnect";
+    }
+}
+
+void InvalidationTracker::dispatch(const std::vector<boost::redis::resp3::node> &pushes)
+{
+    // An invalidation is a push of ["invalidate", [key...]]; a null key list means the node was flushed.
+    bool invalidate = false;
+    for (const auto &node : pushes)
+    {
+        if (node.depth == 0)
+        {
+            invalidate = false;
+        }
+        else if (node.depth == 1 && node.data_type == boost::redis::resp3::type::blob_string)
+        {
+            invalidate = node.value == "invalidate"sv;
+            if (invalidate)
+            {
+                messages_.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        else if (invalidate && node.depth == 1 && node.data_type == boost::redis::resp3::type::null)
+        {
+            flush();
+        }
+        else if (invalidate && node.depth == 2)
+        {
+            keys_.fetch_add(1, std::memory_order_relaxed);
+            for (const auto &layout : layouts_)
+            {
+                if (const auto ids = layout.ids_from_key(node.value))
+                {
+                    handler_(ids);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+void InvalidationTracker::flush()
+{
+    flushes_.fetch_add(1, std::memory_order_relaxed);
+    handler_(std::nullopt);
+}
+
+auto InvalidationTracker::stats() const noexcept -> InvalidationStats
+{
+    return InvalidationStats{
+        .messages = messages_.load(std::memory_order_relaxed),
+        .keys = keys_.load(std::memory_order_relaxed),
+        .flushes = flushes_.load(std::memory_order_relaxed),
+    };
+}
+
+} // namespace storage
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "key_layout.hpp"
+#include "logging/logger_setup.hpp"
+#include <array>
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/redis/connection.hpp>
+#include <boost/redis/response.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Counters of server-assisted cache invalidation.
+ */
+struct InvalidationStats
+{
+    std::uint64_t messages{0}; ///< Invalidation pushes received.
+    std::uint64_t keys{0};     ///< Link keys named in those pushes.
+    std::uint64_t flushes{0};  ///< Times every cached link was dropped (reconnects, FLUSHALL).
+};
+
+/// @brief Receives the IDs whose cached URLs are stale, or nullopt if every cached URL may be stale.
+using InvalidationHandler = std::function<void(std::optional<IdRange>)>;
+
+/**
+ * @brief Striped invalidation counters that keep racing lookups from caching stale URLs.
+ *
+ * A lookup reads the epoch of its ID before going to storage and only caches
+ * the result if the epoch is unchanged afterwards; an invalidation arriving in
+ * between bumps it. IDs share stripes, so an unrelated invalidation may cost a
+ * lookup its cache insert, never correctness.
+ */
+class InvalidationEpochs
+{
+  public:
+    /// @brief Gets the current epoch of `id`.
+    [[nodiscard]] auto epoch(std::uint64_t id) const noexcept -> std::uint64_t
+    {
+        return stripes_[id % kStripes].load(std::memory_order_acquire);
+    }
+
+    /// @brief Advances the epoch of every ID in `ids`, or of all IDs if nullopt.
+    void invalidate(std::optional<IdRange> ids) noexcept
+    {
+        const auto count = ids ? ids->last - ids->first + 1 : kStripes;
+        const auto first = ids ? ids->first : 0;
+        for (std::uint64_t i = 0; i < count && i < kStripes; ++i)
+        {
+            stripes_[(first + i) % kStripes].fetch_add(1, std::memory_order_acq_rel);
+        }
+    }
+
+  private:
+    static constexpr std::size_t kStripes = 1024;
+
+    std::array<std::atomic<std::uint64_t>, kStripes> stripes_{};
+};
+
+/**
+ * @brief Listens for Redis client-side caching invalidations on one node.
+ *
+ * Runs a dedicated RESP3 connection with `CLIENT TRACKING ON BCAST` for the
+ * link key prefixes, so Redis pushes an `invalidate` message whenever any
+ * client writes or deletes a link key on that node. Each key is mapped back
+ * to the IDs it holds and passed to the handler.
+ *
+ * Invalidations sent while the connection is down are lost, so the handler is
+ * told to drop everything whenever tracking is (re-)established.
+ */
+class InvalidationTracker : public std::enable_shared_from_this<InvalidationTracker>
+{
+  public:
+    /**
+     * @brief Constructs the tracker.
+     * @param executor The executor the connection runs on.
+     * @param layouts Key layouts whose keys are tracked (current and previous).
+     * @param handler Called, on the connection's strand, for every invalidation.
+     * @param logger Logger for tracking events.
+     */
+    InvalidationTracker(boost::asio::any_io_executor executor, std::vector<KeyLayout> layouts,
+                        InvalidationHandler handler, logging::logger_t logger);
+
+    /**
+     * @brief Connects to the node and starts tracking (with automatic reconnects).
+     * @param host Redis server host
+     * @param port Redis server port
+     */
+    void start(const std::string &host, const std::string &port);
+
+    /// @brief Returns the tracker's counters.
+    [[nodiscard]] auto stats() const noexcept -> InvalidationStats;
+
+  private:
+    // Enables tracking after every (re)connect and dispatches pushes until the connection drops.
+    [[nodiscard]] auto run() -> boost::asio::awaitable<void>;
+
+    // Dispatches the push messages received so far.
+    void dispatch(const std::vector<boost::redis::resp3::node> &pushes);
+
+    // Drops every cached link.
+    void flush();
+
+    std::shared_ptr<boost::redis::connection> conn_;
+    std::vector<KeyLayout> layouts_;
+    InvalidationHandler handler_;
+    std::string name_;
+    mutable logging::logger_t logger_;
+
+    std::atomic<std::uint64_t> messages_{0};
+    std::atomic<std::uint64_t> keys_{0};
+    std::atomic<std::uint64_t> flushes_{0};
+};
+
+} // namespace storage
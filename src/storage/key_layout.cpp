@@ -0,0 +1,103 @@
+#include "key_layout.hpp"
+#include <algorithm>
+#include <charconv>
+#include <format>
+#include <limits>
+#include <stdexcept>
+
+namespace storage
+{
+
+KeyLayout::KeyLayout(Kind kind, std::uint64_t bucket_size, std::string prefix)
+    : kind_{kind}, bucket_size_{bucket_size == 0 ? 1 : bucket_size},
+      key_prefix_{std::move(prefix.append(kind == Kind::buckets ? kBucketPrefix : kUrlPrefix))}
+{
+    if (key_prefix_.size() + std::numeric_limits<std::uint64_t>::digits10 + 1 > kMaxKeyBytes)
+    {
+        throw std::invalid_argument("Redis key prefix is too long");
+    }
+}
+
+auto KeyLayout::kind_from_name(std::string_view name) noexcept -> Kind
+{
+    return name == "buckets" ? Kind::buckets : Kind::keys;
+}
+
+auto KeyLayout::name() const noexcept -> std::string_view
+{
+    return bucketed() ? "buckets" : "keys";
+}
+
+auto KeyLayout::key(std::uint64_t id) const -> std::string
+{
+    return std::format("{}{}", key_prefix_, placement(id));
+}
+
+auto KeyLayout::field(std::uint64_t id) const -> std::string
+{
+    return bucketed() ? std::to_string(id % bucket_size_) : std::string{};
+}
+
+auto KeyLayout::key_into(std::uint64_t id, KeyBuffer &buffer) const noexcept -> std::string_view
+{
+    auto *const digits = std::ranges::copy(key_prefix_, buffer.data()).out;
+    const auto [end, ec] = std::to_chars(digits, buffer.data() + buffer.size(), placement(id));
+    return {buffer.data(), static_cast<std::size_t>(end - buffer.data())};
+}
+
+auto KeyLayout::field_into(std::uint64_t id, KeyBuffer &buffer) const noexcept -> std::string_view
+{
+    if (!bucketed())
+    {
+        return {};
+    }
+    const auto [end, ec] = std::to_chars(buffer.data(), buffer.data() + buffer.size(), id % bucket_size_);
+    return {buffer.data(), static_cast<std::size_t>(end - buffer.data())};
+}
+
+auto KeyLayout::id_from_key(std::string_view key) const noexcept -> std::optional<std::uint64_t>
+{
+    if (bucketed())
+    {
+        return std::nullopt;
+    }
+    return number_from_key(key);
+}
+
+auto KeyLayout::ids_from_key(std::string_view key) const noexcept -> std::optional<IdRange>
+{
+    const auto number = number_from_key(key);
+    if (!number)
+    {
+        return std::nullopt;
+    }
+    if (!bucketed())
+    {
+        return IdRange{.first = *number, .last = *number};
+    }
+    // A bucket whose last ID does not fit in 64 bits holds no links; its range would wrap around.
+    if (*number > (std::numeric_limits<std::uint64_t>::max() - (bucket_size_ - 1)) / bucket_size_)
+    {
+        return std::nullopt;
+    }
+    return IdRange{.first = *number * bucket_size_, .last = (*number * bucket_size_) + bucket_size_ - 1};
+}
+
+auto KeyLayout::number_from_key(std::string_view key) const noexcept -> std::optional<std::uint64_t>
+{
+    if (!key.starts_with(key_prefix_))
+    {
+        return std::nullopt;
+    }
+
+    key.remove_prefix(key_prefix_.size());
+    std::uint64_t id = 0;
+    const auto [end, ec] = std::from_chars(key.data(), key.data() + key.size(), id);
+    if (ec != std::errc{} || end != key.data() + key.size())
+    {
+        return std::nullopt;
+    }
+    return id;
+}
+
+} // namespace storage
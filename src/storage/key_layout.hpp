@@ -0,0 +1,117 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace storage
+{
+
+/**
+ * @brief An inclusive range of link IDs.
+ */
+struct IdRange
+{
+    std::uint64_t first{0}; ///< First ID of the range.
+    std::uint64_t last{0};  ///< Last ID of the range (inclusive).
+};
+
+/**
+ * @brief How links are laid out in Redis keys.
+ *
+ * - `keys`: one string key per link, `url:<id>` → URL.
+ * - `buckets`: links grouped into hashes of `bucket_size` consecutive IDs,
+ *   `urls:<id / bucket_size>` field `<id % bucket_size>` → URL. Small hashes
+ *   are stored as listpacks, which avoids the per-key overhead (dict entry,
+ *   key object, expiry slot) that dominates memory for short values.
+ *
+ * Sharded deployments place a bucket, not a single ID, on a node, so buckets
+ * stay whole.
+ */
+class KeyLayout
+{
+  public:
+    enum class Kind : std::uint8_t
+    {
+        keys,
+        buckets
+    };
+
+    /// @brief Maximum length of a key built by key_into() (prefix plus 20 digits).
+    static constexpr std::size_t kMaxKeyBytes = 64;
+
+    /// @brief Stack storage for a key or field built by key_into() or field_into().
+    using KeyBuffer = std::array<char, kMaxKeyBytes>;
+
+    /**
+     * @brief Constructs a layout.
+     * @param kind The layout kind.
+     * @param bucket_size IDs per bucket (ignored for `keys`).
+     * @param prefix Prepended to every key (empty in production; used to keep benchmark keys apart).
+     * @throws std::invalid_argument if the prefix leaves no room for an ID within kMaxKeyBytes
+     */
+    KeyLayout(Kind kind, std::uint64_t bucket_size, std::string prefix = {});
+
+    /// @brief Parses a layout name ("keys", "buckets"); unknown names yield `keys`.
+    [[nodiscard]] static auto kind_from_name(std::string_view name) noexcept -> Kind;
+
+    /// @brief Gets the layout name ("keys", "buckets").
+    [[nodiscard]] auto name() const noexcept -> std::string_view;
+
+    [[nodiscard]] auto bucketed() const noexcept -> bool
+    {
+        return kind_ == Kind::buckets;
+    }
+
+    [[nodiscard]] auto bucket_size() const noexcept -> std::uint64_t
+    {
+        return bucket_size_;
+    }
+
+    /// @brief Gets the number the hash ring places for `id`: the ID itself, or its bucket.
+    [[nodiscard]] auto placement(std::uint64_t id) const noexcept -> std::uint64_t
+    {
+        return bucketed() ? id / bucket_size_ : id;
+    }
+
+    /// @brief Gets the Redis key holding `id` (its own key, or its bucket).
+    [[nodiscard]] auto key(std::uint64_t id) const -> std::string;
+
+    /// @brief Gets the hash field of `id` within its bucket (empty for `keys`).
+    [[nodiscard]] auto field(std::uint64_t id) const -> std::string;
+
+    /// @brief Like key(), but writes the key into `buffer` instead of allocating; the view points into it.
+    [[nodiscard]] auto key_into(std::uint64_t id, KeyBuffer &buffer) const noexcept -> std::string_view;
+
+    /// @brief Like field(), but writes the field into `buffer` instead of allocating; the view points into it.
+    [[nodiscard]] auto field_into(std::uint64_t id, KeyBuffer &buffer) const noexcept -> std::string_view;
+
+    /// @brief Gets the prefix keys are built from: `<prefix>url:` or `<prefix>urls:`.
+    [[nodiscard]] auto key_prefix() const noexcept -> std::string_view
+    {
+        return key_prefix_;
+    }
+
+    /// @brief Gets the ID a `keys` layout key refers to, or nullopt if `key` is not a link key.
+    [[nodiscard]] auto id_from_key(std::string_view key) const noexcept -> std::optional<std::uint64_t>;
+
+    /// @brief Gets the IDs a key of this layout holds (one ID, or a whole bucket), or nullopt if it holds none
+    /// (including buckets past the largest ID).
+    [[nodiscard]] auto ids_from_key(std::string_view key) const noexcept -> std::optional<IdRange>;
+
+  private:
+    // Parses the number after the key prefix.
+    [[nodiscard]] auto number_from_key(std::string_view key) const noexcept -> std::optional<std::uint64_t>;
+
+    Kind kind_;
+    std::uint64_t bucket_size_;
+    std::string key_prefix_;
+
+    static constexpr std::string_view kUrlPrefix = "url:";
+    static constexpr std::string_view kBucketPrefix = "urls:";
+};
+
+} // namespace storage
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace storage
+{
+
+/**
+ * @brief Lock-free, decaying latency histogram for quantile estimates.
+ *
+ * Latencies are counted in log-linear microsecond buckets (four per power of
+ * two, i.e. within ~19% of the true value). Once `kDecaySamples` samples have
+ * been recorded all counts are halved, so quantiles follow recent behaviour
+ * instead of the whole process lifetime. Decay and recording may race; the
+ * result is an estimate either way.
+ */
+class LatencyHistogram
+{
+  public:
+    /// @brief Records one latency sample.
+    void record(std::chrono::steady_clock::duration latency) noexcept
+    {
+        const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(latency).count();
+        counts_[bucket(micros > 0 ? static_cast<std::uint64_t>(micros) : 1)].fetch_add(1, std::memory_order_relaxed);
+
+        if (total_.fetch_add(1, std::memory_order_relaxed) + 1 >= kDecaySamples)
+        {
+            decay();
+        }
+    }
+
+    /// @brief Gets the number of samples currently weighted by the histogram.
+    [[nodiscard]] auto samples() const noexcept -> std::uint64_t
+    {
+        return total_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Estimates the latency below which fraction `q` of the samples fall.
+     * @return The upper edge of the bucket holding the quantile, or zero without samples.
+     */
+    [[nodiscard]] auto quantile(double q) const noexcept -> std::chrono::microseconds
+    {
+        std::array<std::uint64_t, kBuckets> counts{};
+        std::uint64_t total = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i)
+        {
+            counts[i] = counts_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0)
+        {
+            return std::chrono::microseconds{0};
+        }
+
+        const auto target = static_cast<std::uint64_t>(q * static_cast<double>(total));
+        std::uint64_t seen = 0;
+        for (std::size_t i = 0; i < kBuckets; ++i)
+        {
+            seen += counts[i];
+            if (seen > target)
+            {
+                return std::chrono::microseconds{upper_edge(i)};
+            }
+        }
+        return std::chrono::microseconds{upper_edge(kBuckets - 1)};
+    }
+
+  private:
+    static constexpr std::size_t kSubBuckets = 4;
+    static constexpr std::size_t kBuckets = 40 * kSubBuckets; // up to ~2^40 us
+    static constexpr std::uint64_t kDecaySamples = 4096;
+
+    // Bucket 4*e + f holds values in [(4 + f) << (e - 2), (5 + f) << (e - 2)) for e >= 2.
+    [[nodiscard]] static auto bucket(std::uint64_t micros) noexcept -> std::size_t
+    {
+        const auto exponent = static_cast<std::size_t>(std::bit_width(micros) - 1);
+        const auto fraction = exponent >= 2 ? (micros >> (exponent - 2)) & 3U : (micros << (2 - exponent)) & 3U;
+        const auto index = exponent * kSubBuckets + static_cast<std::size_t>(fraction);
+        return index < kBuckets ? index : kBuckets - 1;
+    }
+
+    [[nodiscard]] static auto upper_edge(std::size_t index) noexcept -> std::int64_t
+    {
+        const auto exponent = index / kSubBuckets;
+        const auto fraction = index % kSubBuckets;
+        if (exponent < 2)
+        {
+            return static_cast<std::int64_t>(exponent + 1);
+        }
+        return static_cast<std::int64_t>((kSubBuckets + fraction + 1) << (exponent - 2));
+    }
+
+    void decay() noexcept
+    {
+        bool expected = false;
+        if (!decaying_.compare_exchange_strong(expected, true, std::memory_order_acquire))
+        {
+            return;
+        }
+
+        std::uint64_t total = 0;
+        for (auto &count : counts_)
+        {
+            const auto halved = count.load(std::memory_order_relaxed) / 2;
+            count.store(halved, std::memory_order_relaxed);
+            total += halved;
+        }
+        total_.store(total, std::memory_order_relaxed);
+        decaying_.store(false, std::memory_order_release);
+    }
+
+    std::array<std::atomic<std::uint64_t>, kBuckets> counts_{};
+    std::atomic<std::uint64_t> total_{0};
+    std::atomic<bool> decaying_{false};
+};
+
+} // namespace storage
@@ -0,0 +1,342 @@
+#include "layout_tool.hpp"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/redis/request.hpp>
+#include <boost/redis/response.hpp>
+#include <charconv>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <map>
+#include <stdexcept>
+#include <string_view>
+
+using namespace std::string_view_literals;
+
+namespace storage
+{
+
+namespace
+{
+auto node_names(const std::vector<conf::RedisNode> &nodes) -> std::vector<std::string>
+{
+    std::vector<std::string> names;
+    names.reserve(nodes.size());
+    for (const auto &node : nodes)
+    {
+        names.push_back(std::format("{}:{}", node.host, node.port));
+    }
+    return names;
+}
+} // namespace
+
+LayoutTool::LayoutTool(boost::asio::any_io_executor executor, logging::logger_t logger, const conf::Config &config)
+    : ring_{node_names(config.redis_nodes())}, source_{KeyLayout::Kind::keys, 1},
+      target_{KeyLayout::Kind::buckets, static_cast<std::uint64_t>(config.redis_bucket_size())},
+      bucket_size_{static_cast<std::uint64_t>(config.redis_bucket_size())}, logger_{std::move(logger)}
+{
+    for (const auto &node : config.redis_nodes())
+    {
+        nodes_.push_back(Node{
+            .name = std::format("{}:{}", node.host, node.port),
+            .host = node.host,
+            .port = std::to_string(node.port),
+            .pool = std::make_shared<ConnectionPool>(executor, 1, logger_),
+        });
+    }
+}
+
+auto LayoutTool::start() -> void
+{
+    for (const auto &node : nodes_)
+    {
+        node.pool->connect(node.host, node.port);
+    }
+}
+
+auto LayoutTool::migrate() -> boost::asio::awaitable<LayoutMigrationStats>
+{
+    LayoutMigrationStats stats;
+    const auto pattern = std::format("{}*", source_.key_prefix());
+
+    for (auto &node : nodes_)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::info) << "Migrating links on " << node.name << " into buckets";
+
+        std::string cursor = "0";
+        do
+        {
+            boost::redis::request req;
+            req.push("SCAN"sv, cursor, "MATCH"sv, pattern, "COUNT"sv, kScanCount);
+
+            // Reply: [cursor, [key...]]; the cursor is the only depth-1 string, keys are at depth 2.
+            boost::redis::generic_response resp;
+            co_await node.pool->exec(req, resp);
+            if (!resp.has_value() || resp.value().size() < 2)
+            {
+                throw std::runtime_error(std::format("Redis SCAN on {} returned unexpected response", node.name));
+            }
+
+            cursor = resp.value()[1].value;
+            std::vector<std::string> keys;
+            for (const auto &item : resp.value())
+            {
+                if (item.depth == 2)
+                {
+                    keys.push_back(item.value);
+                }
+            }
+
+            if (!keys.empty())
+            {
+                co_await migrate_keys(node, keys, stats);
+            }
+        } while (cursor != "0");
+    }
+
+    co_return stats;
+}
+
+auto LayoutTool::migrate_keys(Node &source, const std::vector<std::string> &keys, LayoutMigrationStats &stats)
+    -> boost::asio::awaitable<void>
+{
+    stats.scanned += keys.size();
+
+    boost::redis::request get_req;
+    get_req.push_range("MGET"sv, keys);
+
+    boost::redis::response<std::vector<std::optional<std::string>>> get_resp;
+    co_await source.pool->exec(get_req, get_resp);
+
+    auto &values = std::get<0>(get_resp);
+    if (!values.has_value() || values.value().size() != keys.size())
+    {
+        throw std::runtime_error(std::format("Redis MGET on {} returned unexpected response", source.name));
+    }
+
+    // One pipelined HSETNX request per bucket owner.
+    std::map<std::size_t, boost::redis::request> writes;
+    std::vector<std::string_view> moved_keys;
+    for (std::size_t i = 0; i < keys.size(); ++i)
+    {
+        const auto id = source_.id_from_key(keys[i]);
+        const auto &url = values.value()[i];
+        if (!id || !url)
+        {
+            continue; // not a link key, or deleted since the SCAN
+        }
+
+        writes[ring_.owner(target_.placement(*id))].push("HSETNX"sv, target_.key(*id), target_.field(*id), *url);
+        moved_keys.emplace_back(keys[i]);
+    }
+
+    for (auto &[owner, req] : writes)
+    {
+        // Each HSETNX replies 1 if it wrote the field, 0 if the bucket already had it.
+        boost::redis::generic_response resp;
+        co_await nodes_[owner].pool->exec(req, resp);
+        if (!resp.has_value())
+        {
+            throw std::runtime_error(
+                std::format("Redis HSETNX on {} failed: {}", nodes_[owner].name, resp.error().diagnostic));
+        }
+
+        for (const auto &reply : resp.value())
+        {
+            ++(reply.value == "1" ? stats.moved : stats.skipped);
+        }
+    }
+
+    // Only drop the old keys once every bucket write is acknowledged.
+    if (!moved_keys.empty())
+    {
+        boost::redis::request del_req;
+        del_req.push_range("UNLINK"sv, moved_keys);
+
+        boost::redis::response<long long> del_resp;
+        co_await source.pool->exec(del_req, del_resp);
+        if (!std::get<0>(del_resp).has_value())
+        {
+            throw std::runtime_error(std::format("Redis UNLINK on {} returned unexpected response", source.name));
+        }
+    }
+
+    BOOST_LOG_SEV(logger_, boost::log::trivial::info)
+        << "Migrated " << stats.moved << " of " << stats.scanned << " scanned links so far";
+}
+
+auto LayoutTool::report(std::uint64_t links) -> boost::asio::awaitable<std::vector<LayoutFootprint>>
+{
+    std::vector<LayoutFootprint> footprints;
+    const std::string prefix{kReportPrefix};
+    footprints.push_back(co_await measure(nodes_.front(), KeyLayout{KeyLayout::Kind::keys, 1, prefix}, links));
+    footprints.push_back(
+        co_await measure(nodes_.front(), KeyLayout{KeyLayout::Kind::buckets, bucket_size_, prefix}, links));
+    co_return footprints;
+}
+
+auto LayoutTool::measure(Node &node, const KeyLayout &layout, std::uint64_t links)
+    -> boost::asio::awaitable<LayoutFootprint>
+{
+    BOOST_LOG_SEV(logger_, boost::log::trivial::info)
+        << "Writing " << links << " sample links in the " << layout.name() << " layout to " << node.name;
+
+    const auto before = co_await used_memory(node);
+
+    for (std::uint64_t first = 1; first <= links; first += kWriteChunk)
+    {
+        boost::redis::request req;
+        for (auto id = first; id < first + kWriteChunk && id <= links; ++id)
+        {
+            if (layout.bucketed())
+            {
+                req.push("HSET"sv, layout.key(id), layout.field(id), sample_url(id));
+            }
+            else
+            {
+                req.push("SET"sv, layout.key(id), sample_url(id));
+            }
+        }
+
+        boost::redis::generic_response resp;
+        co_await node.pool->exec(req, resp);
+        if (!resp.has_value())
+        {
+            throw std::runtime_error(std::format("Writing sample links failed: {}", resp.error().diagnostic));
+        }
+    }
+
+    const auto after = co_await used_memory(node);
+
+    boost::redis::request encoding_req;
+    encoding_req.push("OBJECT"sv, "ENCODING"sv, layout.key(1));
+    boost::redis::response<std::string> encoding_resp;
+    co_await node.pool->exec(encoding_req, encoding_resp);
+
+    LayoutFootprint footprint{
+        .layout = std::string{layout.name()},
+        .links = links,
+        .bytes_per_link = after > before ? static_cast<double>(after - before) / static_cast<double>(links) : 0.0,
+        .encoding = std::get<0>(encoding_resp).has_value() ? std::get<0>(encoding_resp).value() : "unknown",
+    };
+
+    // Remove the samples again: one key per link, or one per bucket.
+    const auto last_key = layout.placement(links);
+    for (std::uint64_t first = layout.placement(1); first <= last_key; first += kWriteChunk)
+    {
+        std::vector<std::string> keys;
+        for (auto n = first; n < first + kWriteChunk && n <= last_key; ++n)
+        {
+            keys.push_back(std::format("{}{}", layout.key_prefix(), n));
+        }
+
+        boost::redis::request req;
+        req.push_range("UNLINK"sv, keys);
+        boost::redis::response<long long> resp;
+        co_await node.pool->exec(req, resp);
+    }
+
+    co_return footprint;
+}
+
+auto LayoutTool::used_memory(Node &node) -> boost::asio::awaitable<std::uint64_t>
+{
+    boost::redis::request req;
+    req.push("INFO"sv, "memory"sv);
+
+    boost::redis::response<std::string> resp;
+    co_await node.pool->exec(req, resp);
+
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        throw std::runtime_error("Redis INFO command returned unexpected response");
+    }
+
+    constexpr auto kField = "\nused_memory:"sv;
+    const std::string_view info = result.value();
+    const auto pos = info.find(kField);
+    if (pos == std::string_view::npos)
+    {
+        throw std::runtime_error("Redis INFO reply lacks used_memory");
+    }
+
+    const auto *const begin = info.data() + pos + kField.size();
+    std::uint64_t bytes = 0;
+    std::from_chars(begin, info.data() + info.size(), bytes);
+    co_return bytes;
+}
+
+auto LayoutTool::sample_url(std::uint64_t id) -> std::string
+{
+    return std::format("https://example.com/articles/{}/summary?utm_source=newsletter", id);
+}
+
+auto run_layout_tool(const conf::Config &config, logging::logger_t logger) -> int
+{
+    boost::asio::io_context ioc;
+    LayoutTool tool{ioc.get_executor(), logger, config};
+    tool.start();
+
+    int exit_code = 1;
+    const auto done = [&](std::exception_ptr error)
+    {
+        if (error)
+        {
+            try
+            {
+                std::rethrow_exception(error);
+            }
+            catch (const std::exception &e)
+            {
+                BOOST_LOG_SEV(logger, boost::log::trivial::fatal) << "Layout tool failed: " << e.what();
+            }
+        }
+        else
+        {
+            exit_code = 0;
+        }
+        ioc.stop(); // the Redis connections would keep the context running
+    };
+
+    if (config.migrate_layout())
+    {
+        boost::asio::co_spawn(ioc, tool.migrate(),
+                              [&](std::exception_ptr error, LayoutMigrationStats stats)
+                              {
+                                  if (!error)
+                                  {
+                                      std::cout << std::format("Scanned {} links: {} moved into buckets, {} already "
+                                                               "there\n",
+                                                               stats.scanned, stats.moved, stats.skipped);
+                                  }
+                                  done(error);
+                              });
+    }
+    else
+    {
+        boost::asio::co_spawn(
+            ioc, tool.report(static_cast<std::uint64_t>(config.layout_report_links())),
+            [&](std::exception_ptr error, std::vector<LayoutFootprint> footprints)
+            {
+                if (!error)
+                {
+                    std::cout << std::format("{:<10} {:>10} {:>16} {}\n", "layout", "links", "bytes/link", "encoding");
+                    for (const auto &footprint : footprints)
+                    {
+                        std::cout << std::format("{:<10} {:>10} {:>16.1f} {}\n", footprint.layout, footprint.links,
+                                                 footprint.bytes_per_link, footprint.encoding);
+                    }
+                }
+                done(error);
+            });
+    }
+
+    ioc.run();
+    return exit_code;
+}
+
+} // namespace storage
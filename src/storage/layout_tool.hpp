@@ -0,0 +1,118 @@
+#pragma once
+
+#include "conf/conf.hpp"
+#include "connection_pool.hpp"
+#include "hash_ring.hpp"
+#include "key_layout.hpp"
+#include "logging/logger_setup.hpp"
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Result of a layout migration.
+ */
+struct LayoutMigrationStats
+{
+    std::uint64_t scanned{0}; ///< Per-link keys found.
+    std::uint64_t moved{0};   ///< Links written into their bucket.
+    std::uint64_t skipped{0}; ///< Links already present in their bucket (the old key is still removed).
+};
+
+/**
+ * @brief Memory footprint of one layout, measured with sample links.
+ */
+struct LayoutFootprint
+{
+    std::string layout;       ///< Layout name.
+    std::uint64_t links{0};   ///< Sample links written.
+    double bytes_per_link{0}; ///< Growth of Redis `used_memory` per link.
+    std::string encoding;     ///< OBJECT ENCODING of a sample key.
+};
+
+/**
+ * @brief One-shot maintenance commands for the Redis key layout.
+ *
+ * - migrate(): moves every `url:<id>` key into its hash bucket (HSETNX on
+ *   the node owning the bucket) and deletes the key. Links never change once
+ *   written, so the tool is safe to run while servers keep serving with
+ *   `--redis-layout buckets --redis-previous-layout keys`, and safe to rerun.
+ * - report(): writes sample links in each layout to the first node under a
+ *   scratch prefix, reports the `used_memory` growth per link and deletes
+ *   them again. Point it at a non-production instance.
+ */
+class LayoutTool
+{
+  public:
+    /**
+     * @brief Constructs the tool.
+     * @param executor Executor the Redis connections run on.
+     * @param logger Logger for progress and errors.
+     * @param config The application configuration (Redis nodes, bucket size).
+     */
+    LayoutTool(boost::asio::any_io_executor executor, logging::logger_t logger, const conf::Config &config);
+
+    /// @brief Starts one connection per node.
+    void start();
+
+    /**
+     * @brief Moves all links from the `keys` layout into buckets.
+     * @throws std::exception on Redis errors
+     */
+    [[nodiscard]] auto migrate() -> boost::asio::awaitable<LayoutMigrationStats>;
+
+    /**
+     * @brief Measures the memory footprint of each layout.
+     * @param links Number of sample links to write per layout.
+     * @throws std::exception on Redis errors
+     */
+    [[nodiscard]] auto report(std::uint64_t links) -> boost::asio::awaitable<std::vector<LayoutFootprint>>;
+
+  private:
+    struct Node
+    {
+        std::string name; // host:port
+        std::string host;
+        std::string port;
+        std::shared_ptr<ConnectionPool> pool;
+    };
+
+    // Moves one SCAN page of keys found on `source`.
+    [[nodiscard]] auto migrate_keys(Node &source, const std::vector<std::string> &keys, LayoutMigrationStats &stats)
+        -> boost::asio::awaitable<void>;
+
+    [[nodiscard]] auto measure(Node &node, const KeyLayout &layout, std::uint64_t links)
+        -> boost::asio::awaitable<LayoutFootprint>;
+
+    [[nodiscard]] static auto used_memory(Node &node) -> boost::asio::awaitable<std::uint64_t>;
+
+    // A deterministic sample URL of typical length for `id`.
+    [[nodiscard]] static auto sample_url(std::uint64_t id) -> std::string;
+
+    std::vector<Node> nodes_;
+    HashRing ring_;
+    KeyLayout source_;
+    KeyLayout target_;
+    std::uint64_t bucket_size_;
+    logging::logger_t logger_;
+
+    static constexpr std::uint64_t kScanCount = 1000;
+    static constexpr std::uint64_t kWriteChunk = 1000;
+    static constexpr std::string_view kReportPrefix = "swftly-layout-report:";
+};
+
+/**
+ * @brief Runs the layout tool selected by the configuration (--migrate-layout or --layout-report).
+ *
+ * Uses an io_context of its own and prints the result to stdout.
+ * @return The process exit code.
+ */
+[[nodiscard]] auto run_layout_tool(const conf::Config &config, logging::logger_t logger) -> int;
+
+} // namespace storage
@@ -0,0 +1,622 @@
+#include "log_backend.hpp"
+#include "completion.hpp"
+#include <algorithm>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/crc.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <system_error>
+#include <unistd.h>
+
+namespace storage
+{
+
+namespace
+{
+
+constexpr std::uint32_t kRecordMagic = 0x4c574653;        // "SFWL"
+constexpr std::uint64_t kIndexMagic = 0x58444e494c574653; // "SFWLINDX"
+constexpr std::uint64_t kIndexVersion = 1;
+constexpr std::size_t kScanBufferBytes = std::size_t{1} << 20U;
+
+/// @brief On-disk header preceding every URL in the log.
+struct RecordHeader
+{
+    std::uint32_t magic;
+    std::uint32_t checksum; // CRC-32 of id, size and URL bytes
+    std::uint64_t id;
+    std::uint32_t size; // URL bytes following the header
+    std::uint32_t reserved;
+};
+static_assert(sizeof(RecordHeader) == 24);
+
+/// @brief Header at the start of the index file.
+struct IndexHeader
+{
+    std::uint64_t magic;
+    std::uint64_t version;
+    std::uint64_t covered; // log bytes whose records are in the index and durable
+    std::uint64_t max_id;  // highest ID issued when the index was last synced
+};
+
+auto checksum(std::uint64_t id, std::string_view url) -> std::uint32_t
+{
+    const auto size = static_cast<std::uint32_t>(url.size());
+
+    boost::crc_32_type crc;
+    crc.process_bytes(&id, sizeof(id));
+    crc.process_bytes(&size, sizeof(size));
+    crc.process_bytes(url.data(), url.size());
+    return crc.checksum();
+}
+
+[[noreturn]] void throw_errno(std::string_view what)
+{
+    throw std::system_error(errno, std::generic_category(), std::string{what});
+}
+
+void read_exact(int fd, char *data, std::size_t size, std::uint64_t offset)
+{
+    while (size > 0)
+    {
+        const auto n = ::pread(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            throw_errno("Log store read failed");
+        }
+        if (n == 0)
+        {
+            throw std::runtime_error("Log store read past end of file");
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+}
+
+void write_exact(int fd, const char *data, std::size_t size, std::uint64_t offset)
+{
+    while (size > 0)
+    {
+        const auto n = ::pwrite(fd, data, size, static_cast<off_t>(offset));
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n < 0)
+        {
+            throw_errno("Log store write failed");
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        offset += static_cast<std::uint64_t>(n);
+    }
+}
+
+auto file_size(int fd) -> std::uint64_t
+{
+    struct stat st
+    {
+    };
+    if (::fstat(fd, &st) != 0)
+    {
+        throw_errno("Log store stat failed");
+    }
+    return static_cast<std::uint64_t>(st.st_size);
+}
+
+} // namespace
+
+LogBackend::LogBackend(logging::logger_t logger, const conf::Config &config)
+    : log_path_{config.log_store_path()}, index_path_{log_path_.string() + ".idx"},
+      sync_interval_{config.log_store_sync_interval()}, logger_{std::move(logger)}
+{
+}
+
+LogBackend::~LogBackend()
+{
+    if (sync_thread_.joinable())
+    {
+        sync_thread_.request_stop();
+        sync_thread_.join();
+
+        // A final sync makes the index cover the whole log, so the next start replays nothing.
+        try
+        {
+            std::lock_guard lock{append_mutex_};
+            sync_to(log_end_);
+        }
+        catch (const std::exception &e)
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::error) << "Final log store sync failed: " << e.what();
+        }
+    }
+
+    if (index_base_ != nullptr)
+    {
+        ::munmap(index_base_, kIndexHeaderBytes + index_slots_ * sizeof(std::uint64_t));
+    }
+    if (index_fd_ >= 0)
+    {
+        ::close(index_fd_);
+    }
+    if (log_fd_ >= 0)
+    {
+        ::close(log_fd_);
+    }
+}
+
+auto LogBackend::start() -> void
+{
+    BOOST_LOG_SEV(logger_, boost::log::trivial::info) << "Opening log store at " << log_path_.string();
+
+    open_files();
+
+    const auto log_size = file_size(log_fd_);
+    const auto index_size = file_size(index_fd_);
+
+    IndexHeader header{};
+    if (index_size >= kIndexHeaderBytes)
+    {
+        read_exact(index_fd_, reinterpret_cast<char *>(&header), sizeof(header), 0);
+    }
+
+    const bool index_valid = index_size >= kIndexHeaderBytes && header.magic == kIndexMagic &&
+                             header.version == kIndexVersion && header.covered <= log_size &&
+                             (index_size - kIndexHeaderBytes) % sizeof(std::uint64_t) == 0;
+    if (!index_valid)
+    {
+        if (index_size > 0)
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+                << "Log store index " << index_path_.string() << " is invalid, rebuilding it from the log";
+        }
+        if (::ftruncate(index_fd_, 0) != 0)
+        {
+            throw_errno("Log store index truncate failed");
+        }
+        header = IndexHeader{.magic = kIndexMagic, .version = kIndexVersion, .covered = 0, .max_id = 0};
+    }
+
+    const auto existing_slots = index_valid ? (index_size - kIndexHeaderBytes) / sizeof(std::uint64_t) : 0;
+    map_index(std::max<std::uint64_t>(existing_slots, kIndexGrowthSlots));
+    std::memcpy(index_base_, &header, sizeof(header));
+
+    log_end_ = header.covered;
+    next_id_.store(header.max_id + 1, std::memory_order_relaxed);
+
+    replay(header.covered);
+
+    // Persist the recovered state so that a crash right after start does not replay again.
+    sync_to(log_end_);
+    durable_end_ = log_end_;
+
+    sync_thread_ = std::jthread{[this](std::stop_token stop) { sync_loop(std::move(stop)); }};
+
+    BOOST_LOG_SEV(logger_, boost::log::trivial::info)
+        << "Log store ready: " << log_end_ << " bytes, next ID " << next_id_.load(std::memory_order_relaxed);
+}
+
+auto LogBackend::open_files() -> void
+{
+    log_fd_ = ::open(log_path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (log_fd_ < 0)
+    {
+        throw_errno(std::format("Failed to open log store {}", log_path_.string()));
+    }
+
+    index_fd_ = ::open(index_path_.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (index_fd_ < 0)
+    {
+        throw_errno(std::format("Failed to open log store index {}", index_path_.string()));
+    }
+}
+
+auto LogBackend::map_index(std::uint64_t slots) -> void
+{
+    const auto bytes = kIndexHeaderBytes + slots * sizeof(std::uint64_t);
+    if (::ftruncate(index_fd_, static_cast<off_t>(bytes)) != 0)
+    {
+        throw_errno("Log store index resize failed");
+    }
+
+    if (index_base_ != nullptr)
+    {
+        ::munmap(index_base_, kIndexHeaderBytes + index_slots_ * sizeof(std::uint64_t));
+        index_base_ = nullptr;
+        index_slots_ = 0;
+    }
+
+    void *base = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, index_fd_, 0);
+    if (base == MAP_FAILED)
+    {
+        throw_errno("Log store index mmap failed");
+    }
+
+    index_base_ = static_cast<std::byte *>(base);
+    index_slots_ = slots;
+}
+
+auto LogBackend::replay(std::uint64_t offset) -> void
+{
+    const auto log_size = file_size(log_fd_);
+    std::vector<char> buffer(kScanBufferBytes);
+    std::uint64_t records = 0;
+    std::uint64_t max_id = 0;
+
+    while (offset < log_size)
+    {
+        const auto available = static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), log_size - offset));
+        read_exact(log_fd_, buffer.data(), available, offset);
+
+        std::size_t pos = 0;
+        std::size_t needed = 0; // size of the record that did not fit into the buffer
+        bool corrupt = false;
+        while (available - pos >= sizeof(RecordHeader))
+        {
+            RecordHeader header{};
+            std::memcpy(&header, buffer.data() + pos, sizeof(header));
+
+            const auto record_size = sizeof(RecordHeader) + header.size;
+            if (header.magic != kRecordMagic || header.id == 0 || record_size > kMaxRecordSize)
+            {
+                corrupt = true;
+                break;
+            }
+            if (available - pos < record_size)
+            {
+                needed = record_size;
+                break;
+            }
+
+            const std::string_view url{buffer.data() + pos + sizeof(header), header.size};
+            if (checksum(header.id, url) != header.checksum)
+            {
+                corrupt = true;
+                break;
+            }
+
+            reserve_slot(header.id);
+            publish(header.id, ((offset + pos) << kSizeBits) | record_size);
+            max_id = std::max(max_id, header.id);
+            ++records;
+            pos += record_size;
+        }
+
+        offset += pos;
+        if (corrupt || (pos == 0 && offset + available >= log_size))
+        {
+            break; // torn or damaged tail
+        }
+        if (pos == 0)
+        {
+            buffer.resize(needed); // a single record larger than the buffer
+        }
+    }
+
+    if (offset < log_size)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Log store has " << log_size - offset << " trailing bytes of torn or damaged records at offset "
+            << offset << ", truncating";
+        if (::ftruncate(log_fd_, static_cast<off_t>(offset)) != 0)
+        {
+            throw_errno("Log store truncate failed");
+        }
+
+        // Index slots written before the crash may point into the truncated tail.
+        auto *slots = reinterpret_cast<std::uint64_t *>(index_base_ + kIndexHeaderBytes);
+        for (std::uint64_t id = 0; id < index_slots_; ++id)
+        {
+            if (slots[id] != 0 && (slots[id] >> kSizeBits) + (slots[id] & kMaxRecordSize) > offset)
+            {
+                slots[id] = 0;
+            }
+        }
+    }
+
+    log_end_ = offset;
+    if (max_id >= next_id_.load(std::memory_order_relaxed))
+    {
+        next_id_.store(max_id + 1, std::memory_order_relaxed);
+    }
+
+    if (records > 0)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::info) << "Replayed " << records << " log store records";
+    }
+}
+
+auto LogBackend::reserve_slot(std::uint64_t id) -> void
+{
+    if (id < index_slots_)
+    {
+        return;
+    }
+
+    std::unique_lock lock{index_mutex_};
+    map_index((id / kIndexGrowthSlots + 1) * kIndexGrowthSlots);
+}
+
+auto LogBackend::publish(std::uint64_t id, std::uint64_t slot) -> void
+{
+    auto *slots = reinterpret_cast<std::uint64_t *>(index_base_ + kIndexHeaderBytes);
+    std::atomic_ref{slots[id]}.store(slot, std::memory_order_release);
+}
+
+auto LogBackend::slot(std::uint64_t id) const -> std::uint64_t
+{
+    std::shared_lock lock{index_mutex_};
+    if (id >= index_slots_)
+    {
+        return 0;
+    }
+
+    auto *slots = reinterpret_cast<std::uint64_t *>(index_base_ + kIndexHeaderBytes);
+    return std::atomic_ref{slots[id]}.load(std::memory_order_acquire);
+}
+
+auto LogBackend::append(std::uint64_t id, std::string_view url) -> std::uint64_t
+{
+    if (id == 0)
+    {
+        throw std::invalid_argument("Log store IDs start at 1");
+    }
+
+    const auto record_size = sizeof(RecordHeader) + url.size();
+    if (record_size > kMaxRecordSize)
+    {
+        throw std::invalid_argument("URL is too large for the log store");
+    }
+
+    const RecordHeader header{
+        .magic = kRecordMagic,
+        .checksum = checksum(id, url),
+        .id = id,
+        .size = static_cast<std::uint32_t>(url.size()),
+        .reserved = 0,
+    };
+
+    std::string record(record_size, '\0');
+    std::memcpy(record.data(), &header, sizeof(header));
+    std::memcpy(record.data() + sizeof(header), url.data(), url.size());
+
+    std::lock_guard lock{append_mutex_};
+    if (log_end_ + record_size > kMaxLogSize)
+    {
+        throw std::runtime_error("Log store is full");
+    }
+
+    // A failed write leaves log_end_ untouched, so the next append overwrites the partial record.
+    write_exact(log_fd_, record.data(), record.size(), log_end_);
+    reserve_slot(id);
+    publish(id, (log_end_ << kSizeBits) | record_size);
+    log_end_ += record_size;
+
+    // Keep the counter ahead of IDs stored by callers that did not reserve them here.
+    auto next = next_id_.load(std::memory_order_relaxed);
+    while (id >= next && !next_id_.compare_exchange_weak(next, id + 1, std::memory_order_relaxed))
+    {
+    }
+
+    return log_end_;
+}
+
+auto LogBackend::wait_durable(std::uint64_t end) -> boost::asio::awaitable<void>
+{
+    co_await boost::asio::async_initiate<decltype(boost::asio::use_awaitable), sync_signature_t>(
+        [this, end](auto handler)
+        {
+            std::unique_lock lock{sync_mutex_};
+            if (sync_error_ || durable_end_ >= end)
+            {
+                auto error = sync_error_;
+                lock.unlock();
+                post_completion(sync_handler_t{std::move(handler)}, error);
+                return;
+            }
+
+            sync_waiters_.push_back(SyncWaiter{.end = end, .handler = sync_handler_t{std::move(handler)}});
+            lock.unlock();
+            sync_cv_.notify_one();
+        },
+        boost::asio::use_awaitable);
+}
+
+auto LogBackend::sync_loop(std::stop_token stop) -> void
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock{sync_mutex_};
+            if (!sync_cv_.wait(lock, stop, [this] { return !sync_waiters_.empty(); }))
+            {
+                return; // stop requested and nothing left to sync
+            }
+        }
+
+        // Give concurrent writers the chance to join this sync.
+        if (sync_interval_.count() > 0)
+        {
+            std::this_thread::sleep_for(sync_interval_);
+        }
+
+        std::uint64_t end = 0;
+        {
+            std::lock_guard lock{append_mutex_};
+            end = log_end_;
+        }
+
+        std::exception_ptr error;
+        try
+        {
+            sync_to(end);
+        }
+        catch (const std::exception &e)
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::fatal) << "Log store sync failed: " << e.what();
+            error = std::current_exception();
+        }
+
+        std::vector<SyncWaiter> done;
+        {
+            std::lock_guard lock{sync_mutex_};
+            if (error)
+            {
+                sync_error_ = error;
+            }
+            else
+            {
+                durable_end_ = end;
+            }
+
+            // Waiters that appended after `end` was read stay queued for the next sync.
+            const auto completed = std::ranges::partition(
+                sync_waiters_, [this](const SyncWaiter &waiter) { return !sync_error_ && waiter.end > durable_end_; });
+            std::ranges::move(completed, std::back_inserter(done));
+            sync_waiters_.erase(completed.begin(), completed.end());
+        }
+
+        for (auto &waiter : done)
+        {
+            post_completion(std::move(waiter.handler), error);
+        }
+    }
+}
+
+auto LogBackend::sync_to(std::uint64_t end) -> void
+{
+    if (::fdatasync(log_fd_) != 0)
+    {
+        throw_errno("Log store fdatasync failed");
+    }
+
+    // Index slots below `end` were published before `end` was read, so they are part of this msync.
+    std::shared_lock lock{index_mutex_};
+    if (::msync(index_base_, kIndexHeaderBytes + index_slots_ * sizeof(std::uint64_t), MS_SYNC) != 0)
+    {
+        throw_errno("Log store index msync failed");
+    }
+
+    auto *header = reinterpret_cast<IndexHeader *>(index_base_);
+    header->covered = end;
+    header->max_id = next_id_.load(std::memory_order_relaxed) - 1;
+    if (::msync(index_base_, kIndexHeaderBytes, MS_SYNC) != 0)
+    {
+        throw_errno("Log store index msync failed");
+    }
+}
+
+auto LogBackend::reserve_ids(std::uint64_t count) -> boost::asio::awaitable<std::uint64_t>
+{
+    co_return next_id_.fetch_add(count, std::memory_order_relaxed);
+}
+
+auto LogBackend::high_water() -> boost::asio::awaitable<std::uint64_t>
+{
+    co_return next_id_.load(std::memory_order_relaxed) - 1;
+}
+
+auto LogBackend::store_url(std::uint64_t id, std::string_view url) -> boost::asio::awaitable<void>
+{
+    const auto end = append(id, url);
+    co_await wait_durable(end);
+}
+
+auto LogBackend::store_urls(std::uint64_t first, std::span<const std::string> urls) -> boost::asio::awaitable<void>
+{
+    std::uint64_t end = 0;
+    for (std::size_t i = 0; i < urls.size(); ++i)
+    {
+        end = append(first + i, urls[i]);
+    }
+    co_await wait_durable(end);
+}
+
+auto LogBackend::create_url(std::string_view url) -> boost::asio::awaitable<std::uint64_t>
+{
+    const auto id = next_id_.fetch_add(1, std::memory_order_relaxed);
+    co_await store_url(id, url);
+    co_return id;
+}
+
+auto LogBackend::get_url(std::uint64_t id) -> boost::asio::awaitable<std::optional<std::string>>
+{
+    const auto packed = slot(id);
+    if (packed == 0)
+    {
+        co_return std::nullopt;
+    }
+
+    const auto offset = packed >> kSizeBits;
+    const auto record_size = static_cast<std::size_t>(packed & kMaxRecordSize);
+
+    std::string record(record_size, '\0');
+    read_exact(log_fd_, record.data(), record.size(), offset);
+
+    RecordHeader header{};
+    std::memcpy(&header, record.data(), sizeof(header));
+    if (header.magic != kRecordMagic || header.id != id || sizeof(header) + header.size != record_size)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << "Corrupt log store record for ID " << id;
+        throw std::runtime_error(std::format("Corrupt log store record for ID {}", id));
+    }
+
+    record.erase(0, sizeof(header));
+    co_return record;
+}
+
+auto LogBackend::exists(std::uint64_t id) -> boost::asio::awaitable<bool>
+{
+    co_return slot(id) != 0;
+}
+
+auto LogBackend::add_clicks(std::span<const ClickDelta> deltas) -> boost::asio::awaitable<void>
+{
+    const std::lock_guard lock{clicks_mutex_};
+    for (const auto &delta : deltas)
+    {
+        clicks_[delta.id] += delta.clicks;
+    }
+    co_return;
+}
+
+auto LogBackend::get_clicks(std::span<const std::uint64_t> ids) -> boost::asio::awaitable<std::vector<std::uint64_t>>
+{
+    std::vector<std::uint64_t> clicks;
+    clicks.reserve(ids.size());
+    {
+        const std::lock_guard lock{clicks_mutex_};
+        for (const auto id : ids)
+        {
+            const auto it = clicks_.find(id);
+            clicks.push_back(it == clicks_.end() ? 0 : it->second);
+        }
+    }
+    co_return clicks;
+}
+
+auto LogBackend::ping() -> boost::asio::awaitable<bool>
+{
+    bool healthy = false;
+    {
+        std::lock_guard lock{sync_mutex_};
+        healthy = !sync_error_;
+    }
+    co_return healthy;
+}
+
+} // namespace storage
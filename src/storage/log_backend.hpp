@@ -0,0 +1,167 @@
+#pragma once
+
+#include "backend.hpp"
+#include "conf/conf.hpp"
+#include "logging/logger_setup.hpp"
+#include <atomic>
+#include <boost/asio/any_completion_handler.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <filesystem>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <stop_token>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Embedded backend: an append-only log file plus a memory-mapped index.
+ *
+ * Every stored link is appended to the log as a checksummed record. The index
+ * is a flat array in a second, memory-mapped file; IDs are dense, so slot `id`
+ * holds the record's log offset and size and a lookup is one array read plus
+ * one pread (normally served from the page cache).
+ *
+ * Writes are group-committed: a dedicated thread fsyncs the log at most once
+ * per sync interval and completes every store that landed before the sync, so
+ * a store returns only once it is durable. After each sync the index header
+ * records how much of the log the index covers; recovery only scans the log
+ * beyond that point, and truncates a torn record left by a crash.
+ *
+ * IDs are issued from an in-process counter, so the store must be owned by a
+ * single process. Log and index I/O is blocking but small; this backend is
+ * meant for single-node deployments and benchmarks.
+ */
+class LogBackend final : public Backend
+{
+  public:
+    /**
+     * @brief Constructs the backend.
+     * @param logger Logger for recovery and I/O errors.
+     * @param config The application configuration (log path, sync interval).
+     */
+    LogBackend(logging::logger_t logger, const conf::Config &config);
+
+    LogBackend(const LogBackend &) = delete;
+    LogBackend(LogBackend &&) = delete;
+    auto operator=(const LogBackend &) -> LogBackend & = delete;
+    auto operator=(LogBackend &&) -> LogBackend & = delete;
+
+    /// @brief Completes pending syncs and closes the files.
+    ~LogBackend() override;
+
+    [[nodiscard]] auto name() const noexcept -> std::string_view override
+    {
+        return "log";
+    }
+
+    /// @brief Opens (or creates) the log and index, recovers and starts the sync thread.
+    void start() override;
+
+    [[nodiscard]] auto reserve_ids(std::uint64_t count) -> boost::asio::awaitable<std::uint64_t> override;
+
+    [[nodiscard]] auto high_water() -> boost::asio::awaitable<std::uint64_t> override;
+
+    /// @brief Appends a record and waits until it is synced to disk.
+    [[nodiscard]] auto store_url(std::uint64_t id, std::string_view url) -> boost::asio::awaitable<void> override;
+
+    /// @brief Appends all records and waits for one sync covering them.
+    [[nodiscard]] auto store_urls(std::uint64_t first, std::span<const std::string> urls)
+        -> boost::asio::awaitable<void> override;
+
+    [[nodiscard]] auto create_url(std::string_view url) -> boost::asio::awaitable<std::uint64_t> override;
+
+    [[nodiscard]] auto get_url(std::uint64_t id) -> boost::asio::awaitable<std::optional<std::string>> override;
+
+    [[nodiscard]] auto exists(std::uint64_t id) -> boost::asio::awaitable<bool> override;
+
+    /// @brief Adds the deltas to in-memory totals; click counts are not persisted in the log.
+    [[nodiscard]] auto add_clicks(std::span<const ClickDelta> deltas) -> boost::asio::awaitable<void> override;
+
+    [[nodiscard]] auto get_clicks(std::span<const std::uint64_t> ids)
+        -> boost::asio::awaitable<std::vector<std::uint64_t>> override;
+
+    /// @brief Returns false once a sync has failed; the store then refuses writes.
+    [[nodiscard]] auto ping() -> boost::asio::awaitable<bool> override;
+
+  private:
+    using sync_signature_t = void(std::exception_ptr);
+    using sync_handler_t = boost::asio::any_completion_handler<sync_signature_t>;
+
+    struct SyncWaiter
+    {
+        std::uint64_t end; // log offset that must be durable
+        sync_handler_t handler;
+    };
+
+    // Index slots pack (offset << kSizeBits) | record size; 0 marks an empty slot.
+    static constexpr unsigned kSizeBits = 24;
+    static constexpr std::uint64_t kMaxRecordSize = (std::uint64_t{1} << kSizeBits) - 1;
+    static constexpr std::uint64_t kMaxLogSize = std::uint64_t{1} << (64 - kSizeBits);
+    static constexpr std::size_t kIndexHeaderBytes = 4096;
+    static constexpr std::uint64_t kIndexGrowthSlots = std::uint64_t{1} << 20U; // 8 MiB of index per step
+
+    void open_files();
+    void map_index(std::uint64_t slots);
+
+    // Reads log records from `offset` to the end of the log into the index; truncates a torn tail.
+    void replay(std::uint64_t offset);
+
+    // Grows the index so that slot `id` exists. Caller holds append_mutex_ (or is start()).
+    void reserve_slot(std::uint64_t id);
+    void publish(std::uint64_t id, std::uint64_t slot);
+    [[nodiscard]] auto slot(std::uint64_t id) const -> std::uint64_t;
+
+    // Appends one record and returns the log offset just past it.
+    [[nodiscard]] auto append(std::uint64_t id, std::string_view url) -> std::uint64_t;
+
+    // Suspends until the log is durable up to `end`.
+    [[nodiscard]] auto wait_durable(std::uint64_t end) -> boost::asio::awaitable<void>;
+
+    // Sync thread: fsyncs the log and index, then completes the waiters covered by the sync.
+    void sync_loop(std::stop_token stop);
+    void sync_to(std::uint64_t end);
+
+    std::filesystem::path log_path_;
+    std::filesystem::path index_path_;
+    std::chrono::milliseconds sync_interval_;
+    logging::logger_t logger_;
+
+    int log_fd_{-1};
+    int index_fd_{-1};
+
+    // Guards the index mapping itself; exclusive only while it is remapped to grow.
+    mutable std::shared_mutex index_mutex_;
+    std::byte *index_base_{nullptr};
+    std::uint64_t index_slots_{0};
+
+    // Serializes appends; the log end and index slots below it are published under it.
+    std::mutex append_mutex_;
+    std::uint64_t log_end_{0};
+
+    std::atomic<std::uint64_t> next_id_{1};
+
+    std::mutex sync_mutex_;
+    std::condition_variable_any sync_cv_;
+    std::vector<SyncWaiter> sync_waiters_;
+    std::uint64_t durable_end_{0};
+    std::exception_ptr sync_error_; // sticky: a failed fsync leaves the log in an unknown state
+
+    std::jthread sync_thread_;
+
+    std::mutex clicks_mutex_;
+    std::unordered_map<std::uint64_t, std::uint64_t> clicks_;
+};
+
+} // namespace storage
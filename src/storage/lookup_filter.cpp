@@ -0,0 +1,191 @@
+#include "lookup_filter.hpp"
+
+namespace storage
+{
+
+namespace
+{
+// Minimum time between two high-water mark refreshes.
+constexpr std::chrono::milliseconds kHighWaterRefreshInterval{250};
+
+// splitmix64 finalizer; spreads sequential IDs over the whole bit array.
+constexpr auto mix(std::uint64_t x) noexcept -> std::uint64_t
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30U)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27U)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31U);
+}
+} // namespace
+
+LookupFilter::LookupFilter(std::chrono::steady_clock::duration negative_ttl) : negative_ttl_{negative_ttl}
+{
+    if (negative_ttl_.count() > 0)
+    {
+        generations_ = std::make_unique<std::array<generation_t, kGenerations>>();
+        rotated_at_.store(now_ticks(), std::memory_order_relaxed);
+    }
+}
+
+void LookupFilter::observe(std::uint64_t id) noexcept
+{
+    auto current = high_water_.load(std::memory_order_relaxed);
+    while (id > current && !high_water_.compare_exchange_weak(current, id, std::memory_order_relaxed))
+    {
+    }
+}
+
+auto LookupFilter::high_water() const noexcept -> std::uint64_t
+{
+    return high_water_.load(std::memory_order_relaxed);
+}
+
+auto LookupFilter::above_high_water(std::uint64_t id) noexcept -> bool
+{
+    if (id <= high_water_.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    rejected_above_high_water_.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+auto LookupFilter::try_begin_refresh() noexcept -> bool
+{
+    const auto now = now_ticks();
+    auto last = last_refresh_.load(std::memory_order_relaxed);
+    if (last != 0 &&
+        now - last < std::chrono::duration_cast<std::chrono::steady_clock::duration>(kHighWaterRefreshInterval).count())
+    {
+        return false;
+    }
+
+    return last_refresh_.compare_exchange_strong(last, now, std::memory_order_relaxed);
+}
+
+void LookupFilter::add_missing(std::uint64_t id) noexcept
+{
+    if (!generations_)
+    {
+        return;
+    }
+
+    maybe_rotate();
+
+    auto &generation = (*generations_)[current_.load(std::memory_order_acquire)];
+    for (const auto bit : bit_positions(id))
+    {
+        generation[bit / kWordBits].fetch_or(std::uint64_t{1} << (bit % kWordBits), std::memory_order_relaxed);
+    }
+}
+
+auto LookupFilter::is_known_missing(std::uint64_t id) noexcept -> bool
+{
+    if (!generations_)
+    {
+        return false;
+    }
+
+    maybe_rotate();
+
+    for (const auto &generation : *generations_)
+    {
+        if (contains(generation, id))
+        {
+            rejected_known_missing_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void LookupFilter::forget_missing(std::uint64_t id) noexcept
+{
+    if (!generations_)
+    {
+        return;
+    }
+
+    for (auto &generation : *generations_)
+    {
+        if (contains(generation, id))
+        {
+            clear(generation);
+        }
+    }
+}
+
+auto LookupFilter::stats() const noexcept -> LookupFilterStats
+{
+    return LookupFilterStats{
+        .high_water = high_water_.load(std::memory_order_relaxed),
+        .rejected_above_high_water = rejected_above_high_water_.load(std::memory_order_relaxed),
+        .rejected_known_missing = rejected_known_missing_.load(std::memory_order_relaxed),
+    };
+}
+
+auto LookupFilter::bit_positions(std::uint64_t id) noexcept -> std::array<std::size_t, kHashCount>
+{
+    // Kirsch-Mitzenmacher double hashing: k positions from two 32-bit halves of one hash.
+    const auto h = mix(id);
+    const auto h1 = static_cast<std::uint32_t>(h);
+    const auto h2 = static_cast<std::uint32_t>(h >> 32U);
+
+    std::array<std::size_t, kHashCount> positions{};
+    for (std::size_t i = 0; i < kHashCount; ++i)
+    {
+        positions.at(i) = (h1 + i * h2) % kBitsPerGeneration;
+    }
+    return positions;
+}
+
+auto LookupFilter::contains(const generation_t &generation, std::uint64_t id) noexcept -> bool
+{
+    for (const auto bit : bit_positions(id))
+    {
+        if ((generation[bit / kWordBits].load(std::memory_order_relaxed) & (std::uint64_t{1} << (bit % kWordBits))) ==
+            0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void LookupFilter::clear(generation_t &generation) noexcept
+{
+    for (auto &word : generation)
+    {
+        word.store(0, std::memory_order_relaxed);
+    }
+}
+
+auto LookupFilter::now_ticks() noexcept -> std::int64_t
+{
+    return std::chrono::steady_clock::now().time_since_epoch().count();
+}
+
+void LookupFilter::maybe_rotate() noexcept
+{
+    const auto now = now_ticks();
+    auto rotated_at = rotated_at_.load(std::memory_order_relaxed);
+    if (now - rotated_at < (negative_ttl_ / 2).count())
+    {
+        return;
+    }
+
+    // Only one thread performs the rotation.
+    if (!rotated_at_.compare_exchange_strong(rotated_at, now, std::memory_order_relaxed))
+    {
+        return;
+    }
+
+    // Recycle the older generation as the new current one. Concurrent readers may
+    // briefly see it half-cleared, which can only produce false "not missing" answers.
+    const auto next = (current_.load(std::memory_order_relaxed) + 1) % kGenerations;
+    clear((*generations_)[next]);
+    current_.store(next, std::memory_order_release);
+}
+
+} // namespace storage
@@ -0,0 +1,121 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace storage
+{
+
+/**
+ * @brief Counters of lookups rejected without a storage round trip.
+ */
+struct LookupFilterStats
+{
+    std::uint64_t high_water{0};
+    std::uint64_t rejected_above_high_water{0};
+    std::uint64_t rejected_known_missing{0};
+};
+
+/**
+ * @brief Outcome of a high-water mark refresh (a read of the storage ID counter).
+ */
+struct HighWaterRefresh
+{
+    bool refreshed{false};                         ///< False if it was skipped, see LookupFilter::try_begin_refresh().
+    std::chrono::steady_clock::time_point started; ///< When the counter was read.
+};
+
+/**
+ * @brief Cheap pre-check that rejects lookups for IDs that cannot exist.
+ *
+ * Two independent mechanisms are combined:
+ * - A high-water mark: IDs come from a monotonically increasing counter, so
+ *   any ID above the highest known counter value has never been issued.
+ * - A negative cache: a time-rotated Bloom filter of IDs recently found to be
+ *   missing (or deleted). Entries age out within one TTL, which bounds how
+ *   long an ID that gets assigned later (e.g. from another node's lease) can
+ *   be misreported as missing.
+ *
+ * All operations are lock-free and safe to call from any thread. The filter
+ * never produces false "exists" answers for the high-water check; the Bloom
+ * filter may produce false "missing" answers at its configured error rate.
+ */
+class LookupFilter
+{
+  public:
+    /**
+     * @brief Constructs the filter.
+     * @param negative_ttl How long a missing ID is remembered (zero disables the negative cache).
+     */
+    explicit LookupFilter(std::chrono::steady_clock::duration negative_ttl);
+
+    /// @brief Raises the high-water mark to at least `id`.
+    void observe(std::uint64_t id) noexcept;
+
+    /// @brief Returns the highest ID known to be issued.
+    [[nodiscard]] auto high_water() const noexcept -> std::uint64_t;
+
+    /// @brief Returns true (and counts a rejection) if `id` is above the high-water mark.
+    [[nodiscard]] auto above_high_water(std::uint64_t id) noexcept -> bool;
+
+    /**
+     * @brief Claims the right to refresh the high-water mark from storage.
+     *
+     * Rate-limits refreshes so that bursts of lookups for unknown IDs cost at
+     * most one counter read per refresh interval.
+     * @return true if the caller should refresh now.
+     */
+    [[nodiscard]] auto try_begin_refresh() noexcept -> bool;
+
+    /// @brief Remembers `id` as missing for the negative cache TTL.
+    void add_missing(std::uint64_t id) noexcept;
+
+    /// @brief Returns true (and counts a rejection) if `id` was recently found to be missing.
+    [[nodiscard]] auto is_known_missing(std::uint64_t id) noexcept -> bool;
+
+    /**
+     * @brief Makes sure `id` is no longer reported as missing.
+     *
+     * Bloom filters cannot remove single entries, so the negative cache is
+     * cleared if `id` is (possibly) in it. Called when an ID gets stored.
+     */
+    void forget_missing(std::uint64_t id) noexcept;
+
+    /// @brief Returns the current high-water mark and rejection counters.
+    [[nodiscard]] auto stats() const noexcept -> LookupFilterStats;
+
+  private:
+    static constexpr std::size_t kBitsPerGeneration = std::size_t{1} << 20U; // 128 KiB per generation
+    static constexpr std::size_t kWordBits = 64;
+    static constexpr std::size_t kWordsPerGeneration = kBitsPerGeneration / kWordBits;
+    static constexpr std::size_t kHashCount = 4;
+    static constexpr std::size_t kGenerations = 2;
+
+    using generation_t = std::array<std::atomic<std::uint64_t>, kWordsPerGeneration>;
+
+    [[nodiscard]] static auto bit_positions(std::uint64_t id) noexcept -> std::array<std::size_t, kHashCount>;
+    [[nodiscard]] static auto contains(const generation_t &generation, std::uint64_t id) noexcept -> bool;
+    static void clear(generation_t &generation) noexcept;
+
+    [[nodiscard]] static auto now_ticks() noexcept -> std::int64_t;
+
+    // Starts a new generation once the current one is half a TTL old.
+    void maybe_rotate() noexcept;
+
+    std::atomic<std::uint64_t> high_water_{0};
+    std::atomic<std::int64_t> last_refresh_{0};
+
+    std::chrono::steady_clock::duration negative_ttl_;
+    std::unique_ptr<std::array<generation_t, kGenerations>> generations_; // null if disabled
+    std::atomic<std::size_t> current_{0};
+    std::atomic<std::int64_t> rotated_at_{0};
+
+    std::atomic<std::uint64_t> rejected_above_high_water_{0};
+    std::atomic<std::uint64_t> rejected_known_missing_{0};
+};
+
+} // namespace storage
@@ -0,0 +1,1050 @@
+#include "redis_backend.hpp"
+#include "completion.hpp"
+#include "util/thread_slot.hpp"
+#include <algorithm>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/redirect_error.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+#include <boost/asio/this_coro.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <boost/log/sources/record_ostream.hpp>
+#include <boost/log/trivial.hpp>
+#include <boost/redis/request.hpp>
+#include <boost/redis/response.hpp>
+#include <boost/redis/src.hpp> // Required: include this in exactly one source file
+#include <format>
+#include <stdexcept>
+#include <string_view>
+#include <unordered_map>
+
+using namespace std::string_view_literals;
+
+namespace storage
+{
+
+namespace
+{
+// KEYS[1] = counter key, ARGV[1] = URL key prefix, ARGV[2] = URL.
+// The URL key is derived from the new ID on the server, so this script
+// requires a non-clustered Redis. Lua numbers are doubles, so the key is
+// formatted with %d to avoid exponent notation for large IDs.
+constexpr std::string_view kCreateScript = R"lua(
+local id = redis.call('INCR', KEYS[1])
+redis.call('SET', ARGV[1] .. string.format('%d', id), ARGV[2])
+return id
+)lua";
+
+// Bucket layout variant: KEYS[1] = counter key, ARGV[1] = bucket key prefix,
+// ARGV[2] = bucket size, ARGV[3] = URL. Lua numbers are doubles, so keys are
+// formatted with %d to avoid exponent notation for large IDs.
+constexpr std::string_view kCreateBucketScript = R"lua(
+local id = redis.call('INCR', KEYS[1])
+local size = tonumber(ARGV[2])
+redis.call('HSET', ARGV[1] .. string.format('%d', math.floor(id / size)), string.format('%d', id % size), ARGV[3])
+return id
+)lua";
+
+// KEYS[1] = reverse index key, KEYS[2] = counter key, ARGV[1] = link key
+// prefix, ARGV[2] = bucket size (0 for one key per link), ARGV[3] = URL.
+// Returns {id, 1} for a new link or {id, 0} for the one already indexed.
+constexpr std::string_view kDedupCreateScript = R"lua(
+local existing = redis.call('GET', KEYS[1])
+if existing then
+    return {tonumber(existing), 0}
+end
+local id = redis.call('INCR', KEYS[2])
+local size = tonumber(ARGV[2])
+if size > 0 then
+    redis.call('HSET', ARGV[1] .. string.format('%d', math.floor(id / size)), string.format('%d', id % size), ARGV[3])
+else
+    redis.call('SET', ARGV[1] .. string.format('%d', id), ARGV[3])
+end
+redis.call('SET', KEYS[1], id)
+return {id, 1}
+)lua";
+
+auto make_layout(std::string_view name, const conf::Config &config) -> KeyLayout
+{
+    return KeyLayout{KeyLayout::kind_from_name(name), static_cast<std::uint64_t>(config.redis_bucket_size())};
+}
+} // namespace
+
+RedisBackend::RedisBackend(boost::asio::any_io_executor executor, logging::logger_t logger,
+                           const conf::Config &config, std::vector<boost::asio::any_io_executor> connection_executors)
+    : ring_{node_names(config.redis_nodes())}, layout_{make_layout(config.redis_layout(), config)},
+      create_script_{layout_.bucketed() ? kCreateBucketScript : kCreateScript}, dedup_script_{kDedupCreateScript},
+      hedge_reads_{config.redis_hedge_reads()}, executor_{executor},
+      connection_executors_{std::move(connection_executors)}, logger_{std::move(logger)}
+{
+    if (connection_executors_.empty())
+    {
+        connection_executors_.push_back(executor);
+    }
+
+    if (!config.redis_previous_layout().empty())
+    {
+        previous_layout_.emplace(make_layout(config.redis_previous_layout(), config));
+    }
+
+    for (const auto &node : config.redis_nodes())
+    {
+        add_shard(executor, node, config);
+    }
+
+    // Replica group i belongs to node i, which is shards_[i].
+    const auto &replicas = config.redis_replicas();
+    for (std::size_t i = 0; i < replicas.size(); ++i)
+    {
+        for (const auto &node : replicas[i])
+        {
+            auto replica = std::make_unique<Endpoint>();
+            init_endpoint(*replica, executor, connection_executors_, node, config, logger_);
+            shards_[i]->replicas.push_back(std::move(replica));
+        }
+    }
+
+    if (!config.redis_previous_nodes().empty())
+    {
+        previous_ring_ = std::make_unique<const HashRing>(node_names(config.redis_previous_nodes()));
+        for (const auto &node : config.redis_previous_nodes())
+        {
+            previous_shards_.push_back(add_shard(executor, node, config));
+        }
+    }
+
+    if (hedge_reads_ && std::ranges::all_of(shards_, [](const auto &shard) { return shard->replicas.empty(); }))
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Hedged reads need read replicas; lookups are sent to the primaries only";
+    }
+
+    if (config.atomic_create() && ring_.size() > 1)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Atomic creates need a single Redis node; with " << ring_.size()
+            << " nodes links are created with a counter reservation followed by SET";
+    }
+}
+
+auto RedisBackend::add_shard(const boost::asio::any_io_executor &executor, const conf::RedisNode &node,
+                             const conf::Config &config) -> std::size_t
+{
+    const auto name = std::format("{}:{}", node.host, node.port);
+    for (std::size_t i = 0; i < shards_.size(); ++i)
+    {
+        if (shards_[i]->primary.name == name)
+        {
+            return i;
+        }
+    }
+
+    auto shard = std::make_unique<Shard>();
+    init_endpoint(shard->primary, executor, connection_executors_, node, config, logger_);
+
+    shards_.push_back(std::move(shard));
+    return shards_.size() - 1;
+}
+
+void RedisBackend::init_endpoint(Endpoint &endpoint, const boost::asio::any_io_executor &executor,
+                                 const std::vector<boost::asio::any_io_executor> &connection_executors,
+                                 const conf::RedisNode &node, const conf::Config &config,
+                                 const logging::logger_t &logger)
+{
+    endpoint.name = std::format("{}:{}", node.host, node.port);
+    endpoint.host = node.host;
+    endpoint.port = std::to_string(node.port);
+    endpoint.pool = std::make_shared<ConnectionPool>(connection_executors, pool_size(config), logger,
+                                                     config.redis_timeout(),
+                                                     CircuitBreakerOptions{
+                                                         .failure_ratio = config.redis_breaker_failure_ratio(),
+                                                         .slow_call = config.redis_breaker_slow_call(),
+                                                         .open_time = config.redis_breaker_open_time(),
+                                                     });
+    if (config.redis_batch_max_keys() > 1)
+    {
+        // One batcher per io_context, so that in thread-per-core mode a lookup is batched, sent and resumed on
+        // its own thread instead of hopping to the first one.
+        const auto &batcher_executors =
+            connection_executors.empty() ? std::vector<boost::asio::any_io_executor>{executor} : connection_executors;
+        for (const auto &batcher_executor : batcher_executors)
+        {
+            endpoint.batchers.push_back(std::make_shared<GetBatcher>(
+                batcher_executor, endpoint.pool, static_cast<std::size_t>(config.redis_batch_max_keys()),
+                config.redis_batch_delay(), logger));
+        }
+    }
+}
+
+auto RedisBackend::pool_size(const conf::Config &config) -> std::size_t
+{
+    // By default every io thread gets a connection of its own.
+    const auto size = config.redis_connections() > 0 ? config.redis_connections() : config.threads();
+    return static_cast<std::size_t>(size);
+}
+
+auto RedisBackend::node_names(const std::vector<conf::RedisNode> &nodes) -> std::vector<std::string>
+{
+    std::vector<std::string> names;
+    names.reserve(nodes.size());
+    for (const auto &node : nodes)
+    {
+        names.push_back(std::format("{}:{}", node.host, node.port));
+    }
+    return names;
+}
+
+auto RedisBackend::owner(std::uint64_t id) const -> Shard &
+{
+    return owner(id, layout_);
+}
+
+auto RedisBackend::owner(std::uint64_t id, const KeyLayout &layout) const -> Shard &
+{
+    return *shards_[ring_.owner(layout.placement(id))];
+}
+
+auto RedisBackend::previous_owner(std::uint64_t id) const -> Shard *
+{
+    if (!previous_ring_)
+    {
+        return nullptr;
+    }
+
+    auto *previous = shards_[previous_shards_[previous_ring_->owner(layout_.placement(id))]].get();
+    return previous == &owner(id) ? nullptr : previous;
+}
+
+auto RedisBackend::counter_shard() const -> Shard &
+{
+    return *shards_.front();
+}
+
+auto RedisBackend::start() -> void
+{
+    BOOST_LOG_SEV(logger_, boost::log::trivial::info)
+        << "Connecting to " << ring_.size() << " Redis node(s) using the " << layout_.name() << " layout"
+        << (previous_ring_ ? " with fallback to the pre-rebalance node list" : "")
+        << (previous_layout_ ? " with fallback to the previous layout" : "");
+
+    // Start the connections (each handles reconnection automatically)
+    for (const auto &shard : shards_)
+    {
+        shard->primary.pool->connect(shard->primary.host, shard->primary.port);
+        for (const auto &replica : shard->replicas)
+        {
+            replica->pool->connect(replica->host, replica->port);
+        }
+    }
+
+    for_each_endpoint(
+        [](Endpoint &endpoint)
+        {
+            if (endpoint.tracker)
+            {
+                endpoint.tracker->start(endpoint.host, endpoint.port);
+            }
+        });
+}
+
+void RedisBackend::track_invalidations(InvalidationHandler handler)
+{
+    std::vector<KeyLayout> layouts{layout_};
+    if (previous_layout_)
+    {
+        layouts.push_back(*previous_layout_);
+    }
+
+    for_each_endpoint(
+        [&](Endpoint &endpoint)
+        {
+            endpoint.tracker = std::make_shared<InvalidationTracker>(executor_, layouts, handler, logger_);
+        });
+}
+
+auto RedisBackend::reserve_ids(std::uint64_t count) -> boost::asio::awaitable<std::uint64_t>
+{
+    boost::redis::request req;
+    req.push("INCRBY"sv, kCounterKey, count);
+
+    boost::redis::response<long long> resp;
+    co_await counter_shard().primary.pool->exec(req, resp);
+
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << "Redis INCRBY command returned unexpected response";
+        throw std::runtime_error("Redis INCRBY command returned unexpected response");
+    }
+
+    // INCRBY returns the counter after the increment, i.e. the last ID of the range.
+    co_return static_cast<std::uint64_t>(result.value()) - count + 1;
+}
+
+auto RedisBackend::high_water() -> boost::asio::awaitable<std::uint64_t>
+{
+    boost::redis::request req;
+    req.push("GET"sv, kCounterKey);
+
+    boost::redis::response<std::optional<std::uint64_t>> resp;
+    co_await counter_shard().primary.pool->exec(req, resp);
+
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error)
+            << "Redis GET command returned unexpected response for ID counter";
+        throw std::runtime_error("Redis GET command returned unexpected response");
+    }
+
+    // A missing counter means no ID was issued yet.
+    co_return result.value().value_or(0);
+}
+
+auto RedisBackend::store_url(std::uint64_t id, std::string_view url) -> boost::asio::awaitable<void>
+{
+    const auto key = layout_.key(id);
+    auto &pool = *owner(id).primary.pool;
+
+    if (layout_.bucketed())
+    {
+        boost::redis::request req;
+        req.push("HSET"sv, key, layout_.field(id), url);
+
+        // HSET returns the number of fields added (0 when replacing).
+        boost::redis::response<long long> resp;
+        co_await pool.exec(req, resp);
+
+        if (!std::get<0>(resp).has_value())
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::error)
+                << "Redis HSET command returned unexpected response for ID " << id;
+            throw std::runtime_error("Redis HSET command returned unexpected response");
+        }
+        co_return;
+    }
+
+    boost::redis::request req;
+    req.push("SET"sv, key, url);
+
+    boost::redis::response<std::string> resp;
+    co_await pool.exec(req, resp);
+
+    // Redis SET returns "OK" on success
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error)
+            << "Redis SET command returned unexpected response for ID " << id;
+        throw std::runtime_error("Redis SET command returned unexpected response");
+    }
+
+    if (result.value() != "OK"sv)
+    {
+        const auto error_msg = std::format("Redis SET command failed: {}", result.value());
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << error_msg;
+        throw std::runtime_error(error_msg);
+    }
+}
+
+auto RedisBackend::store_urls(std::uint64_t first, std::span<const std::string> urls) -> boost::asio::awaitable<void>
+{
+    struct Pipeline
+    {
+        boost::redis::request req;
+        std::size_t commands{0};
+    };
+
+    const auto flush = [this](Shard &shard, Pipeline &pipeline) -> boost::asio::awaitable<void>
+    {
+        boost::redis::generic_response resp;
+        co_await shard.primary.pool->exec(pipeline.req, resp);
+        if (!resp.has_value())
+        {
+            const auto error_msg =
+                std::format("Redis pipelined store on {} failed: {}", shard.primary.name, resp.error().diagnostic);
+            BOOST_LOG_SEV(logger_, boost::log::trivial::error) << error_msg;
+            throw std::runtime_error(error_msg);
+        }
+        pipeline = Pipeline{};
+    };
+
+    // One pipeline per owner node, sent whenever it fills up.
+    std::unordered_map<Shard *, Pipeline> pipelines;
+    for (std::size_t i = 0; i < urls.size(); ++i)
+    {
+        const auto id = first + i;
+        auto &shard = owner(id);
+        auto &pipeline = pipelines[&shard];
+        if (layout_.bucketed())
+        {
+            pipeline.req.push("HSET"sv, layout_.key(id), layout_.field(id), urls[i]);
+        }
+        else
+        {
+            pipeline.req.push("SET"sv, layout_.key(id), urls[i]);
+        }
+
+        if (++pipeline.commands == kStoreChunk)
+        {
+            co_await flush(shard, pipeline);
+        }
+    }
+
+    for (auto &[shard, pipeline] : pipelines)
+    {
+        if (pipeline.commands > 0)
+        {
+            co_await flush(*shard, pipeline);
+        }
+    }
+}
+
+auto RedisBackend::create_url(std::string_view url) -> boost::asio::awaitable<std::uint64_t>
+{
+    // The script writes the link next to the counter, which is only its owner when there is one node.
+    if (ring_.size() > 1)
+    {
+        const auto id = co_await reserve_ids(1);
+        co_await store_url(id, url);
+        co_return id;
+    }
+
+    const auto bucket_size = std::to_string(layout_.bucket_size());
+    std::vector<std::string_view> keys{kCounterKey};
+    std::vector<std::string_view> args{layout_.key_prefix()};
+    if (layout_.bucketed())
+    {
+        args.emplace_back(bucket_size);
+    }
+    args.emplace_back(url);
+
+    boost::redis::response<long long> resp;
+    co_await create_script_.exec(*counter_shard().primary.pool, std::move(keys), std::move(args), resp);
+
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        const auto error_msg = std::format("Redis create script failed: {}", result.error().diagnostic);
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << error_msg;
+        throw std::runtime_error(error_msg);
+    }
+
+    co_return static_cast<std::uint64_t>(result.value());
+}
+
+auto RedisBackend::find_or_create_url(std::string_view digest, std::string_view url)
+    -> boost::asio::awaitable<CreatedUrl>
+{
+    const auto index_key = std::format("{}{}"sv, kDigestPrefix, digest);
+
+    // The script writes the link next to the index, which is only its owner when there is one node.
+    if (ring_.size() > 1)
+    {
+        if (const auto existing = co_await find_digest(index_key))
+        {
+            co_return CreatedUrl{.id = *existing, .created = false};
+        }
+
+        const auto id = co_await reserve_ids(1);
+        co_await store_url(id, url);
+
+        boost::redis::request req;
+        req.push("SET"sv, index_key, id, "NX"sv);
+
+        boost::redis::response<std::optional<std::string>> resp;
+        co_await counter_shard().primary.pool->exec(req, resp);
+
+        const auto &result = std::get<0>(resp);
+        if (!result.has_value())
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::error)
+                << "Redis SET NX command returned unexpected response for digest " << digest;
+            throw std::runtime_error("Redis SET NX command returned unexpected response");
+        }
+        if (result.value().has_value())
+        {
+            co_return CreatedUrl{.id = id, .created = true};
+        }
+
+        // Another create of the same URL won the race; its link is the one to share.
+        if (const auto existing = co_await find_digest(index_key))
+        {
+            co_return CreatedUrl{.id = *existing, .created = false};
+        }
+        co_return CreatedUrl{.id = id, .created = true};
+    }
+
+    const auto bucket_size = std::to_string(layout_.bucketed() ? layout_.bucket_size() : 0);
+    std::vector<std::string_view> keys{index_key, kCounterKey};
+    std::vector<std::string_view> args{layout_.key_prefix(), bucket_size, url};
+
+    boost::redis::response<std::vector<long long>> resp;
+    co_await dedup_script_.exec(*counter_shard().primary.pool, std::move(keys), std::move(args), resp);
+
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value() || result.value().size() != 2)
+    {
+        const auto error_msg = std::format("Redis dedup create script failed: {}",
+                                           result.has_value() ? "unexpected reply" : result.error().diagnostic);
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << error_msg;
+        throw std::runtime_error(error_msg);
+    }
+
+    co_return CreatedUrl{.id = static_cast<std::uint64_t>(result.value()[0]), .created = result.value()[1] == 1};
+}
+
+auto RedisBackend::find_digest(std::string_view key) const -> boost::asio::awaitable<std::optional<std::uint64_t>>
+{
+    boost::redis::request req;
+    req.push("GET"sv, key);
+
+    boost::redis::response<std::optional<std::uint64_t>> resp;
+    co_await counter_shard().primary.pool->exec(req, resp);
+
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << "Redis GET command returned unexpected response for "
+                                                           << key;
+        throw std::runtime_error("Redis GET command returned unexpected response");
+    }
+    co_return result.value();
+}
+
+auto RedisBackend::get_url(std::uint64_t id) -> boost::asio::awaitable<std::optional<std::string>>
+{
+    auto &shard = owner(id);
+    shard.lookups.fetch_add(1, std::memory_order_relaxed);
+
+    auto url = co_await read(shard, id);
+    if (url.has_value())
+    {
+        co_return url;
+    }
+
+    auto *previous = previous_owner(id);
+    if (previous != nullptr)
+    {
+        url = co_await read(*previous, id);
+    }
+
+    // Links not yet moved by a layout migration are still under their old key.
+    if (!url.has_value() && previous_layout_)
+    {
+        url = co_await read(owner(id, *previous_layout_).primary, id, *previous_layout_);
+    }
+
+    if (url.has_value())
+    {
+        co_await migrate(shard, id, url.value());
+    }
+    co_return url;
+}
+
+auto RedisBackend::get_urls(std::span<const std::uint64_t> ids)
+    -> boost::asio::awaitable<std::vector<std::optional<std::string>>>
+{
+    co_return co_await pipelined(ids,
+                                 [this, ids](boost::redis::request &req, std::size_t i)
+                                 {
+                                     if (layout_.bucketed())
+                                     {
+                                         req.push("HGET"sv, layout_.key(ids[i]), layout_.field(ids[i]));
+                                     }
+                                     else
+                                     {
+                                         req.push("GET"sv, layout_.key(ids[i]));
+                                     }
+                                 });
+}
+
+auto RedisBackend::add_clicks(std::span<const ClickDelta> deltas) -> boost::asio::awaitable<void>
+{
+    std::vector<std::uint64_t> ids;
+    ids.reserve(deltas.size());
+    for (const auto &delta : deltas)
+    {
+        ids.push_back(delta.id);
+    }
+
+    // Chunks go out one at a time, so a failed chunk leaves the HINCRBYs of the chunks before it applied.
+    std::vector<bool> acknowledged(ids.size(), false);
+    try
+    {
+        co_await pipelined(
+            ids,
+            [deltas](boost::redis::request &req, std::size_t i)
+            { req.push("HINCRBY"sv, click_key(deltas[i].id), click_field(deltas[i].id), deltas[i].clicks); },
+            &acknowledged);
+    }
+    catch (const std::exception &e)
+    {
+        if (std::ranges::find(acknowledged, true) == acknowledged.end())
+        {
+            throw;
+        }
+
+        std::vector<std::size_t> unacknowledged;
+        for (std::size_t i = 0; i < acknowledged.size(); ++i)
+        {
+            if (!acknowledged[i])
+            {
+                unacknowledged.push_back(i);
+            }
+        }
+        throw PartialWriteError{e.what(), std::move(unacknowledged)};
+    }
+}
+
+auto RedisBackend::get_clicks(std::span<const std::uint64_t> ids)
+    -> boost::asio::awaitable<std::vector<std::uint64_t>>
+{
+    const auto replies =
+        co_await pipelined(ids, [ids](boost::redis::request &req, std::size_t i)
+                           { req.push("HGET"sv, click_key(ids[i]), click_field(ids[i])); });
+
+    std::vector<std::uint64_t> clicks;
+    clicks.reserve(replies.size());
+    for (const auto &reply : replies)
+    {
+        clicks.push_back(reply ? std::stoull(*reply) : 0);
+    }
+    co_return clicks;
+}
+
+auto RedisBackend::click_key(std::uint64_t id) -> std::string
+{
+    return std::format("{}{}", kClickPrefix, id / kClickBucketSize);
+}
+
+auto RedisBackend::click_field(std::uint64_t id) -> std::string
+{
+    return std::to_string(id % kClickBucketSize);
+}
+
+auto RedisBackend::pipelined(std::span<const std::uint64_t> ids, const command_builder_t &push,
+                             std::vector<bool> *acknowledged)
+    -> boost::asio::awaitable<std::vector<std::optional<std::string>>>
+{
+    struct Pipeline
+    {
+        boost::redis::request req;
+        std::vector<std::size_t> positions; // index into `replies` of each command's reply
+    };
+
+    std::vector<std::optional<std::string>> replies(ids.size());
+
+    const auto flush = [this, &replies, acknowledged](Shard &shard, Pipeline &pipeline) -> boost::asio::awaitable<void>
+    {
+        boost::redis::generic_response resp;
+        co_await shard.primary.pool->exec(pipeline.req, resp);
+        if (!resp.has_value())
+        {
+            const auto error_msg =
+                std::format("Redis pipelined request on {} failed: {}", shard.primary.name, resp.error().diagnostic);
+            BOOST_LOG_SEV(logger_, boost::log::trivial::error) << error_msg;
+            throw std::runtime_error(error_msg);
+        }
+
+        // Every command used here has a single top-level reply: a string, a number or null.
+        std::size_t reply = 0;
+        for (const auto &node : resp.value())
+        {
+            if (node.depth != 0 || reply == pipeline.positions.size())
+            {
+                continue;
+            }
+            if (node.data_type != boost::redis::resp3::type::null)
+            {
+                replies[pipeline.positions[reply]] = std::string{node.value};
+            }
+            ++reply;
+        }
+        if (acknowledged != nullptr)
+        {
+            for (const auto position : pipeline.positions)
+            {
+                (*acknowledged)[position] = true;
+            }
+        }
+        pipeline = Pipeline{};
+    };
+
+    std::unordered_map<Shard *, Pipeline> pipelines;
+    for (std::size_t i = 0; i < ids.size(); ++i)
+    {
+        auto &shard = owner(ids[i]);
+        auto &pipeline = pipelines[&shard];
+        push(pipeline.req, i);
+        pipeline.positions.push_back(i);
+
+        if (pipeline.positions.size() == kStoreChunk)
+        {
+            co_await flush(shard, pipeline);
+        }
+    }
+
+    for (auto &[shard, pipeline] : pipelines)
+    {
+        if (!pipeline.positions.empty())
+        {
+            co_await flush(*shard, pipeline);
+        }
+    }
+    co_return replies;
+}
+
+auto RedisBackend::read(Shard &shard, std::uint64_t id) const -> boost::asio::awaitable<std::optional<std::string>>
+{
+    if (shard.replicas.empty())
+    {
+        co_return co_await read(shard.primary, id, layout_);
+    }
+
+    shard.replica_reads.fetch_add(1, std::memory_order_relaxed);
+    std::optional<std::string> url;
+    try
+    {
+        url = hedge_reads_ ? co_await hedged_read(shard, id) : co_await read(replica(shard, 0), id, layout_);
+    }
+    catch (const std::exception &e)
+    {
+        // A failing replica (error, timeout, open breaker) must not fail the lookup while the primary is up.
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Replica read for ID " << id << " failed, reading the primary: " << e.what();
+    }
+    if (url.has_value())
+    {
+        co_return url;
+    }
+
+    // The link may not have replicated yet (e.g. it was created a moment ago); the primary has the final say.
+    shard.primary_fallbacks.fetch_add(1, std::memory_order_relaxed);
+    co_return co_await read(shard.primary, id, layout_);
+}
+
+auto RedisBackend::read(Endpoint &endpoint, std::uint64_t id, const KeyLayout &layout) const
+    -> boost::asio::awaitable<std::optional<std::string>>
+{
+    // Built on the (recycled) coroutine frame, not the heap.
+    KeyLayout::KeyBuffer key_buffer;
+    KeyLayout::KeyBuffer field_buffer;
+    const auto key = layout.key_into(id, key_buffer);
+    const auto field = layout.field_into(id, field_buffer);
+    const auto started = std::chrono::steady_clock::now();
+
+    if (!endpoint.batchers.empty())
+    {
+        const auto &batcher = endpoint.batchers[util::thread_slot() % endpoint.batchers.size()];
+        auto url = co_await batcher->get(std::string{key}, std::string{field});
+        endpoint.latency.record(std::chrono::steady_clock::now() - started);
+        co_return url;
+    }
+
+    boost::redis::request req;
+    if (layout.bucketed())
+    {
+        req.push("HGET"sv, key, field);
+    }
+    else
+    {
+        req.push("GET"sv, key);
+    }
+
+    boost::redis::response<std::optional<std::string>> resp;
+    co_await endpoint.pool->exec(req, resp);
+
+    auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error)
+            << "Redis GET command returned unexpected response for ID " << id << " on " << endpoint.name;
+        throw std::runtime_error("Redis GET command returned unexpected response");
+    }
+
+    endpoint.latency.record(std::chrono::steady_clock::now() - started);
+    co_return std::move(result.value());
+}
+
+auto RedisBackend::hedged_read(Shard &shard, std::uint64_t id) const
+    -> boost::asio::awaitable<std::optional<std::string>>
+{
+    auto &first = replica(shard, 0);
+    auto &second = shard.replicas.size() > 1 ? replica(shard, 1) : shard.primary;
+    const auto delay = hedge_delay(first);
+    const boost::asio::any_io_executor strand = boost::asio::make_strand(co_await boost::asio::this_coro::executor);
+
+    // Both attempts run detached so the loser cannot hold up the answer; its reply is dropped.
+    co_return co_await boost::asio::async_initiate<decltype(boost::asio::use_awaitable), read_signature_t>(
+        [&, this](auto handler)
+        {
+            auto race = std::make_shared<HedgeRace>(read_handler_t{std::move(handler)}, strand);
+            boost::asio::co_spawn(strand, attempt(race, first, id), boost::asio::detached);
+            boost::asio::co_spawn(strand, delayed_attempt(race, shard, second, id, delay), boost::asio::detached);
+        },
+        boost::asio::use_awaitable);
+}
+
+auto RedisBackend::attempt(std::shared_ptr<HedgeRace> race, Endpoint &endpoint, std::uint64_t id) const
+    -> boost::asio::awaitable<void>
+{
+    std::optional<std::string> url;
+    std::exception_ptr error;
+    try
+    {
+        url = co_await read(endpoint, id, layout_);
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+    race->complete(error, std::move(url));
+}
+
+auto RedisBackend::delayed_attempt(std::shared_ptr<HedgeRace> race, Shard &shard, Endpoint &endpoint,
+                                   std::uint64_t id, std::chrono::microseconds delay) const
+    -> boost::asio::awaitable<void>
+{
+    // complete() cancels the wait when the first attempt fails (hedge now) or the lookup is answered (give up).
+    race->timer.expires_after(delay);
+    boost::system::error_code ec;
+    co_await race->timer.async_wait(boost::asio::redirect_error(boost::asio::use_awaitable, ec));
+
+    if (!race->begin_hedge())
+    {
+        co_return;
+    }
+
+    shard.hedged_reads.fetch_add(1, std::memory_order_relaxed);
+    co_await attempt(std::move(race), endpoint, id);
+}
+
+void RedisBackend::HedgeRace::complete(std::exception_ptr error, std::optional<std::string> url)
+{
+    --outstanding;
+    if (finished)
+    {
+        return; // already answered
+    }
+    if (error && (outstanding > 0 || !hedged))
+    {
+        timer.cancel(); // the other attempt may still succeed; start it now if it is still waiting
+        return;
+    }
+
+    finished = true;
+    timer.cancel(); // a hedge still waiting gives up now instead of after the delay
+    post_completion(std::move(handler), std::move(error), std::move(url));
+}
+
+auto RedisBackend::HedgeRace::begin_hedge() -> bool
+{
+    if (finished)
+    {
+        return false;
+    }
+    hedged = true;
+    ++outstanding;
+    return true;
+}
+
+auto RedisBackend::replica(const Shard &shard, std::size_t offset) -> Endpoint &
+{
+    return *shard.replicas[(util::thread_slot() + offset) % shard.replicas.size()];
+}
+
+auto RedisBackend::hedge_delay(const Endpoint &endpoint) -> std::chrono::microseconds
+{
+    if (endpoint.latency.samples() < kMinHedgeSamples)
+    {
+        return kDefaultHedgeDelay;
+    }
+    return std::max(kMinHedgeDelay, endpoint.latency.quantile(kHedgeQuantile));
+}
+
+auto RedisBackend::migrate(Shard &shard, std::uint64_t id, std::string_view url) const
+    -> boost::asio::awaitable<void>
+{
+    const auto key = layout_.key(id);
+
+    // SET NX / HSETNX leave a link written to its new place in the meantime untouched.
+    bool failed = false;
+    if (layout_.bucketed())
+    {
+        boost::redis::request req;
+        req.push("HSETNX"sv, key, layout_.field(id), url);
+
+        boost::redis::response<long long> resp;
+        co_await shard.primary.pool->exec(req, resp);
+        failed = !std::get<0>(resp).has_value();
+    }
+    else
+    {
+        boost::redis::request req;
+        req.push("SET"sv, key, url, "NX"sv);
+
+        boost::redis::response<std::optional<std::string>> resp;
+        co_await shard.primary.pool->exec(req, resp);
+        failed = !std::get<0>(resp).has_value();
+    }
+
+    if (failed)
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+            << "Failed to migrate ID " << id << " to " << shard.primary.name << ", will retry on next lookup";
+        co_return;
+    }
+
+    shard.migrated.fetch_add(1, std::memory_order_relaxed);
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Migrated ID " << id << " to " << shard.primary.name;
+}
+
+auto RedisBackend::exists(std::uint64_t id) -> boost::asio::awaitable<bool>
+{
+    if (co_await key_exists(owner(id), id, layout_))
+    {
+        co_return true;
+    }
+
+    auto *previous = previous_owner(id);
+    if (previous != nullptr && co_await key_exists(*previous, id, layout_))
+    {
+        co_return true;
+    }
+
+    co_return previous_layout_ && co_await key_exists(owner(id, *previous_layout_), id, *previous_layout_);
+}
+
+auto RedisBackend::key_exists(Shard &shard, std::uint64_t id, const KeyLayout &layout) const
+    -> boost::asio::awaitable<bool>
+{
+    boost::redis::request req;
+    if (layout.bucketed())
+    {
+        req.push("HEXISTS"sv, layout.key(id), layout.field(id));
+    }
+    else
+    {
+        req.push("EXISTS"sv, layout.key(id));
+    }
+
+    boost::redis::response<long long> resp;
+    co_await shard.primary.pool->exec(req, resp);
+
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error)
+            << "Redis EXISTS command returned unexpected response for ID " << id << " on " << shard.primary.name;
+        throw std::runtime_error("Redis EXISTS command returned unexpected response");
+    }
+
+    // Redis EXISTS / HEXISTS return 1 if the key (field) exists, 0 if not
+    co_return result.value() == 1;
+}
+
+auto RedisBackend::ping() -> boost::asio::awaitable<bool>
+{
+    bool healthy = true;
+    for (const auto &shard : shards_)
+    {
+        healthy = co_await ping(shard->primary) && healthy;
+        for (const auto &replica : shard->replicas)
+        {
+            healthy = co_await ping(*replica) && healthy;
+        }
+    }
+
+    co_return healthy;
+}
+
+auto RedisBackend::ping(Endpoint &endpoint) const -> boost::asio::awaitable<bool>
+{
+    boost::redis::request req;
+    req.push("PING"sv);
+
+    boost::redis::response<std::string> resp;
+    co_await endpoint.pool->exec(req, resp);
+
+    // Redis PING returns "PONG"
+    const auto &result = std::get<0>(resp);
+    if (!result.has_value())
+    {
+        BOOST_LOG_SEV(logger_, boost::log::trivial::error)
+            << "Redis PING command returned unexpected response from " << endpoint.name;
+        throw std::runtime_error("Redis PING command returned unexpected response");
+    }
+
+    co_return result.value() == "PONG"sv;
+}
+
+auto RedisBackend::shard_stats() const -> std::vector<ShardStats>
+{
+    std::vector<ShardStats> stats;
+    stats.reserve(shards_.size());
+    for (const auto &shard : shards_)
+    {
+        std::vector<std::string> replicas;
+        replicas.reserve(shard->replicas.size());
+        for (const auto &replica : shard->replicas)
+        {
+            replicas.push_back(replica->name);
+        }
+
+        std::vector<CircuitBreakerStats> breakers{shard->primary.pool->breaker_stats()};
+        for (const auto &replica : shard->replicas)
+        {
+            breakers.push_back(replica->pool->breaker_stats());
+        }
+
+        stats.push_back(ShardStats{
+            .node = shard->primary.name,
+            .lookups = shard->lookups.load(std::memory_order_relaxed),
+            .migrated = shard->migrated.load(std::memory_order_relaxed),
+            .replicas = std::move(replicas),
+            .replica_reads = shard->replica_reads.load(std::memory_order_relaxed),
+            .primary_fallbacks = shard->primary_fallbacks.load(std::memory_order_relaxed),
+            .hedged_reads = shard->hedged_reads.load(std::memory_order_relaxed),
+            .connections = shard->primary.pool->stats(),
+            .breakers = std::move(breakers),
+        });
+    }
+    return stats;
+}
+
+auto RedisBackend::batching_stats() const -> GetBatcherStats
+{
+    GetBatcherStats total;
+    for_each_endpoint(
+        [&total](const Endpoint &endpoint)
+        {
+            for (const auto &batcher : endpoint.batchers)
+            {
+                const auto stats = batcher->stats();
+                total.batches += stats.batches;
+                total.keys += stats.keys;
+            }
+        });
+    return total;
+}
+
+auto RedisBackend::invalidation_stats() const -> InvalidationStats
+{
+    InvalidationStats total;
+    for_each_endpoint(
+        [&total](const Endpoint &endpoint)
+        {
+            if (endpoint.tracker)
+            {
+                const auto stats = endpoint.tracker->stats();
+                total.messages += stats.messages;
+                total.keys += stats.keys;
+                total.flushes += stats.flushes;
+            }
+        });
+    return total;
+}
+
+} // namespace storage
@@ -0,0 +1,334 @@
+#pragma once
+
+#include "backend.hpp"
+#include "conf/conf.hpp"
+#include "connection_pool.hpp"
+#include "get_batcher.hpp"
+#include "hash_ring.hpp"
+#include "invalidation_tracker.hpp"
+#include "key_layout.hpp"
+#include "latency_histogram.hpp"
+#include "logging/logger_setup.hpp"
+#include "redis_script.hpp"
+#include <atomic>
+#include <boost/asio/any_io_executor.hpp>
+#include <boost/asio/any_completion_handler.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <chrono>
+#include <cstddef>
+#include <exception>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Backend storing links in Redis, optionally sharded across nodes.
+ *
+ * Layout: the ID counter lives in `url_counter` on the first node, every link
+ * in `url:<id>` (or in hash bucket `urls:<id / size>`, see KeyLayout) on the
+ * node a consistent-hash ring assigns the ID (or bucket) to. Each node has its
+ * own ConnectionPool; lookups are optionally merged into batches per node.
+ *
+ * To add a node without downtime, restart with the new node list and the old
+ * one as the previous list. Lookups that miss on a key's new owner fall back
+ * to its previous owner and copy the link over (SET NX), so keys migrate as
+ * they are read; a background migration can move the rest before the
+ * previous list is dropped again. Switching the key layout works the same
+ * way, with the previous layout as the fallback.
+ *
+ * Atomic creates run as one server-side Lua script, which needs the counter
+ * and the link on the same node; with several nodes they degrade to a
+ * counter reservation followed by a SET. The same holds for deduplicated
+ * creates, whose reverse index (`urlhash:<digest>` → ID) lives next to the
+ * counter.
+ *
+ * Nodes may have read replicas. Lookups then go to a replica picked by the
+ * calling thread, and a replica miss is confirmed on the primary, so a link
+ * that has not replicated yet is still found right after it was created.
+ * With hedged reads enabled, a lookup still unanswered after the replica's
+ * recent p95 latency is sent to a second replica (or the primary) as well,
+ * and whichever answers first wins.
+ *
+ * With invalidation tracking, every primary and replica gets an
+ * InvalidationTracker connection, so writes by any client on any node evict
+ * the affected links from the caller's cache. Replicas are tracked too, so a
+ * lookup that read a replica before the write reached it is corrected when
+ * the replica applies it.
+ */
+class RedisBackend final : public Backend
+{
+  public:
+    /**
+     * @brief Constructs the backend.
+     * @param executor The asio executor background work (batching, tracking) runs on.
+     * @param logger Logger for Redis operations.
+     * @param config The application configuration (Redis nodes, pool size, lookup batching).
+     * @param connection_executors Executors pooled connections are spread over (empty: `executor` only).
+     */
+    RedisBackend(boost::asio::any_io_executor executor, logging::logger_t logger, const conf::Config &config,
+                 std::vector<boost::asio::any_io_executor> connection_executors = {});
+
+    [[nodiscard]] auto name() const noexcept -> std::string_view override
+    {
+        return "redis";
+    }
+
+    /// @brief Starts every pooled connection of every node; each one reconnects independently.
+    void start() override;
+
+    /// @brief Creates an InvalidationTracker for every primary and replica (started by start()).
+    void track_invalidations(InvalidationHandler handler) override;
+
+    /// @brief Advances the counter with INCRBY.
+    [[nodiscard]] auto reserve_ids(std::uint64_t count) -> boost::asio::awaitable<std::uint64_t> override;
+
+    /// @brief Reads the counter.
+    [[nodiscard]] auto high_water() -> boost::asio::awaitable<std::uint64_t> override;
+
+    /// @brief Writes the link to its owner node with SET.
+    [[nodiscard]] auto store_url(std::uint64_t id, std::string_view url) -> boost::asio::awaitable<void> override;
+
+    /// @brief Writes the links to their owner nodes in pipelined requests of up to kStoreChunk commands.
+    [[nodiscard]] auto store_urls(std::uint64_t first, std::span<const std::string> urls)
+        -> boost::asio::awaitable<void> override;
+
+    /// @brief Increments the counter and writes the link in one EVALSHA round trip (single node only).
+    [[nodiscard]] auto create_url(std::string_view url) -> boost::asio::awaitable<std::uint64_t> override;
+
+    /// @brief Looks up the reverse index and creates the link if missing, in one EVALSHA on a single node.
+    [[nodiscard]] auto find_or_create_url(std::string_view digest, std::string_view url)
+        -> boost::asio::awaitable<CreatedUrl> override;
+
+    /// @brief Reads the link from its owner node or its replicas, falling back to the pre-rebalance owner.
+    [[nodiscard]] auto get_url(std::uint64_t id) -> boost::asio::awaitable<std::optional<std::string>> override;
+
+    /**
+     * @brief Reads the links from their owner nodes' primaries in pipelined requests of up to kStoreChunk commands.
+     *
+     * Links not yet moved by a rebalance or layout migration read as missing.
+     */
+    [[nodiscard]] auto get_urls(std::span<const std::uint64_t> ids)
+        -> boost::asio::awaitable<std::vector<std::optional<std::string>>> override;
+
+    [[nodiscard]] auto exists(std::uint64_t id) -> boost::asio::awaitable<bool> override;
+
+    /**
+     * @brief Adds the deltas with one pipelined HINCRBY per link on its owner node.
+     * @throws PartialWriteError If a request fails after earlier ones were applied.
+     */
+    [[nodiscard]] auto add_clicks(std::span<const ClickDelta> deltas) -> boost::asio::awaitable<void> override;
+
+    /// @brief Reads the totals with pipelined HGETs on the owner nodes.
+    [[nodiscard]] auto get_clicks(std::span<const std::uint64_t> ids)
+        -> boost::asio::awaitable<std::vector<std::uint64_t>> override;
+
+    /// @brief Sends PING to every node and replica and expects PONG from all of them.
+    [[nodiscard]] auto ping() -> boost::asio::awaitable<bool> override;
+
+    [[nodiscard]] auto shard_stats() const -> std::vector<ShardStats> override;
+
+    [[nodiscard]] auto batching_stats() const -> GetBatcherStats override;
+
+    [[nodiscard]] auto invalidation_stats() const -> InvalidationStats override;
+
+  private:
+    /**
+     * @brief One Redis server (primary or replica) and its connections.
+     */
+    struct Endpoint
+    {
+        std::string name; // host:port
+        std::string host;
+        std::string port;
+        std::shared_ptr<ConnectionPool> pool;
+        std::vector<std::shared_ptr<GetBatcher>> batchers; // one per io_context; empty if batching is disabled
+        LatencyHistogram latency;                          // lookup latency, drives the hedge delay
+        std::shared_ptr<InvalidationTracker> tracker;      // null unless invalidations are tracked
+    };
+
+    /**
+     * @brief One Redis node: the primary that takes writes and its read replicas.
+     */
+    struct Shard
+    {
+        Endpoint primary;
+        std::vector<std::unique_ptr<Endpoint>> replicas;
+        std::atomic<std::uint64_t> lookups{0};
+        std::atomic<std::uint64_t> migrated{0};
+        std::atomic<std::uint64_t> replica_reads{0};
+        std::atomic<std::uint64_t> primary_fallbacks{0};
+        std::atomic<std::uint64_t> hedged_reads{0};
+    };
+
+    using read_signature_t = void(std::exception_ptr, std::optional<std::string>);
+    using read_handler_t = boost::asio::any_completion_handler<read_signature_t>;
+
+    /**
+     * @brief Shared state of one hedged lookup: the first answer completes it.
+     *
+     * Both attempts run on the strand `timer` was made with, so the state needs no lock.
+     */
+    struct HedgeRace
+    {
+        HedgeRace(read_handler_t handler, const boost::asio::any_io_executor &strand)
+            : handler{std::move(handler)}, timer{strand}
+        {
+        }
+
+        // Completes the lookup with the first answer, or with the last error if every attempt failed. An
+        // error before the second attempt started starts it at once.
+        void complete(std::exception_ptr error, std::optional<std::string> url);
+
+        // Claims the second attempt; false if the lookup is already answered.
+        [[nodiscard]] auto begin_hedge() -> bool;
+
+        read_handler_t handler;
+        boost::asio::steady_timer timer; // the hedge delay; cancelled to hedge early or once answered
+        std::size_t outstanding{1};
+        bool hedged{false};
+        bool finished{false};
+    };
+
+    // Returns the index of the shard for `node`, creating it on first use.
+    auto add_shard(const boost::asio::any_io_executor &executor, const conf::RedisNode &node,
+                   const conf::Config &config) -> std::size_t;
+
+    static void init_endpoint(Endpoint &endpoint, const boost::asio::any_io_executor &executor,
+                              const std::vector<boost::asio::any_io_executor> &connection_executors,
+                              const conf::RedisNode &node, const conf::Config &config, const logging::logger_t &logger);
+
+    [[nodiscard]] auto owner(std::uint64_t id) const -> Shard &;
+
+    // The shard holding `id` under `layout`, which places whole buckets.
+    [[nodiscard]] auto owner(std::uint64_t id, const KeyLayout &layout) const -> Shard &;
+
+    // The shard that owned `id` before the rebalance, or null if it is the current owner.
+    [[nodiscard]] auto previous_owner(std::uint64_t id) const -> Shard *;
+
+    [[nodiscard]] auto counter_shard() const -> Shard &;
+
+    // Reads `id` from the shard's replicas if it has any, confirming misses and failures on the primary.
+    [[nodiscard]] auto read(Shard &shard, std::uint64_t id) const -> boost::asio::awaitable<std::optional<std::string>>;
+
+    [[nodiscard]] auto read(Endpoint &endpoint, std::uint64_t id, const KeyLayout &layout) const
+        -> boost::asio::awaitable<std::optional<std::string>>;
+
+    // Reads from one replica and, if it is slower than its hedge delay, from a second one (or the primary).
+    [[nodiscard]] auto hedged_read(Shard &shard, std::uint64_t id) const
+        -> boost::asio::awaitable<std::optional<std::string>>;
+
+    [[nodiscard]] auto attempt(std::shared_ptr<HedgeRace> race, Endpoint &endpoint, std::uint64_t id) const
+        -> boost::asio::awaitable<void>;
+
+    [[nodiscard]] auto delayed_attempt(std::shared_ptr<HedgeRace> race, Shard &shard, Endpoint &endpoint,
+                                       std::uint64_t id, std::chrono::microseconds delay) const
+        -> boost::asio::awaitable<void>;
+
+    // The replica `offset` places after the calling thread's preferred one.
+    [[nodiscard]] static auto replica(const Shard &shard, std::size_t offset) -> Endpoint &;
+
+    // How long to wait for `endpoint` before hedging: its recent p95 lookup latency, bounded below.
+    [[nodiscard]] static auto hedge_delay(const Endpoint &endpoint) -> std::chrono::microseconds;
+    [[nodiscard]] auto ping(Endpoint &endpoint) const -> boost::asio::awaitable<bool>;
+    [[nodiscard]] auto key_exists(Shard &shard, std::uint64_t id, const KeyLayout &layout) const
+        -> boost::asio::awaitable<bool>;
+
+    // Copies a link found on its previous owner or in the previous layout to its current place, unless it was
+    // written there meanwhile.
+    [[nodiscard]] auto migrate(Shard &shard, std::uint64_t id, std::string_view url) const
+        -> boost::asio::awaitable<void>;
+
+    // Reads a reverse index entry from the counter node.
+    [[nodiscard]] auto find_digest(std::string_view key) const -> boost::asio::awaitable<std::optional<std::uint64_t>>;
+
+    // Appends the command for `ids[i]` to a pipelined request.
+    using command_builder_t = std::function<void(boost::redis::request &, std::size_t)>;
+
+    // Sends one command per ID to the ID's owner primary, in pipelined requests of up to kStoreChunk commands.
+    // Returns each command's reply (nullopt for null), indexed like `ids`. Sets `(*acknowledged)[i]` once the
+    // request holding command i is answered, so a caller can tell which commands were applied if a later one fails.
+    [[nodiscard]] auto pipelined(std::span<const std::uint64_t> ids, const command_builder_t &push,
+                                 std::vector<bool> *acknowledged = nullptr)
+        -> boost::asio::awaitable<std::vector<std::optional<std::string>>>;
+
+    // Click totals live in small hashes of kClickBucketSize links: HINCRBY clicks:<id / size> <id % size>.
+    [[nodiscard]] static auto click_key(std::uint64_t id) -> std::string;
+    [[nodiscard]] static auto click_field(std::uint64_t id) -> std::string;
+
+    // Calls `fn` with the primary and every replica of every node.
+    template <typename Fn> void for_each_endpoint(Fn &&fn) const
+    {
+        for (const auto &shard : shards_)
+        {
+            fn(shard->primary);
+            for (const auto &replica : shard->replicas)
+            {
+                fn(*replica);
+            }
+        }
+    }
+
+    // Number of pooled connections per node: --redis-connections, or one per io thread.
+    [[nodiscard]] static auto pool_size(const conf::Config &config) -> std::size_t;
+
+    [[nodiscard]] static auto node_names(const std::vector<conf::RedisNode> &nodes) -> std::vector<std::string>;
+
+    /// @brief All nodes: the current ones first (ring order), then nodes only in the previous list
+    std::vector<std::unique_ptr<Shard>> shards_;
+
+    /// @brief Assigns IDs to current nodes; owner index i is shards_[i]
+    HashRing ring_;
+
+    /// @brief Assignment before the last rebalance (null if none)
+    std::unique_ptr<const HashRing> previous_ring_;
+
+    /// @brief Maps previous ring owner indices to shards_ indices
+    std::vector<std::size_t> previous_shards_;
+
+    /// @brief Where links are stored
+    KeyLayout layout_;
+
+    /// @brief Layout before the last layout change (empty if none)
+    std::optional<KeyLayout> previous_layout_;
+
+    /// @brief Atomic create script (matching layout_)
+    RedisScript create_script_;
+
+    /// @brief Deduplicated create script
+    RedisScript dedup_script_;
+
+    /// @brief Whether slow replica reads are hedged
+    bool hedge_reads_;
+
+    /// @brief Executor background work (batching, invalidation tracking) runs on
+    boost::asio::any_io_executor executor_;
+
+    /// @brief Executors pooled connections are spread over (one per io_context)
+    std::vector<boost::asio::any_io_executor> connection_executors_;
+
+    /// @brief Logger for Redis operations (mutable to allow logging in const methods)
+    mutable logging::logger_t logger_;
+
+    // Redis key constants
+    static constexpr std::string_view kCounterKey = "url_counter";
+    static constexpr std::string_view kDigestPrefix = "urlhash:";
+    static constexpr std::string_view kClickPrefix = "clicks:";
+    static constexpr std::uint64_t kClickBucketSize = 100; // small enough for Redis' compact hash encoding
+    static constexpr std::size_t kStoreChunk = 1000;       // commands per pipelined request
+
+    // Hedge delay bounds: the default applies until an endpoint has enough samples for a p95
+    static constexpr std::chrono::microseconds kMinHedgeDelay{200};
+    static constexpr std::chrono::microseconds kDefaultHedgeDelay{2000};
+    static constexpr std::uint64_t kMinHedgeSamples = 100;
+    static constexpr double kHedgeQuantile = 0.95;
+};
+
+} // namespace storage
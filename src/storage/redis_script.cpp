@@ -0,0 +1,51 @@
+#include "redis_script.hpp"
+#include <array>
+#include <openssl/evp.h>
+#include <stdexcept>
+
+using namespace std::string_view_literals;
+
+namespace storage
+{
+
+RedisScript::RedisScript(std::string_view source) : source_{source}
+{
+    std::array<unsigned char, EVP_MAX_MD_SIZE> digest{};
+    unsigned int digest_size = 0;
+    if (EVP_Digest(source_.data(), source_.size(), digest.data(), &digest_size, EVP_sha1(), nullptr) != 1)
+    {
+        throw std::runtime_error("Failed to compute SHA1 digest of Redis script");
+    }
+
+    constexpr std::string_view kHexDigits = "0123456789abcdef";
+    sha1_.reserve(static_cast<std::size_t>(digest_size) * 2);
+    for (unsigned int i = 0; i < digest_size; ++i)
+    {
+        sha1_.push_back(kHexDigits[digest.at(i) >> 4U]);
+        sha1_.push_back(kHexDigits[digest.at(i) & 0x0fU]);
+    }
+}
+
+auto RedisScript::make_request(bool by_digest, const std::vector<std::string_view> &keys,
+                               const std::vector<std::string_view> &args) const -> boost::redis::request
+{
+    const auto key_count = std::to_string(keys.size());
+
+    std::vector<std::string_view> params;
+    params.reserve(2 + keys.size() + args.size());
+    params.emplace_back(by_digest ? std::string_view{sha1_} : std::string_view{source_});
+    params.emplace_back(key_count);
+    params.insert(params.end(), keys.begin(), keys.end());
+    params.insert(params.end(), args.begin(), args.end());
+
+    boost::redis::request req;
+    req.push_range(by_digest ? "EVALSHA"sv : "EVAL"sv, params);
+    return req;
+}
+
+auto RedisScript::is_noscript(std::string_view diagnostic) noexcept -> bool
+{
+    return diagnostic.starts_with("NOSCRIPT"sv);
+}
+
+} // namespace storage
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <boost/asio/awaitable.hpp>
+#include <boost/redis/request.hpp>
+#include <boost/redis/response.hpp>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief A Lua script executed server-side by SHA1 digest.
+ *
+ * The digest is computed locally at construction, so there is no need to
+ * preload the script: exec() sends EVALSHA and, if the server answers
+ * NOSCRIPT (e.g. after a restart or SCRIPT FLUSH), transparently retries
+ * once with EVAL, which also caches the script on the server again.
+ */
+class RedisScript
+{
+  public:
+    /**
+     * @brief Constructs the script and computes its SHA1 digest.
+     * @param source The Lua source code.
+     */
+    explicit RedisScript(std::string_view source);
+
+    /// @brief Gets the Lua source code.
+    [[nodiscard]] auto source() const noexcept -> std::string_view
+    {
+        return source_;
+    }
+
+    /// @brief Gets the lowercase hex SHA1 digest used with EVALSHA.
+    [[nodiscard]] auto sha1() const noexcept -> std::string_view
+    {
+        return sha1_;
+    }
+
+    /**
+     * @brief Runs the script, falling back to EVAL on NOSCRIPT.
+     *
+     * @param client The client to run the script on; must provide `exec(request, response) -> awaitable<void>`.
+     * @param keys Values for KEYS.
+     * @param args Values for ARGV.
+     * @param resp Response with a single element, receiving the script's reply.
+     * @throws std::exception on connection errors
+     */
+    template <typename Client, typename Response>
+    auto exec(const Client &client, std::vector<std::string_view> keys, std::vector<std::string_view> args,
+              Response &resp) const -> boost::asio::awaitable<void>
+    {
+        {
+            auto req = make_request(true, keys, args);
+            co_await client.exec(req, resp);
+        }
+
+        const auto &result = std::get<0>(resp);
+        if (result.has_value() || !is_noscript(result.error().diagnostic))
+        {
+            co_return;
+        }
+
+        resp = Response{};
+        auto req = make_request(false, keys, args);
+        co_await client.exec(req, resp);
+    }
+
+  private:
+    [[nodiscard]] auto make_request(bool by_digest, const std::vector<std::string_view> &keys,
+                                    const std::vector<std::string_view> &args) const -> boost::redis::request;
+
+    [[nodiscard]] static auto is_noscript(std::string_view diagnostic) noexcept -> bool;
+
+    std::string source_;
+    std::string sha1_;
+};
+
+} // namespace storage
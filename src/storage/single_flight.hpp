@@ -0,0 +1,182 @@
+#pragma once
+
+#include "completion.hpp"
+#include <array>
+#include <atomic>
+#include <boost/asio/any_completion_handler.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Counters of a SingleFlight group.
+ */
+struct SingleFlightStats
+{
+    std::uint64_t fetches{0};   ///< Calls that performed the fetch themselves.
+    std::uint64_t coalesced{0}; ///< Calls that waited for another caller's fetch.
+};
+
+/**
+ * @brief Coalesces concurrent fetches for the same key into one.
+ *
+ * The first caller for a key runs the fetch; every caller that arrives while
+ * that fetch is in flight suspends and is resumed with the same result (or
+ * exception) once it completes. Waiters are resumed on their own executor, so
+ * the group is safe to use from coroutines running on any io thread.
+ *
+ * Results are not retained after the fetch completes; callers that need that
+ * should put a cache in front of the group.
+ *
+ * @tparam Key Key type identifying a fetch.
+ * @tparam Value Result type; must be copyable and default constructible.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>> class SingleFlight
+{
+  public:
+    /**
+     * @brief Runs `fetch` for `key` unless a fetch for it is already in flight.
+     * @param key The key to fetch.
+     * @param fetch Callable returning `boost::asio::awaitable<Value>`.
+     * @return The fetched value, shared with all concurrent callers for `key`.
+     * @throws Whatever the shared fetch threw.
+     */
+    template <typename Fetch> auto run(Key key, Fetch fetch) -> boost::asio::awaitable<Value>
+    {
+        auto &shard = shard_for(key);
+
+        std::shared_ptr<Flight> flight;
+        bool leader = false;
+        {
+            std::lock_guard lock{shard.mutex};
+            auto [it, inserted] = shard.flights.try_emplace(key);
+            if (inserted)
+            {
+                it->second = std::make_shared<Flight>();
+                leader = true;
+            }
+            flight = it->second;
+        }
+
+        if (!leader)
+        {
+            coalesced_.fetch_add(1, std::memory_order_relaxed);
+            co_return co_await wait(std::move(flight));
+        }
+
+        fetches_.fetch_add(1, std::memory_order_relaxed);
+
+        std::exception_ptr error;
+        Value value{};
+        try
+        {
+            value = co_await fetch();
+        }
+        catch (...)
+        {
+            error = std::current_exception();
+        }
+
+        // Unregister first so that callers arriving from now on start a fresh fetch.
+        {
+            std::lock_guard lock{shard.mutex};
+            shard.flights.erase(key);
+        }
+        complete(*flight, error, value);
+
+        if (error)
+        {
+            std::rethrow_exception(error);
+        }
+        co_return value;
+    }
+
+    /// @brief Returns the group's counters.
+    [[nodiscard]] auto stats() const noexcept -> SingleFlightStats
+    {
+        return SingleFlightStats{
+            .fetches = fetches_.load(std::memory_order_relaxed),
+            .coalesced = coalesced_.load(std::memory_order_relaxed),
+        };
+    }
+
+  private:
+    using signature_t = void(std::exception_ptr, Value);
+    using handler_t = boost::asio::any_completion_handler<signature_t>;
+
+    static constexpr std::size_t kShardCount = 16;
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    struct Flight
+    {
+        std::mutex mutex;
+        bool done{false};
+        std::exception_ptr error;
+        Value value{};
+        std::vector<handler_t> waiters;
+    };
+
+    struct alignas(kCacheLineSize) Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<Key, std::shared_ptr<Flight>, Hash> flights;
+    };
+
+    [[nodiscard]] auto shard_for(const Key &key) -> Shard &
+    {
+        return shards_[Hash{}(key) % kShardCount];
+    }
+
+    // Suspends until the flight completes; resumes immediately if it already has.
+    static auto wait(std::shared_ptr<Flight> flight) -> boost::asio::awaitable<Value>
+    {
+        co_return co_await boost::asio::async_initiate<decltype(boost::asio::use_awaitable), signature_t>(
+            [flight = std::move(flight)](auto handler)
+            {
+                std::unique_lock lock{flight->mutex};
+                if (flight->done)
+                {
+                    lock.unlock();
+                    post_completion(handler_t{std::move(handler)}, flight->error, flight->value);
+                    return;
+                }
+                flight->waiters.emplace_back(std::move(handler));
+            },
+            boost::asio::use_awaitable);
+    }
+
+    static void complete(Flight &flight, const std::exception_ptr &error, const Value &value)
+    {
+        std::vector<handler_t> waiters;
+        {
+            std::lock_guard lock{flight.mutex};
+            flight.done = true;
+            flight.error = error;
+            flight.value = value;
+            waiters.swap(flight.waiters);
+        }
+
+        for (auto &waiter : waiters)
+        {
+            post_completion(std::move(waiter), error, value);
+        }
+    }
+
+    std::array<Shard, kShardCount> shards_;
+    std::atomic<std::uint64_t> fetches_{0};
+    std::atomic<std::uint64_t> coalesced_{0};
+};
+
+} // namespace storage
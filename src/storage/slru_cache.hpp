@@ -0,0 +1,388 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Point-in-time counters of a cache, summed over all shards.
+ */
+struct CacheStats
+{
+    std::uint64_t hits{0};
+    std::uint64_t misses{0};
+    std::uint64_t evictions{0};
+    std::uint64_t entries{0};
+    std::uint64_t pinned{0};
+    std::uint64_t size_bytes{0};
+    std::uint64_t capacity_bytes{0};
+};
+
+/**
+ * @brief A bounded, sharded, thread-safe cache with segmented LRU eviction.
+ *
+ * Each shard keeps two LRU segments:
+ * - probation: newly inserted entries land here
+ * - protected: entries that were hit at least once while in probation
+ *
+ * Entries are evicted from the probation tail first, so a one-off scan over
+ * many keys can only displace other probationary entries and never the
+ * established hot set. Protected entries that overflow their segment are
+ * demoted back to probation instead of being dropped.
+ *
+ * Entries can be pinned (see pin()): eviction passes over them, so a known
+ * hot set stays cached even when a burst of new keys fills the protected
+ * segment. Pinned entries can still be erased.
+ *
+ * Keys are spread over a power-of-two number of shards, each guarded by its
+ * own mutex, so concurrent lookups from different threads rarely contend.
+ * Capacity is expressed in bytes as reported by the Weigher.
+ *
+ * @tparam Key Cache key type.
+ * @tparam Value Cached value type (returned by copy).
+ * @tparam Weigher Callable `(const Key &, const Value &) -> std::size_t` estimating entry size in bytes.
+ * @tparam Hash Hash function for keys.
+ */
+template <typename Key, typename Value, typename Weigher, typename Hash = std::hash<Key>> class SlruCache
+{
+  public:
+    /**
+     * @brief Constructs the cache.
+     * @param capacity_bytes Total capacity over all shards, in bytes.
+     * @param shard_count Requested number of shards (rounded up to a power of two).
+     */
+    SlruCache(std::size_t capacity_bytes, std::size_t shard_count)
+        : shard_count_{std::bit_ceil(shard_count == 0 ? std::size_t{1} : shard_count)},
+          shards_{std::make_unique<Shard[]>(shard_count_)}, capacity_bytes_{capacity_bytes},
+          shard_capacity_{capacity_bytes / shard_count_},
+          protected_capacity_{shard_capacity_ * kProtectedPercent / kPercent}
+    {
+    }
+
+    /**
+     * @brief Looks up a key and records the access.
+     * @return A copy of the cached value, or nullopt on a miss.
+     */
+    [[nodiscard]] auto get(const Key &key) -> std::optional<Value>
+    {
+        auto &shard = shard_for(key);
+        std::lock_guard lock{shard.mutex};
+
+        const auto it = shard.index.find(key);
+        if (it == shard.index.end())
+        {
+            ++shard.misses;
+            return std::nullopt;
+        }
+
+        ++shard.hits;
+        touch(shard, it->second);
+        return it->second->value;
+    }
+
+    /**
+     * @brief Inserts or replaces a value.
+     *
+     * New entries start in the probation segment. Entries larger than a
+     * shard's capacity are not cached.
+     */
+    void put(const Key &key, Value value)
+    {
+        const auto weight = Weigher{}(key, value);
+        if (weight > shard_capacity_)
+        {
+            return;
+        }
+
+        auto &shard = shard_for(key);
+        std::lock_guard lock{shard.mutex};
+
+        if (const auto it = shard.index.find(key); it != shard.index.end())
+        {
+            auto entry = it->second;
+            segment_bytes(shard, entry->is_protected) -= entry->weight;
+            entry->value = std::move(value);
+            entry->weight = weight;
+            segment_bytes(shard, entry->is_protected) += weight;
+            touch(shard, entry);
+        }
+        else
+        {
+            shard.probation.push_front(Entry{key, std::move(value), weight, false, false});
+            shard.probation_bytes += weight;
+            shard.index.emplace(key, shard.probation.begin());
+        }
+
+        evict(shard);
+    }
+
+    /**
+     * @brief Removes a key if present.
+     * @return true if an entry was removed.
+     */
+    auto erase(const Key &key) -> bool
+    {
+        auto &shard = shard_for(key);
+        std::lock_guard lock{shard.mutex};
+
+        const auto it = shard.index.find(key);
+        if (it == shard.index.end())
+        {
+            return false;
+        }
+
+        remove(shard, it->second);
+        return true;
+    }
+
+    /**
+     * @brief Exempts a cached entry from eviction until unpin() or erase().
+     * @return true if the key is cached (and now pinned).
+     */
+    auto pin(const Key &key) -> bool
+    {
+        auto &shard = shard_for(key);
+        std::lock_guard lock{shard.mutex};
+
+        const auto it = shard.index.find(key);
+        if (it == shard.index.end())
+        {
+            return false;
+        }
+
+        if (!it->second->is_pinned)
+        {
+            it->second->is_pinned = true;
+            shard.pinned.push_back(it->second);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Makes a pinned entry evictable again.
+     * @return true if the entry was pinned.
+     */
+    auto unpin(const Key &key) -> bool
+    {
+        auto &shard = shard_for(key);
+        std::lock_guard lock{shard.mutex};
+
+        const auto it = shard.index.find(key);
+        if (it == shard.index.end() || !it->second->is_pinned)
+        {
+            return false;
+        }
+
+        it->second->is_pinned = false;
+        std::erase(shard.pinned, it->second);
+        return true;
+    }
+
+    /**
+     * @brief Copies up to `max_entries` of the most valuable entries.
+     *
+     * Pinned entries come first, then an equal share from every shard:
+     * protected entries first, then probationary ones, each from most to
+     * least recently used.
+     */
+    [[nodiscard]] auto hottest(std::size_t max_entries) const -> std::vector<std::pair<Key, Value>>
+    {
+        std::vector<std::pair<Key, Value>> entries;
+        for (std::size_t i = 0; i < shard_count_ && entries.size() < max_entries; ++i)
+        {
+            const auto &shard = shards_[i];
+            std::lock_guard lock{shard.mutex};
+            for (auto it = shard.pinned.begin(); it != shard.pinned.end() && entries.size() < max_entries; ++it)
+            {
+                entries.emplace_back((*it)->key, (*it)->value);
+            }
+        }
+
+        const auto remaining = max_entries - entries.size();
+        const auto per_shard = (remaining + shard_count_ - 1) / shard_count_;
+        for (std::size_t i = 0; i < shard_count_ && entries.size() < max_entries; ++i)
+        {
+            const auto &shard = shards_[i];
+            std::lock_guard lock{shard.mutex};
+
+            const auto limit = std::min(entries.size() + per_shard, max_entries);
+            for (const auto *segment : {&shard.protected_segment, &shard.probation})
+            {
+                for (auto it = segment->begin(); it != segment->end() && entries.size() < limit; ++it)
+                {
+                    if (!it->is_pinned)
+                    {
+                        entries.emplace_back(it->key, it->value);
+                    }
+                }
+            }
+        }
+        return entries;
+    }
+
+    /// @brief Removes every entry (the hit, miss and eviction counters are kept).
+    void clear()
+    {
+        for (std::size_t i = 0; i < shard_count_; ++i)
+        {
+            auto &shard = shards_[i];
+            std::lock_guard lock{shard.mutex};
+            shard.index.clear();
+            shard.probation.clear();
+            shard.protected_segment.clear();
+            shard.pinned.clear();
+            shard.probation_bytes = 0;
+            shard.protected_bytes = 0;
+        }
+    }
+
+    /// @brief Sums the counters of all shards.
+    [[nodiscard]] auto stats() const -> CacheStats
+    {
+        CacheStats stats{};
+        stats.capacity_bytes = capacity_bytes_;
+        for (std::size_t i = 0; i < shard_count_; ++i)
+        {
+            const auto &shard = shards_[i];
+            std::lock_guard lock{shard.mutex};
+            stats.hits += shard.hits;
+            stats.misses += shard.misses;
+            stats.evictions += shard.evictions;
+            stats.entries += shard.index.size();
+            stats.pinned += shard.pinned.size();
+            stats.size_bytes += shard.probation_bytes + shard.protected_bytes;
+        }
+        return stats;
+    }
+
+  private:
+    // Share of each shard reserved for the protected segment.
+    static constexpr std::size_t kProtectedPercent = 80;
+    static constexpr std::size_t kPercent = 100;
+    static constexpr std::size_t kCacheLineSize = 64;
+
+    struct Entry
+    {
+        Key key;
+        Value value;
+        std::size_t weight;
+        bool is_protected;
+        bool is_pinned;
+    };
+
+    using list_t = std::list<Entry>;
+    using iterator_t = typename list_t::iterator;
+
+    struct alignas(kCacheLineSize) Shard
+    {
+        mutable std::mutex mutex;
+        list_t probation;
+        list_t protected_segment;
+        std::unordered_map<Key, iterator_t, Hash> index;
+        std::vector<iterator_t> pinned;
+        std::size_t probation_bytes{0};
+        std::size_t protected_bytes{0};
+        std::uint64_t hits{0};
+        std::uint64_t misses{0};
+        std::uint64_t evictions{0};
+    };
+
+    [[nodiscard]] auto shard_for(const Key &key) const -> Shard &
+    {
+        // Integer keys hash to themselves, so mix the bits before taking the shard index.
+        auto h = static_cast<std::uint64_t>(Hash{}(key));
+        h ^= h >> 33U;
+        h *= 0xff51afd7ed558ccdULL;
+        h ^= h >> 33U;
+        return shards_[h & (shard_count_ - 1)];
+    }
+
+    static auto segment_bytes(Shard &shard, bool is_protected) -> std::size_t &
+    {
+        return is_protected ? shard.protected_bytes : shard.probation_bytes;
+    }
+
+    // Records an access: probationary entries are promoted, protected ones refreshed.
+    void touch(Shard &shard, iterator_t entry)
+    {
+        if (entry->is_protected)
+        {
+            shard.protected_segment.splice(shard.protected_segment.begin(), shard.protected_segment, entry);
+            return;
+        }
+
+        shard.protected_segment.splice(shard.protected_segment.begin(), shard.probation, entry);
+        entry->is_protected = true;
+        shard.probation_bytes -= entry->weight;
+        shard.protected_bytes += entry->weight;
+
+        // Demote the least recently used protected entries back to probation.
+        while (shard.protected_bytes > protected_capacity_ && shard.protected_segment.size() > 1)
+        {
+            auto demoted = std::prev(shard.protected_segment.end());
+            shard.probation.splice(shard.probation.begin(), shard.protected_segment, demoted);
+            demoted->is_protected = false;
+            shard.protected_bytes -= demoted->weight;
+            shard.probation_bytes += demoted->weight;
+        }
+    }
+
+    void remove(Shard &shard, iterator_t entry)
+    {
+        if (entry->is_pinned)
+        {
+            std::erase(shard.pinned, entry);
+        }
+        segment_bytes(shard, entry->is_protected) -= entry->weight;
+        shard.index.erase(entry->key);
+        (entry->is_protected ? shard.protected_segment : shard.probation).erase(entry);
+    }
+
+    void evict(Shard &shard)
+    {
+        // Pinned victims move to the head of the protected segment instead. Each can come up at most
+        // twice (once per segment) before only pinned entries are left, which then stay over capacity.
+        std::size_t skipped = 0;
+        while (shard.probation_bytes + shard.protected_bytes > shard_capacity_ &&
+               skipped <= 2 * shard.pinned.size())
+        {
+            auto &victims = shard.probation.empty() ? shard.protected_segment : shard.probation;
+            const auto victim = std::prev(victims.end());
+            if (!victim->is_pinned)
+            {
+                remove(shard, victim);
+                ++shard.evictions;
+                continue;
+            }
+
+            shard.protected_segment.splice(shard.protected_segment.begin(), victims, victim);
+            if (!victim->is_protected)
+            {
+                victim->is_protected = true;
+                shard.probation_bytes -= victim->weight;
+                shard.protected_bytes += victim->weight;
+            }
+            ++skipped;
+        }
+    }
+
+    std::size_t shard_count_;
+    std::unique_ptr<Shard[]> shards_; // NOLINT(cppcoreguidelines-avoid-c-arrays, modernize-avoid-c-arrays)
+    std::size_t capacity_bytes_;
+    std::size_t shard_capacity_;
+    std::size_t protected_capacity_;
+};
+
+} // namespace storage
@@ -1,140 +1,600 @@
 #include "storage_service.hpp"
+#include "log_backend.hpp"
+#include "redis_backend.hpp"
 #include <boost/asio/co_spawn.hpp>
-#include <boost/asio/consign.hpp>
 #include <boost/asio/detached.hpp>
 #include <boost/log/sources/record_ostream.hpp>
 #include <boost/log/trivial.hpp>
-#include <boost/redis/connection.hpp>
-#include <boost/redis/logger.hpp>
-#include <boost/redis/request.hpp>
-#include <boost/redis/response.hpp>
-#include <boost/redis/src.hpp> // Required: include this in exactly one source file
-#include <format>
-#include <string_view>
-
-using namespace std::string_view_literals;
+#include <algorithm>
+#include <exception>
+#include <ranges>
 
 namespace storage
 {
 
-StorageService::StorageService(boost::asio::any_io_executor executor, logging::logger_t logger)
-    : conn_{std::make_shared<boost::redis::connection>(executor)}, logger_{std::move(logger)}
+StorageService::StorageService(boost::asio::any_io_executor executor, logging::logger_t logger,
+                               const conf::Config &config, std::vector<boost::asio::any_io_executor> io_executors)
+    : backend_{make_backend(executor, logger, config, std::move(io_executors))},
+      lookup_filter_{std::make_shared<LookupFilter>(config.negative_cache_ttl())},
+      url_fetches_{std::make_shared<SingleFlight<std::uint64_t, CachedUrl>>()},
+      high_water_refreshes_{std::make_shared<SingleFlight<int, HighWaterRefresh>>()},
+      url_codec_{std::make_shared<const UrlCodec>(config.url_compression())},
+      atomic_create_{config.atomic_create()}, dedup_{config.dedup()},
+      dedup_creates_{std::make_shared<SingleFlight<UrlDigest, CreatedUrl, DigestHash>>()},
+      dedup_counters_{std::make_shared<DedupCounters>()}, health_{std::make_shared<Health>()},
+      logger_{std::move(logger)}
 {
-}
+    id_allocator_ = std::make_shared<IdAllocator>(
+        executor, [backend = backend_](std::uint64_t count) { return backend->reserve_ids(count); },
+        static_cast<std::uint64_t>(config.id_block_size()), logger_);
 
-auto StorageService::connect(std::string_view host, std::string_view port) -> void
-{
-    BOOST_LOG_SEV(logger_, boost::log::trivial::info) << "Connecting to Redis at " << host << ":" << port;
+    if (config.cache_bytes() > 0)
+    {
+        url_cache_ = std::make_shared<UrlCache>(config.cache_bytes(),
+                                                static_cast<std::size_t>(config.threads()) * kCacheShardsPerThread);
+    }
+
+    if (config.redis_client_tracking())
+    {
+        if (url_cache_)
+        {
+            invalidation_epochs_ = std::make_shared<InvalidationEpochs>();
+            if (config.stale_cache_bytes() > 0)
+            {
+                stale_cache_ = std::make_shared<UrlCache>(
+                    config.stale_cache_bytes(), static_cast<std::size_t>(config.threads()) * kCacheShardsPerThread);
+            }
+            backend_->track_invalidations(
+                [target = InvalidationTarget{.backend = backend_,
+                                             .cache = url_cache_,
+                                             .stale_cache = stale_cache_,
+                                             .filter = lookup_filter_,
+                                             .epochs = invalidation_epochs_,
+                                             .codec = url_codec_,
+                                             .executor = executor,
+                                             .warm_entries = static_cast<std::size_t>(config.cache_warm_entries()),
+                                             .logger = logger_}](std::optional<IdRange> ids)
+                { on_invalidated(target, ids); });
+        }
+        else
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+                << "Client tracking has no effect with the redirect cache disabled";
+        }
+    }
 
-    boost::redis::config cfg;
-    cfg.addr.host = host;
-    cfg.addr.port = port;
+    if (!config.cache_snapshot_path().empty())
+    {
+        if (url_cache_)
+        {
+            snapshotter_ = std::make_shared<CacheSnapshotter>(
+                std::filesystem::path{config.cache_snapshot_path()}, config.cache_snapshot_interval(),
+                static_cast<std::size_t>(config.cache_warm_entries()), url_cache_, logger_);
+        }
+        else
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+                << "Cache snapshots have no effect with the redirect cache disabled";
+        }
+    }
+
+    if (config.click_flush_interval().count() > 0)
+    {
+        click_counter_ = std::make_shared<ClickCounter>(
+            executor, [backend = backend_](std::span<const ClickDelta> batch) { return backend->add_clicks(batch); },
+            config.click_flush_interval(), static_cast<std::size_t>(config.threads()), logger_);
+    }
+
+    if (config.hot_links() > 0)
+    {
+        HotLinkTracker::merged_fn_t on_merged;
+        if (config.pin_hot_links() && url_cache_)
+        {
+            // Only the merge coroutine calls it, so the pinned list needs no lock.
+            on_merged = [cache = url_cache_, pinned = std::vector<std::uint64_t>{}](
+                            const std::vector<HotLink> &links) mutable { pin_hot_links(*cache, pinned, links); };
+        }
+        else if (config.pin_hot_links())
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::warning)
+                << "Pinning hot links has no effect with the redirect cache disabled";
+        }
+        hot_links_ = std::make_shared<HotLinkTracker>(executor, static_cast<std::size_t>(config.hot_links()),
+                                                      static_cast<std::size_t>(config.threads()),
+                                                      std::move(on_merged), logger_);
+    }
 
-    // Start the connection (this handles reconnection automatically)
-    conn_->async_run(cfg, boost::redis::logger{boost::redis::logger::level::err},
-                     boost::asio::consign(boost::asio::detached, conn_));
+    if (dedup_ && config.dedup_cache_entries() > 0)
+    {
+        dedup_cache_ = std::make_shared<DedupCache>(
+            static_cast<std::size_t>(config.dedup_cache_entries()) * DigestWeigher::kEntryOverhead,
+            static_cast<std::size_t>(config.threads()) * kCacheShardsPerThread);
+    }
 }
 
-auto StorageService::generate_next_id() const -> boost::asio::awaitable<std::uint64_t>
+auto StorageService::make_backend(const boost::asio::any_io_executor &executor, const logging::logger_t &logger,
+                                  const conf::Config &config, std::vector<boost::asio::any_io_executor> io_executors)
+    -> std::shared_ptr<Backend>
 {
-    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Generating next ID from Redis";
+    if (config.storage_backend() == "log")
+    {
+        return std::make_shared<LogBackend>(logger, config);
+    }
+    return std::make_shared<RedisBackend>(executor, logger, config, std::move(io_executors));
+}
 
-    boost::redis::request req;
-    req.push("INCR"sv, kCounterKey);
+auto StorageService::start() -> void
+{
+    BOOST_LOG_SEV(logger_, boost::log::trivial::info) << "Starting " << backend_->name() << " storage backend";
 
-    boost::redis::response<long long> resp;
-    co_await conn_->async_exec(req, resp, boost::asio::use_awaitable);
+    backend_->start();
 
-    const auto &result = std::get<0>(resp);
-    if (!result.has_value())
+    // Before the server accepts connections, so the first redirects are already served from memory.
+    if (snapshotter_)
     {
-        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << "Redis INCR command returned unexpected response";
-        throw std::runtime_error("Redis INCR command returned unexpected response");
+        snapshotter_->restore();
+        snapshotter_->start();
     }
 
-    const auto id = static_cast<std::uint64_t>(result.value());
+    if (click_counter_)
+    {
+        click_counter_->start();
+    }
+
+    if (hot_links_)
+    {
+        hot_links_->start();
+    }
+}
+
+auto StorageService::generate_next_id() const -> boost::asio::awaitable<std::uint64_t>
+{
+    const auto id = co_await id_allocator_->next();
 
     BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Generated ID: " << id;
 
     co_return id;
 }
 
-auto StorageService::store_url(std::uint64_t id, std::string_view url) const -> boost::asio::awaitable<void>
+auto StorageService::reserve_ids(std::uint64_t count) const -> boost::asio::awaitable<std::uint64_t>
 {
-    const auto key = std::format("{}{}"sv, kUrlPrefix, id);
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Reserving " << count << " IDs";
+
+    const auto first = co_await backend_->reserve_ids(count);
+
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug)
+        << "Reserved IDs [" << first << ", " << first + count << ")";
 
+    co_return first;
+}
+
+auto StorageService::store_url(std::uint64_t id, std::string_view url) const -> boost::asio::awaitable<void>
+{
     BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Storing URL for ID " << id << ": " << url;
 
-    boost::redis::request req;
-    req.push("SET"sv, key, url);
+    co_await backend_->store_url(id, url_codec_->encode(url));
+    on_stored(id);
+
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Successfully stored URL for ID " << id;
+}
+
+auto StorageService::create_url(std::string_view url) const -> boost::asio::awaitable<std::uint64_t>
+{
+    std::uint64_t id = 0;
+    try
+    {
+        if (atomic_create_)
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Creating URL atomically: " << url;
+            id = co_await backend_->create_url(url_codec_->encode(url));
+            on_stored(id);
+            BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Created URL with ID " << id;
+        }
+        else
+        {
+            id = co_await generate_next_id();
+            co_await store_url(id, url);
+        }
+    }
+    catch (const std::exception &)
+    {
+        rethrow_unavailable();
+    }
+
+    on_backend_result(true);
+    co_return id;
+}
 
-    boost::redis::response<std::string> resp;
-    co_await conn_->async_exec(req, resp, boost::asio::use_awaitable);
+auto StorageService::create_urls(std::span<const std::string> urls) const -> boost::asio::awaitable<std::uint64_t>
+{
+    std::vector<std::string> values;
+    values.reserve(urls.size());
+    for (const auto &url : urls)
+    {
+        values.push_back(url_codec_->encode(url));
+    }
 
-    // Redis SET returns "OK" on success
-    const auto &result = std::get<0>(resp);
-    if (!result.has_value())
+    std::uint64_t first = 0;
+    try
     {
-        BOOST_LOG_SEV(logger_, boost::log::trivial::error)
-            << "Redis SET command returned unexpected response for ID " << id;
-        throw std::runtime_error("Redis SET command returned unexpected response");
+        first = co_await reserve_ids(urls.size());
+        co_await backend_->store_urls(first, values);
     }
+    catch (const std::exception &)
+    {
+        rethrow_unavailable();
+    }
+    on_backend_result(true);
 
-    if (result.value() != "OK"sv)
+    for (auto id = first; id < first + urls.size(); ++id)
     {
-        const auto error_msg = std::format("Redis SET command failed: {}", result.value());
-        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << error_msg;
-        throw std::runtime_error(error_msg);
+        lookup_filter_->forget_missing(id);
     }
+    lookup_filter_->observe(first + urls.size() - 1);
 
-    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Successfully stored URL for ID " << id;
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug)
+        << "Created " << urls.size() << " URLs with IDs [" << first << ", " << first + urls.size() << ")";
+
+    co_return first;
+}
+
+auto StorageService::find_or_create_url(std::string_view url) const -> boost::asio::awaitable<CreatedUrl>
+{
+    if (!dedup_)
+    {
+        co_return CreatedUrl{.id = co_await create_url(url), .created = true};
+    }
+
+    const auto digest = digest_url(url);
+    if (dedup_cache_)
+    {
+        if (const auto id = dedup_cache_->get(digest))
+        {
+            dedup_counters_->local_hits.fetch_add(1, std::memory_order_relaxed);
+            BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Local dedup hit for ID " << *id << ": " << url;
+            co_return CreatedUrl{.id = *id, .created = false};
+        }
+    }
+
+    // Coalesced callers did not create the link themselves, whatever the leader's outcome.
+    bool leader = false;
+    auto result = co_await dedup_creates_->run(digest,
+                                               [this, digest, url, &leader]
+                                               {
+                                                   leader = true;
+                                                   return create_deduplicated(digest, url);
+                                               });
+    if (!leader)
+    {
+        dedup_counters_->local_hits.fetch_add(1, std::memory_order_relaxed);
+        result.created = false;
+    }
+    co_return result;
+}
+
+auto StorageService::create_deduplicated(UrlDigest digest, std::string_view url) const
+    -> boost::asio::awaitable<CreatedUrl>
+{
+    CreatedUrl result{};
+    try
+    {
+        result = co_await backend_->find_or_create_url(to_hex(digest), url_codec_->encode(url));
+    }
+    catch (const std::exception &)
+    {
+        rethrow_unavailable();
+    }
+    on_backend_result(true);
+
+    if (result.created)
+    {
+        on_stored(result.id);
+        dedup_counters_->created.fetch_add(1, std::memory_order_relaxed);
+        BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Created URL with ID " << result.id;
+    }
+    else
+    {
+        lookup_filter_->observe(result.id);
+        dedup_counters_->remote_hits.fetch_add(1, std::memory_order_relaxed);
+        BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Reused ID " << result.id << " for " << url;
+    }
+
+    if (dedup_cache_)
+    {
+        dedup_cache_->put(digest, result.id);
+    }
+    co_return result;
+}
+
+void StorageService::on_stored(std::uint64_t id) const
+{
+    lookup_filter_->observe(id);
+    lookup_filter_->forget_missing(id);
+}
+
+void StorageService::on_invalidated(const InvalidationTarget &target, std::optional<IdRange> ids)
+{
+    // Bump the epochs first so that a lookup already past the cache cannot insert the old value.
+    target.epochs->invalidate(ids);
+
+    if (!ids)
+    {
+        // The dropped links stay available, as stale, in case storage fails before they are re-read.
+        std::vector<std::uint64_t> hottest;
+        if (target.warm_entries > 0)
+        {
+            const auto entries = target.cache->hottest(target.warm_entries);
+            for (const auto &[id, url] : entries | std::views::reverse)
+            {
+                if (target.stale_cache)
+                {
+                    target.stale_cache->put(id, url);
+                }
+            }
+            for (const auto &entry : entries)
+            {
+                hottest.push_back(entry.first);
+            }
+        }
+
+        target.cache->clear();
+        if (!hottest.empty())
+        {
+            boost::asio::co_spawn(target.executor, rewarm(target, std::move(hottest)), boost::asio::detached);
+        }
+        return;
+    }
+
+    // Count the IDs instead of comparing against `last`, which may be the largest ID there is.
+    const auto count = ids->last - ids->first + 1;
+    for (std::uint64_t i = 0; i < count; ++i)
+    {
+        const auto id = ids->first + i;
+        target.cache->erase(id);
+        if (target.stale_cache)
+        {
+            target.stale_cache->erase(id);
+        }
+        target.filter->forget_missing(id);
+    }
+}
+
+void StorageService::pin_hot_links(UrlCache &cache, std::vector<std::uint64_t> &pinned,
+                                   const std::vector<HotLink> &links)
+{
+    // Links not cached yet are retried with the next top list.
+    std::vector<std::uint64_t> now_pinned;
+    now_pinned.reserve(links.size());
+    for (const auto &link : links)
+    {
+        if (cache.pin(link.id))
+        {
+            now_pinned.push_back(link.id);
+        }
+    }
+
+    std::ranges::sort(now_pinned);
+    for (const auto id : pinned)
+    {
+        if (!std::ranges::binary_search(now_pinned, id))
+        {
+            cache.unpin(id);
+        }
+    }
+    pinned = std::move(now_pinned);
+}
+
+auto StorageService::rewarm(InvalidationTarget target, std::vector<std::uint64_t> ids) -> boost::asio::awaitable<void>
+{
+    const auto backend = target.backend.lock();
+    if (!backend)
+    {
+        co_return;
+    }
+
+    std::vector<std::uint64_t> epochs;
+    epochs.reserve(ids.size());
+    for (const auto id : ids)
+    {
+        epochs.push_back(target.epochs->epoch(id));
+    }
+
+    try
+    {
+        auto urls = co_await backend->get_urls(ids);
+
+        // Coldest first, so the hottest links end up most recently used.
+        std::size_t warmed = 0;
+        for (auto i = ids.size(); i-- > 0;)
+        {
+            if (urls[i].has_value() && target.epochs->epoch(ids[i]) == epochs[i])
+            {
+                target.cache->put(ids[i], make_cached_url(target.codec->decode(std::move(urls[i].value()))));
+                ++warmed;
+            }
+        }
+
+        BOOST_LOG_SEV(target.logger, boost::log::trivial::info)
+            << "Re-read " << warmed << " of the " << ids.size() << " hottest links after a cache flush";
+    }
+    catch (const std::exception &e)
+    {
+        BOOST_LOG_SEV(target.logger, boost::log::trivial::warning)
+            << "Re-reading the hottest links after a cache flush failed: " << e.what();
+    }
 }
 
 auto StorageService::get_url(std::uint64_t id) const -> boost::asio::awaitable<std::optional<std::string>>
 {
-    const auto key = std::format("{}{}"sv, kUrlPrefix, id);
+    const auto result = co_await lookup_url(id);
+    if (!result.url)
+    {
+        co_return std::nullopt;
+    }
+    co_return *result.url;
+}
 
-    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Retrieving URL for ID " << id;
+auto StorageService::lookup_url(std::uint64_t id) const -> boost::asio::awaitable<UrlLookup>
+{
+    if (auto cached = cached_url(id))
+    {
+        co_return UrlLookup{.url = std::move(cached)};
+    }
 
-    boost::redis::request req;
-    req.push("GET"sv, key);
+    const auto arrived = std::chrono::steady_clock::now();
+    CachedUrl url;
+    try
+    {
+        // IDs above the counter were never issued, but the local mark lags behind links created elsewhere.
+        const bool above = id > lookup_filter_->high_water() && co_await confirm_above_high_water(id, arrived);
 
-    boost::redis::response<std::string> resp;
-    co_await conn_->async_exec(req, resp, boost::asio::use_awaitable);
+        if ((above && lookup_filter_->above_high_water(id)) || lookup_filter_->is_known_missing(id))
+        {
+            BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Rejected lookup for unknown ID " << id;
+            co_return UrlLookup{};
+        }
 
-    const auto &result = std::get<0>(resp);
-    if (result.has_value())
+        url = co_await url_fetches_->run(id, [this, id] { return fetch_url(id); });
+    }
+    catch (const std::exception &e)
     {
-        BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Found URL for ID " << id << ": " << result.value();
-        co_return std::make_optional(result.value());
+        if (stale_cache_)
+        {
+            if (auto stale = stale_cache_->get(id))
+            {
+                on_backend_result(false);
+                health_->stale_hits.fetch_add(1, std::memory_order_relaxed);
+                BOOST_LOG_SEV(logger_, boost::log::trivial::debug)
+                    << "Serving stale URL for ID " << id << " (storage failed: " << e.what() << ")";
+                co_return UrlLookup{.url = std::move(*stale), .stale = true};
+            }
+        }
+        rethrow_unavailable();
     }
 
-    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "No URL found for ID " << id;
-    co_return std::nullopt;
+    on_backend_result(true);
+    co_return UrlLookup{.url = std::move(url)};
 }
 
-auto StorageService::exists(std::uint64_t id) const -> boost::asio::awaitable<bool>
+void StorageService::on_backend_result(bool ok) const noexcept
 {
-    const auto key = std::format("{}{}"sv, kUrlPrefix, id);
+    if (ok)
+    {
+        if (health_->degraded.load(std::memory_order_relaxed))
+        {
+            health_->degraded.store(false, std::memory_order_relaxed);
+        }
+        return;
+    }
 
-    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Checking existence for ID " << id;
+    health_->failed_ops.fetch_add(1, std::memory_order_relaxed);
+    health_->last_failure.store(std::chrono::steady_clock::now().time_since_epoch().count(),
+                                std::memory_order_relaxed);
+    if (!health_->degraded.exchange(true, std::memory_order_relaxed))
+    {
+        health_->episodes.fetch_add(1, std::memory_order_relaxed);
+    }
+}
 
-    boost::redis::request req;
-    req.push("EXISTS"sv, key);
+void StorageService::rethrow_unavailable() const
+{
+    on_backend_result(false);
+    try
+    {
+        throw;
+    }
+    catch (const BackendUnavailable &)
+    {
+        throw;
+    }
+    catch (const std::exception &e)
+    {
+        // Connection errors and unexpected replies alike: storage cannot answer right now.
+        BOOST_LOG_SEV(logger_, boost::log::trivial::warning) << "Storage operation failed: " << e.what();
+        throw BackendUnavailable{e.what(), kUnavailableRetryAfter};
+    }
+}
+
+auto StorageService::fetch_url(std::uint64_t id) const -> boost::asio::awaitable<CachedUrl>
+{
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Retrieving URL for ID " << id;
 
-    boost::redis::response<long long> resp;
-    co_await conn_->async_exec(req, resp, boost::asio::use_awaitable);
+    const auto epoch = invalidation_epochs_ ? invalidation_epochs_->epoch(id) : 0;
+    auto stored = co_await backend_->get_url(id);
 
-    const auto &result = std::get<0>(resp);
-    if (!result.has_value())
+    if (stored.has_value())
     {
-        BOOST_LOG_SEV(logger_, boost::log::trivial::error)
-            << "Redis EXISTS command returned unexpected response for ID " << id;
-        throw std::runtime_error("Redis EXISTS command returned unexpected response");
+        auto url = make_cached_url(url_codec_->decode(std::move(stored.value())));
+        BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Found URL for ID " << id << ": " << *url;
+        if (url_cache_ && (!invalidation_epochs_ || invalidation_epochs_->epoch(id) == epoch))
+        {
+            url_cache_->put(id, url);
+        }
+        co_return url;
     }
 
-    // Redis EXISTS returns 1 if key exists, 0 if not
-    const bool exists = result.value() == 1;
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "No URL found for ID " << id;
+    lookup_filter_->add_missing(id);
+    co_return nullptr;
+}
+
+auto StorageService::cached_url(std::uint64_t id) const -> CachedUrl
+{
+    if (!url_cache_)
+    {
+        return nullptr;
+    }
+    auto cached = url_cache_->get(id);
+    if (!cached)
+    {
+        return nullptr;
+    }
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Cache hit for ID " << id;
+    return std::move(*cached);
+}
+
+void StorageService::record_click(std::uint64_t id) const
+{
+    if (click_counter_)
+    {
+        click_counter_->record(id);
+    }
+    if (hot_links_)
+    {
+        hot_links_->record(id);
+    }
+}
+
+auto StorageService::click_counts(std::span<const std::uint64_t> ids) const
+    -> boost::asio::awaitable<std::vector<std::uint64_t>>
+{
+    std::vector<std::uint64_t> clicks;
+    try
+    {
+        clicks = co_await backend_->get_clicks(ids);
+    }
+    catch (const std::exception &)
+    {
+        rethrow_unavailable();
+    }
+    on_backend_result(true);
+
+    if (click_counter_)
+    {
+        const auto pending = click_counter_->pending(ids);
+        for (std::size_t i = 0; i < clicks.size(); ++i)
+        {
+            clicks[i] += pending[i];
+        }
+    }
+    co_return clicks;
+}
+
+auto StorageService::exists(std::uint64_t id) const -> boost::asio::awaitable<bool>
+{
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Checking existence for ID " << id;
+
+    const bool exists = co_await backend_->exists(id);
 
     BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "ID " << id << (exists ? " exists" : " does not exist");
 
@@ -143,27 +603,162 @@ auto StorageService::exists(std::uint64_t id) const -> boost::asio::awaitable<bo
 
 auto StorageService::ping() const -> boost::asio::awaitable<bool>
 {
-    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Pinging Redis server";
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "Pinging " << backend_->name() << " storage backend";
 
-    boost::redis::request req;
-    req.push("PING"sv);
+    const bool success = co_await backend_->ping();
+    if (success)
+    {
+        on_backend_result(true);
+    }
 
-    boost::redis::response<std::string> resp;
-    co_await conn_->async_exec(req, resp, boost::asio::use_awaitable);
+    BOOST_LOG_SEV(logger_, boost::log::trivial::info)
+        << backend_->name() << " storage ping " << (success ? "successful" : "failed");
 
-    // Redis PING returns "PONG"
-    const auto &result = std::get<0>(resp);
-    if (!result.has_value())
+    co_return success;
+}
+
+auto StorageService::confirm_above_high_water(std::uint64_t id, std::chrono::steady_clock::time_point arrived) const
+    -> boost::asio::awaitable<bool>
+{
+    // A refresh already in flight may have read the counter before the link was created, so it only settles
+    // the question if it started after the lookup arrived; otherwise wait for the next one. When refreshes are
+    // rate-limited, storage answers instead.
+    while (id > lookup_filter_->high_water())
     {
-        BOOST_LOG_SEV(logger_, boost::log::trivial::error) << "Redis PING command returned unexpected response";
-        throw std::runtime_error("Redis PING command returned unexpected response");
+        const auto refresh = co_await high_water_refreshes_->run(0, [this] { return refresh_high_water(); });
+        if (!refresh.refreshed)
+        {
+            co_return false;
+        }
+        if (refresh.started >= arrived)
+        {
+            co_return id > lookup_filter_->high_water();
+        }
+    }
+    co_return false;
+}
+
+auto StorageService::refresh_high_water() const -> boost::asio::awaitable<HighWaterRefresh>
+{
+    if (!lookup_filter_->try_begin_refresh())
+    {
+        co_return HighWaterRefresh{};
     }
 
-    const bool success = result.value() == "PONG"sv;
+    const auto started = std::chrono::steady_clock::now();
+    const auto high_water = co_await backend_->high_water();
+    lookup_filter_->observe(high_water);
 
-    BOOST_LOG_SEV(logger_, boost::log::trivial::info) << "Redis ping " << (success ? "successful" : "failed");
+    BOOST_LOG_SEV(logger_, boost::log::trivial::debug) << "ID high-water mark refreshed: " << high_water;
+    co_return HighWaterRefresh{.refreshed = true, .started = started};
+}
 
-    co_return success;
+auto StorageService::click_stats() const -> ClickStats
+{
+    if (!click_counter_)
+    {
+        return ClickStats{};
+    }
+    return click_counter_->stats();
+}
+
+auto StorageService::hot_links() const -> std::vector<HotLink>
+{
+    if (!hot_links_)
+    {
+        return {};
+    }
+    return hot_links_->top();
+}
+
+auto StorageService::hot_link_stats() const -> HotLinkStats
+{
+    if (!hot_links_)
+    {
+        return HotLinkStats{};
+    }
+    return hot_links_->stats();
+}
+
+auto StorageService::degraded() const noexcept -> bool
+{
+    if (!health_->degraded.load(std::memory_order_relaxed))
+    {
+        return false;
+    }
+
+    const std::chrono::steady_clock::time_point last_failure{
+        std::chrono::steady_clock::duration{health_->last_failure.load(std::memory_order_relaxed)}};
+    if (std::chrono::steady_clock::now() - last_failure < kDegradedHold)
+    {
+        return true;
+    }
+    health_->degraded.store(false, std::memory_order_relaxed);
+    return false;
+}
+
+auto StorageService::degraded_stats() const -> DegradedStats
+{
+    return DegradedStats{
+        .active = degraded(),
+        .episodes = health_->episodes.load(std::memory_order_relaxed),
+        .failed_ops = health_->failed_ops.load(std::memory_order_relaxed),
+        .stale_hits = health_->stale_hits.load(std::memory_order_relaxed),
+        .stale_entries = stale_cache_ ? stale_cache_->stats().entries : 0,
+    };
+}
+
+auto StorageService::backend_name() const -> std::string_view
+{
+    return backend_->name();
+}
+
+auto StorageService::cache_stats() const -> CacheStats
+{
+    if (!url_cache_)
+    {
+        return CacheStats{};
+    }
+    return url_cache_->stats();
+}
+
+auto StorageService::lookup_filter_stats() const -> LookupFilterStats
+{
+    return lookup_filter_->stats();
+}
+
+auto StorageService::lookup_coalescing_stats() const -> SingleFlightStats
+{
+    return url_fetches_->stats();
+}
+
+auto StorageService::shard_stats() const -> std::vector<ShardStats>
+{
+    return backend_->shard_stats();
+}
+
+auto StorageService::lookup_batching_stats() const -> GetBatcherStats
+{
+    return backend_->batching_stats();
+}
+
+auto StorageService::url_codec_stats() const -> UrlCodecStats
+{
+    return url_codec_->stats();
+}
+
+auto StorageService::invalidation_stats() const -> InvalidationStats
+{
+    return backend_->invalidation_stats();
+}
+
+auto StorageService::dedup_stats() const -> DedupStats
+{
+    return DedupStats{
+        .local_hits = dedup_counters_->local_hits.load(std::memory_order_relaxed),
+        .remote_hits = dedup_counters_->remote_hits.load(std::memory_order_relaxed),
+        .created = dedup_counters_->created.load(std::memory_order_relaxed),
+    };
 }
 
 } // namespace storage
\ No newline at end of file
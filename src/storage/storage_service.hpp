@@ -1,27 +1,84 @@
 #pragma once
 
+#include "backend.hpp"
+#include "cache_snapshot.hpp"
+#include "click_counter.hpp"
+#include "conf/conf.hpp"
+#include "connection_pool.hpp"
+#include "get_batcher.hpp"
+#include "hot_links.hpp"
+#include "id_allocator.hpp"
 #include "logging/logger_setup.hpp"
+#include "lookup_filter.hpp"
+#include "single_flight.hpp"
+#include "url_cache.hpp"
+#include "url_codec.hpp"
+#include "url_dedup.hpp"
 #include <boost/asio/any_io_executor.hpp>
 #include <boost/asio/awaitable.hpp>
 #include <boost/log/sources/severity_logger.hpp>
 #include <boost/log/trivial.hpp>
-#include <boost/redis/connection.hpp>
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <memory>
 #include <optional>
+#include <span>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace storage
 {
 
+/**
+ * @brief Result of StorageService::lookup_url().
+ */
+struct UrlLookup
+{
+    CachedUrl url;     ///< The URL (shared with the cache), or null if the ID has none.
+    bool stale{false}; ///< Whether the URL was served from the stale cache because storage failed.
+};
+
+/**
+ * @brief Counters of degraded operation (storage failing while the service keeps answering).
+ */
+struct DegradedStats
+{
+    bool active{false};             ///< Whether storage is failing (see StorageService::degraded()).
+    std::uint64_t episodes{0};      ///< Times storage went from healthy to failing.
+    std::uint64_t failed_ops{0};    ///< Lookups and creates that failed in storage.
+    std::uint64_t stale_hits{0};    ///< Failed lookups answered from the stale cache.
+    std::uint64_t stale_entries{0}; ///< URLs currently held by the stale cache.
+};
+
 /**
  * @brief Pure storage service for URL shortener.
  *
- * This service provides basic storage operations:
- * - Generate incremented integer IDs
+ * A facade over a pluggable Backend (Redis or the embedded log store) that
+ * provides basic storage operations:
+ * - Generate incremented integer IDs (leased from the backend in blocks)
  * - Store URL mappings with integer keys
- * - Retrieve URLs by integer keys
+ * - Create links (ID + mapping) atomically in one backend operation
+ * - Retrieve URLs by integer keys (served from an in-process cache when hot)
+ * - Reject lookups for IDs that cannot exist without a backend round trip
+ * - Coalesce concurrent lookups for the same ID into one backend read
+ * - Optionally compress stored URLs with a shared dictionary (see UrlCodec)
+ * - Optionally return the existing link when the same URL is submitted again
+ * - Optionally keep the cache coherent with writes by other clients, using
+ *   Redis client-side caching invalidations (see InvalidationTracker)
+ * - Optionally keep the cache's hot set warm across restarts and tracking
+ *   flushes (see CacheSnapshotter)
+ * - Count clicks per link in memory and add them to storage in batches
+ *   (see ClickCounter)
+ * - Track the most requested links and optionally pin them in the cache
+ *   (see HotLinkTracker)
+ * - Keep serving redirects while storage is failing: links dropped by a
+ *   tracking flush move to a stale cache that answers lookups storage cannot
+ *   (see lookup_url() and degraded())
+ *
+ * The Redis backend additionally shards links across nodes, pools
+ * connections and can batch lookups into MGETs; see RedisBackend.
  *
  * No encoding/decoding logic - that's handled by higher layers.
  * Methods throw exceptions on errors - callers should handle appropriately.
@@ -31,29 +88,52 @@ class StorageService
   public:
     /**
      * @brief Constructs the storage service.
-     * @param executor The asio executor the connection will use to run.
-     * @param logger Logger for Redis operations (passed by value, moved for efficiency).
+     * @param executor The asio executor the backend and ID allocator will use to run.
+     * @param logger Logger for storage operations (passed by value, moved for efficiency).
+     * @param config The application configuration (storage backend and its options, ID block size,
+     *               cache capacity, negative cache TTL, atomic creates, URL compression, deduplication,
+     *               client tracking, cache snapshots, stale cache, click counting, hot links).
+     * @param io_executors Executors of the io_contexts; in thread-per-core mode, Redis connection i
+     *                     runs on io thread i (empty: everything runs on `executor`).
      */
-    explicit StorageService(boost::asio::any_io_executor executor, logging::logger_t logger);
+    explicit StorageService(boost::asio::any_io_executor executor, logging::logger_t logger,
+                            const conf::Config &config, std::vector<boost::asio::any_io_executor> io_executors = {});
 
     /**
-     * @brief Connect to Redis server.
+     * @brief Start the storage backend.
+     *
+     * Connects to Redis (each pooled connection reconnects independently) or
+     * opens and recovers the embedded log store, then restores the redirect
+     * cache from its snapshot, if configured, and starts flushing click counts
+     * and merging hot link sketches.
      *
-     * @param host Redis server host
-     * @param port Redis server port
+     * @throws std::exception if the log store cannot be opened
      */
-    void connect(std::string_view host, std::string_view port);
+    void start();
 
     /**
-     * @brief Generate next incremented ID for a new URL.
+     * @brief Generate next unique ID for a new URL.
      *
-     * Uses Redis INCR command to atomically increment a counter.
+     * IDs are served from blocks leased from the backend (see IdAllocator), so
+     * most calls complete without a backend round trip. IDs are unique and increasing
+     * per lease, but not gap-free.
      *
      * @return The next available ID
      * @throws std::exception on any error
      */
     [[nodiscard]] auto generate_next_id() const -> boost::asio::awaitable<std::uint64_t>;
 
+    /**
+     * @brief Reserve a contiguous range of IDs directly from the backend counter.
+     *
+     * Atomically advances the counter by `count` (INCRBY on Redis).
+     *
+     * @param count Number of IDs to reserve (must be positive)
+     * @return The first ID of the reserved range [first, first + count)
+     * @throws std::exception on any error
+     */
+    [[nodiscard]] auto reserve_ids(std::uint64_t count) const -> boost::asio::awaitable<std::uint64_t>;
+
     /**
      * @brief Store URL mapping with the given ID.
      *
@@ -63,15 +143,105 @@ class StorageService
      */
     [[nodiscard]] auto store_url(std::uint64_t id, std::string_view url) const -> boost::asio::awaitable<void>;
 
+    /**
+     * @brief Allocate a new ID and store the URL under it.
+     *
+     * With atomic creates enabled, this is a single backend operation (one
+     * EVALSHA round trip on Redis) that issues the ID and writes the mapping,
+     * so a crash can never leave an allocated but unwritten ID behind.
+     * Otherwise it is generate_next_id() followed by store_url().
+     *
+     * @param url The long URL to store
+     * @return The ID the URL was stored under
+     * @throws std::exception on any error
+     */
+    [[nodiscard]] auto create_url(std::string_view url) const -> boost::asio::awaitable<std::uint64_t>;
+
+    /**
+     * @brief Create links for many URLs at once.
+     *
+     * Reserves one contiguous ID range for all of them (a single INCRBY on
+     * Redis) and writes the mappings in pipelined requests, so the cost per
+     * link is a fraction of create_url(). Links are not deduplicated.
+     *
+     * @param urls The long URLs to store (must not be empty)
+     * @return The ID of `urls[0]`; `urls[i]` is stored under the returned ID + i
+     * @throws std::exception on any error
+     */
+    [[nodiscard]] auto create_urls(std::span<const std::string> urls) const -> boost::asio::awaitable<std::uint64_t>;
+
+    /**
+     * @brief Return the link already created for `url`, or create one.
+     *
+     * With deduplication enabled, URLs are identified by the SHA-256 digest of
+     * their normalized form (see normalize_url()). Recently created digests are
+     * answered from a local cache; concurrent creates of the same URL share one
+     * backend operation, which checks the backend's reverse index and inserts
+     * atomically (one EVALSHA round trip on a single Redis node). Otherwise
+     * this is create_url().
+     *
+     * @param url The long URL to store
+     * @return The link's ID and whether it was newly created
+     * @throws std::exception on any error
+     */
+    [[nodiscard]] auto find_or_create_url(std::string_view url) const -> boost::asio::awaitable<CreatedUrl>;
+
     /**
      * @brief Retrieve URL by ID.
      *
+     * Looks the ID up in the in-process cache first. IDs above the counter's
+     * high-water mark or recently found missing are rejected without a backend
+     * round trip; everything else is read from the backend and found URLs are
+     * cached. Concurrent lookups for the same ID share a single backend read.
+     *
      * @param id The unique identifier to look up
      * @return The URL if found, nullopt if not found
-     * @throws std::exception on any error
+     * @throws BackendUnavailable if storage fails and the stale cache has no URL for `id`
      */
     [[nodiscard]] auto get_url(std::uint64_t id) const -> boost::asio::awaitable<std::optional<std::string>>;
 
+    /**
+     * @brief Retrieve URL by ID, telling whether it is stale.
+     *
+     * Like get_url(), but if storage fails, the URL last known for `id` is
+     * returned from the stale cache (marked stale) instead of failing. Cached
+     * URLs are returned by reference count, without copying the string.
+     *
+     * @param id The unique identifier to look up
+     * @return The URL (null if not found) and whether it is stale
+     * @throws BackendUnavailable if storage fails and the stale cache has no URL for `id`
+     */
+    [[nodiscard]] auto lookup_url(std::uint64_t id) const -> boost::asio::awaitable<UrlLookup>;
+
+    /**
+     * @brief Get the URL of `id` if the in-process cache holds it.
+     *
+     * Never suspends, so the redirect handler answers cache hits without
+     * nesting another coroutine frame (see lookup_url() for the full path).
+     *
+     * @param id The unique identifier to look up
+     * @return The cached URL, or null on a miss (or if the cache is disabled)
+     */
+    [[nodiscard]] auto cached_url(std::uint64_t id) const -> CachedUrl;
+
+    /**
+     * @brief Count a click (a served redirect) on `id`.
+     *
+     * Only touches the calling thread's in-memory shard of the click counter
+     * and hot link sketch; the count reaches storage with the next flush.
+     */
+    void record_click(std::uint64_t id) const;
+
+    /**
+     * @brief Get the click totals of `ids`, including clicks not flushed yet.
+     *
+     * @param ids The links to read
+     * @return The totals, indexed like `ids`
+     * @throws BackendUnavailable if storage fails
+     */
+    [[nodiscard]] auto click_counts(std::span<const std::uint64_t> ids) const
+        -> boost::asio::awaitable<std::vector<std::uint64_t>>;
+
     /**
      * @brief Check if an ID exists in storage.
      *
@@ -82,23 +252,248 @@ class StorageService
     [[nodiscard]] auto exists(std::uint64_t id) const -> boost::asio::awaitable<bool>;
 
     /**
-     * @brief Test Redis connectivity with a PING command.
+     * @brief Test backend health (a PING command on Redis).
      *
-     * @return true if Redis responds correctly
+     * @return true if the backend responds correctly
      * @throws std::exception on any error
      */
     [[nodiscard]] auto ping() const -> boost::asio::awaitable<bool>;
 
+    /**
+     * @brief Get the counters of click counting.
+     *
+     * @return Click statistics (all zero if click counting is disabled)
+     */
+    [[nodiscard]] auto click_stats() const -> ClickStats;
+
+    /**
+     * @brief Get the most requested links of the last hot link merge.
+     *
+     * @return Up to --hot-links links, hottest first (empty if tracking is disabled)
+     */
+    [[nodiscard]] auto hot_links() const -> std::vector<HotLink>;
+
+    /**
+     * @brief Get the counters of hot link tracking.
+     *
+     * @return Hot link statistics (all zero if tracking is disabled)
+     */
+    [[nodiscard]] auto hot_link_stats() const -> HotLinkStats;
+
+    /**
+     * @brief Check whether storage is failing (the last lookup or create against it threw).
+     *
+     * Handlers use it to mark their responses while degraded. A successful
+     * storage call or ping ends the episode, and so does kDegradedHold without
+     * a failure: cache hits never call storage, so without it the flag would
+     * stick while only cached links are requested.
+     */
+    [[nodiscard]] auto degraded() const noexcept -> bool;
+
+    /**
+     * @brief Get the counters of degraded operation.
+     *
+     * @return Degraded-mode statistics
+     */
+    [[nodiscard]] auto degraded_stats() const -> DegradedStats;
+
+    /**
+     * @brief Get the name of the storage backend ("redis" or "log").
+     */
+    [[nodiscard]] auto backend_name() const -> std::string_view;
+
+    /**
+     * @brief Get the redirect cache counters.
+     *
+     * @return Cache statistics (all zero if the cache is disabled)
+     */
+    [[nodiscard]] auto cache_stats() const -> CacheStats;
+
+    /**
+     * @brief Get the counters of lookups rejected without a backend round trip.
+     *
+     * @return Lookup filter statistics
+     */
+    [[nodiscard]] auto lookup_filter_stats() const -> LookupFilterStats;
+
+    /**
+     * @brief Get the counters of coalesced lookups.
+     *
+     * @return Single-flight statistics for get_url
+     */
+    [[nodiscard]] auto lookup_coalescing_stats() const -> SingleFlightStats;
+
+    /**
+     * @brief Get the counters of every Redis shard and its pooled connections.
+     *
+     * @return Per-shard statistics (empty for the log store)
+     */
+    [[nodiscard]] auto shard_stats() const -> std::vector<ShardStats>;
+
+    /**
+     * @brief Get the counters of batched lookups.
+     *
+     * @return MGET batching statistics (all zero if batching is disabled)
+     */
+    [[nodiscard]] auto lookup_batching_stats() const -> GetBatcherStats;
+
+    /**
+     * @brief Get the counters of compressed URLs.
+     *
+     * @return URL compression statistics (all zero if compression is disabled)
+     */
+    [[nodiscard]] auto url_codec_stats() const -> UrlCodecStats;
+
+    /**
+     * @brief Get the counters of deduplicated creates.
+     *
+     * @return Deduplication statistics (all zero if deduplication is disabled)
+     */
+    [[nodiscard]] auto dedup_stats() const -> DedupStats;
+
+    /**
+     * @brief Get the counters of cache invalidations received from the backend.
+     *
+     * @return Invalidation statistics (all zero if client tracking is disabled)
+     */
+    [[nodiscard]] auto invalidation_stats() const -> InvalidationStats;
+
   private:
-    /// @brief The Redis connection instance
-    std::shared_ptr<boost::redis::connection> conn_;
+    // Creates the backend selected by --storage-backend.
+    [[nodiscard]] static auto make_backend(const boost::asio::any_io_executor &executor,
+                                           const logging::logger_t &logger, const conf::Config &config,
+                                           std::vector<boost::asio::any_io_executor> io_executors)
+        -> std::shared_ptr<Backend>;
+
+    // Records a stored ID in the lookup filter so it is no longer rejected.
+    void on_stored(std::uint64_t id) const;
+
+    // What the invalidation handler updates. The backend owns the handler, so it is only referenced weakly.
+    struct InvalidationTarget
+    {
+        std::weak_ptr<Backend> backend;
+        std::shared_ptr<UrlCache> cache;
+        std::shared_ptr<UrlCache> stale_cache;
+        std::shared_ptr<LookupFilter> filter;
+        std::shared_ptr<InvalidationEpochs> epochs;
+        std::shared_ptr<const UrlCodec> codec;
+        boost::asio::any_io_executor executor;
+        std::size_t warm_entries;
+        logging::logger_t logger;
+    };
+
+    // Evicts invalidated IDs from the caches and the negative filter. On a flush (nullopt) the
+    // cache is cleared, its hottest links move to the stale cache and are re-read in the background.
+    static void on_invalidated(const InvalidationTarget &target, std::optional<IdRange> ids);
+
+    // Reads `ids` from the backend in bulk and caches the URLs not invalidated in the meantime.
+    [[nodiscard]] static auto rewarm(InvalidationTarget target, std::vector<std::uint64_t> ids)
+        -> boost::asio::awaitable<void>;
+
+    // Pins the links of a new top list in the cache and unpins those that dropped out of it.
+    static void pin_hot_links(UrlCache &cache, std::vector<std::uint64_t> &pinned, const std::vector<HotLink> &links);
+
+    // Records the outcome of a storage operation, entering or leaving degraded mode.
+    void on_backend_result(bool ok) const noexcept;
+
+    // Called from a catch block: counts the failure and rethrows it as BackendUnavailable.
+    [[noreturn]] void rethrow_unavailable() const;
+
+    // Fetches a URL from the backend and records the outcome in the cache or negative filter.
+    [[nodiscard]] auto fetch_url(std::uint64_t id) const -> boost::asio::awaitable<CachedUrl>;
+
+    // Runs the backend's deduplicated create and records the new link locally.
+    [[nodiscard]] auto create_deduplicated(UrlDigest digest, std::string_view url) const
+        -> boost::asio::awaitable<CreatedUrl>;
+
+    // Reads the backend's ID counter and raises the lookup filter's high-water mark, unless the refresh is
+    // rate-limited. Concurrent callers share one refresh.
+    [[nodiscard]] auto refresh_high_water() const -> boost::asio::awaitable<HighWaterRefresh>;
+
+    // Refreshes the high-water mark for a lookup of `id` that arrived at `arrived`. Returns true if a refresh
+    // started after that still left `id` above the mark, i.e. `id` had not been issued when the lookup arrived.
+    [[nodiscard]] auto confirm_above_high_water(std::uint64_t id, std::chrono::steady_clock::time_point arrived) const
+        -> boost::asio::awaitable<bool>;
+
+    /// @brief The storage backend shared by all copies of this service
+    std::shared_ptr<Backend> backend_;
+
+    /// @brief Block-leasing ID allocator shared by all copies of this service
+    std::shared_ptr<IdAllocator> id_allocator_;
 
-    /// @brief Logger for Redis operations (mutable to allow logging in const methods)
+    /// @brief Redirect cache shared by all copies of this service (null if disabled)
+    std::shared_ptr<UrlCache> url_cache_;
+
+    /// @brief Links dropped by tracking flushes, served only while storage fails (null if disabled)
+    std::shared_ptr<UrlCache> stale_cache_;
+
+    /// @brief High-water mark and negative cache shared by all copies of this service
+    std::shared_ptr<LookupFilter> lookup_filter_;
+
+    /// @brief In-flight get_url fetches, shared by all copies of this service
+    std::shared_ptr<SingleFlight<std::uint64_t, CachedUrl>> url_fetches_;
+
+    /// @brief The in-flight high-water mark refresh (the key is always 0), shared by all copies of this service
+    std::shared_ptr<SingleFlight<int, HighWaterRefresh>> high_water_refreshes_;
+
+    /// @brief Invalidation counters guarding cache inserts against racing invalidations (null if not tracking)
+    std::shared_ptr<InvalidationEpochs> invalidation_epochs_;
+
+    /// @brief Saves and restores the cache's hot set, shared by all copies of this service (null if disabled)
+    std::shared_ptr<CacheSnapshotter> snapshotter_;
+
+    /// @brief Per-thread click counts awaiting their flush, shared by all copies of this service (null if disabled)
+    std::shared_ptr<ClickCounter> click_counter_;
+
+    /// @brief Per-thread sketches of the redirect stream, shared by all copies of this service (null if disabled)
+    std::shared_ptr<HotLinkTracker> hot_links_;
+
+    /// @brief Codec applied to URLs on their way into and out of the backend
+    std::shared_ptr<const UrlCodec> url_codec_;
+
+    /// @brief Whether create_url() uses the backend's atomic create
+    bool atomic_create_;
+
+    /// @brief Whether find_or_create_url() deduplicates
+    bool dedup_;
+
+    /// @brief Recently created links by URL digest, shared by all copies of this service (null if disabled)
+    std::shared_ptr<DedupCache> dedup_cache_;
+
+    /// @brief In-flight deduplicated creates, shared by all copies of this service
+    std::shared_ptr<SingleFlight<UrlDigest, CreatedUrl, DigestHash>> dedup_creates_;
+
+    /// @brief Deduplication counters shared by all copies of this service
+    struct DedupCounters
+    {
+        std::atomic<std::uint64_t> local_hits{0};
+        std::atomic<std::uint64_t> remote_hits{0};
+        std::atomic<std::uint64_t> created{0};
+    };
+    std::shared_ptr<DedupCounters> dedup_counters_;
+
+    /// @brief Storage health and degraded-mode counters shared by all copies of this service
+    struct Health
+    {
+        std::atomic<bool> degraded{false};
+        std::atomic<std::chrono::steady_clock::rep> last_failure{0}; // steady_clock ticks since its epoch
+        std::atomic<std::uint64_t> episodes{0};
+        std::atomic<std::uint64_t> failed_ops{0};
+        std::atomic<std::uint64_t> stale_hits{0};
+    };
+    std::shared_ptr<Health> health_;
+
+    /// @brief Logger for storage operations (mutable to allow logging in const methods)
     mutable logging::logger_t logger_;
 
-    // Redis key constants
-    static constexpr std::string_view kCounterKey = "url_counter";
-    static constexpr std::string_view kUrlPrefix = "url:";
+    // Cache shards per io thread; keeps lock contention low on the lookup path
+    static constexpr std::size_t kCacheShardsPerThread = 4;
+
+    // Retry-After sent with failures that are not the circuit breaker's
+    static constexpr std::chrono::seconds kUnavailableRetryAfter{1};
+
+    // How long a degraded episode lasts after its last failure without a successful storage call
+    static constexpr std::chrono::seconds kDegradedHold{5};
 };
 
 } // namespace storage
\ No newline at end of file
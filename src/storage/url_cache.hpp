@@ -0,0 +1,46 @@
+#pragma once
+
+#include "slru_cache.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+namespace storage
+{
+
+/**
+ * @brief An immutable, shared URL.
+ *
+ * Cache hits hand out another reference instead of copying the string, so
+ * serving a cached redirect does not allocate.
+ */
+using CachedUrl = std::shared_ptr<const std::string>;
+
+/// @brief Wraps a URL for the cache.
+[[nodiscard]] inline auto make_cached_url(std::string url) -> CachedUrl
+{
+    return std::make_shared<const std::string>(std::move(url));
+}
+
+/**
+ * @brief Estimates the memory footprint of one cached id→URL entry.
+ *
+ * Accounts for the URL bytes plus a fixed overhead covering the list node,
+ * the index node, the bucket pointer and the shared string's control block.
+ */
+struct UrlWeigher
+{
+    static constexpr std::size_t kEntryOverhead = 160;
+
+    auto operator()([[maybe_unused]] std::uint64_t id, const CachedUrl &url) const noexcept -> std::size_t
+    {
+        return kEntryOverhead + url->size();
+    }
+};
+
+/// @brief In-process cache of redirect targets keyed by decoded short code id.
+using UrlCache = SlruCache<std::uint64_t, CachedUrl, UrlWeigher>;
+
+} // namespace storage
@@ -0,0 +1,161 @@
+#include "url_codec.hpp"
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+
+using namespace std::string_view_literals;
+
+namespace storage
+{
+
+namespace
+{
+// Version 1: common schemes, hosts, paths, tracking parameters and escapes. Never edit a released
+// dictionary; stored values refer to its tokens by index.
+constexpr std::array<std::string_view, 128> kDictionaryV1{
+    "https://www."sv, "http://www."sv, "https://"sv, "http://"sv, "www."sv, ".com/"sv, ".org/"sv, ".net/"sv,
+    ".io/"sv, ".co.uk/"sv, ".de/"sv, ".html"sv, ".php"sv, ".aspx"sv, "?utm_source="sv, "&utm_source="sv,
+    "&utm_medium="sv, "&utm_campaign="sv, "&utm_content="sv, "&utm_term="sv, "utm_"sv, "newsletter"sv, "email"sv,
+    "social"sv, "campaign"sv, "organic"sv, "referral"sv, "facebook"sv, "twitter"sv, "linkedin"sv, "instagram"sv,
+    "google"sv, "youtube.com/watch?v="sv, "youtu.be/"sv, "facebook.com/"sv, "instagram.com/"sv, "twitter.com/"sv,
+    "linkedin.com/"sv, "amazon."sv, "github.com/"sv, "medium.com/"sv, "reddit.com/r/"sv, "wikipedia.org/wiki/"sv,
+    "docs.google.com/"sv, "drive.google.com/"sv, "tiktok.com/@"sv, "substack.com/p/"sv, "?fbclid="sv, "&fbclid="sv,
+    "?gclid="sv, "&gclid="sv, "?ref="sv, "&ref="sv, "?id="sv, "&id="sv, "?q="sv, "&q="sv, "&page="sv, "&lang="sv,
+    "&sort="sv, "&source="sv, "&v="sv, "&t="sv, "&s="sv, "=true"sv, "=false"sv, "/products/"sv, "/product/"sv,
+    "/articles/"sv, "/article/"sv, "/blog/"sv, "/posts/"sv, "/post/"sv, "/news/"sv, "/search?"sv, "/category/"sv,
+    "/collections/"sv, "/watch?v="sv, "/p/"sv, "/en/"sv, "/en-us/"sv, "/api/"sv, "/docs/"sv, "/download"sv,
+    "/images/"sv, "/static/"sv, "/wp-content/uploads/"sv, "/status/"sv, "/user/"sv, "/account/"sv, "/login"sv,
+    "/dp/"sv, "/gp/product/"sv, "/item/"sv, "/events/"sv, "/jobs/"sv, "/index"sv, "/2024/"sv, "/2025/"sv,
+    "/2026/"sv, "%20"sv, "%2F"sv, "%3A"sv, "%3D"sv, "%26"sv, "%3F"sv, "%2C"sv, "%25"sv, "-the-"sv, "-and-"sv,
+    "-to-"sv, "-of-"sv, "-in-"sv, "-for-"sv, "-with-"sv, "-how-"sv, "tion"sv, "ing"sv, "ment"sv, ".jpg"sv, ".png"sv,
+    ".pdf"sv, ".com"sv, "share"sv, "?s="sv, "mail"sv, "click"sv, "&cid="sv,
+};
+
+// Index i holds dictionary version i + 1; the last one is used for new values.
+constexpr std::array<std::span<const std::string_view>, 1> kDictionaries{kDictionaryV1};
+} // namespace
+
+UrlCodec::UrlCodec(bool compress) : compress_{compress}
+{
+    const auto dictionary = kDictionaries.back();
+    for (std::size_t i = 0; i < dictionary.size(); ++i)
+    {
+        candidates_[static_cast<unsigned char>(dictionary[i].front())].push_back(static_cast<std::uint8_t>(i));
+    }
+    for (auto &tokens : candidates_)
+    {
+        std::ranges::stable_sort(tokens, std::ranges::greater{},
+                                 [&](std::uint8_t index) { return dictionary[index].size(); });
+    }
+}
+
+auto UrlCodec::current_version() noexcept -> std::uint8_t
+{
+    return static_cast<std::uint8_t>(kDictionaries.size());
+}
+
+auto UrlCodec::encode(std::string_view url) const -> std::string
+{
+    // A plain value starting with the marker would be misread as compressed, so it is always encoded.
+    const bool must_encode = !url.empty() && url.front() == kMarker;
+    if (!compress_ && !must_encode)
+    {
+        return std::string{url};
+    }
+
+    auto encoded = compress(url);
+    if (encoded.size() >= url.size() && !must_encode)
+    {
+        return std::string{url};
+    }
+
+    encoded_.fetch_add(1, std::memory_order_relaxed);
+    raw_bytes_.fetch_add(url.size(), std::memory_order_relaxed);
+    encoded_bytes_.fetch_add(encoded.size(), std::memory_order_relaxed);
+    return encoded;
+}
+
+auto UrlCodec::compress(std::string_view url) const -> std::string
+{
+    const auto dictionary = kDictionaries.back();
+
+    std::string out;
+    out.reserve(url.size() + 2);
+    out.push_back(kMarker);
+    out.push_back(static_cast<char>(current_version()));
+
+    std::size_t pos = 0;
+    while (pos < url.size())
+    {
+        const auto c = static_cast<unsigned char>(url[pos]);
+
+        // Greedy longest match; candidates are sorted longest first.
+        const auto &tokens = candidates_[c];
+        const auto match = std::ranges::find_if(
+            tokens, [&](std::uint8_t index) { return url.substr(pos).starts_with(dictionary[index]); });
+        if (match != tokens.end())
+        {
+            out.push_back(static_cast<char>(kTokenBase + *match));
+            pos += dictionary[*match].size();
+            continue;
+        }
+
+        if (c >= kEscape)
+        {
+            out.push_back(static_cast<char>(kEscape));
+        }
+        out.push_back(static_cast<char>(c));
+        ++pos;
+    }
+    return out;
+}
+
+auto UrlCodec::decode(std::string value) const -> std::string
+{
+    if (value.empty() || value.front() != kMarker)
+    {
+        return value; // stored uncompressed
+    }
+
+    const auto version = value.size() > 1 ? static_cast<unsigned char>(value[1]) : 0U;
+    if (version == 0 || version > kDictionaries.size())
+    {
+        throw std::runtime_error("Stored URL uses an unknown dictionary version");
+    }
+    const auto dictionary = kDictionaries[version - 1];
+
+    std::string out;
+    out.reserve(value.size() * 2);
+    for (std::size_t pos = 2; pos < value.size(); ++pos)
+    {
+        const auto c = static_cast<unsigned char>(value[pos]);
+        if (c >= kTokenBase)
+        {
+            out.append(dictionary[c - kTokenBase]);
+        }
+        else if (c == kEscape)
+        {
+            if (++pos == value.size())
+            {
+                throw std::runtime_error("Stored URL is truncated");
+            }
+            out.push_back(value[pos]);
+        }
+        else
+        {
+            out.push_back(static_cast<char>(c));
+        }
+    }
+    return out;
+}
+
+auto UrlCodec::stats() const noexcept -> UrlCodecStats
+{
+    return UrlCodecStats{
+        .encoded = encoded_.load(std::memory_order_relaxed),
+        .raw_bytes = raw_bytes_.load(std::memory_order_relaxed),
+        .encoded_bytes = encoded_bytes_.load(std::memory_order_relaxed),
+    };
+}
+
+} // namespace storage
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace storage
+{
+
+/**
+ * @brief Counters of a UrlCodec.
+ */
+struct UrlCodecStats
+{
+    std::uint64_t encoded{0};       ///< Values written in compressed form.
+    std::uint64_t raw_bytes{0};     ///< Size of those values before compression.
+    std::uint64_t encoded_bytes{0}; ///< Size of those values after compression.
+};
+
+/**
+ * @brief Compresses URLs with a versioned, shared token dictionary.
+ *
+ * Tracking URLs repeat the same schemes, hosts, paths and query parameters
+ * (`https://www.`, `&utm_campaign=`, ...). The codec replaces dictionary
+ * tokens with one byte each:
+ *
+ *     value   = 0x01 version payload
+ *     payload = { byte 0x00-0x7E (literal)
+ *               | 0x7F byte      (escaped literal)
+ *               | 0x80 + index   (dictionary token) }
+ *
+ * A stored value not starting with 0x01 is a plain URL, so links written
+ * before compression was enabled (or while it is disabled) stay readable.
+ * Dictionaries are never changed once released; a better one is added as a
+ * new version and every older version stays in the table for decoding.
+ */
+class UrlCodec
+{
+  public:
+    /**
+     * @brief Constructs the codec.
+     * @param compress Whether encode() compresses; decode() always understands compressed values.
+     */
+    explicit UrlCodec(bool compress);
+
+    /**
+     * @brief Encodes a URL for storage.
+     *
+     * Returns the URL unchanged when compression is disabled or does not make
+     * it shorter, unless the URL itself starts with the marker byte.
+     */
+    [[nodiscard]] auto encode(std::string_view url) const -> std::string;
+
+    /**
+     * @brief Decodes a stored value back into the URL.
+     * @throws std::runtime_error if the value names an unknown dictionary version or is truncated
+     */
+    [[nodiscard]] auto decode(std::string value) const -> std::string;
+
+    /// @brief Returns the codec's counters.
+    [[nodiscard]] auto stats() const noexcept -> UrlCodecStats;
+
+    /// @brief Gets the dictionary version new values are written with.
+    [[nodiscard]] static auto current_version() noexcept -> std::uint8_t;
+
+  private:
+    static constexpr char kMarker = '\x01';
+    static constexpr unsigned char kEscape = 0x7F;
+    static constexpr unsigned char kTokenBase = 0x80;
+
+    // Compresses with the current dictionary (always marker-prefixed).
+    [[nodiscard]] auto compress(std::string_view url) const -> std::string;
+
+    bool compress_;
+
+    // Token indices of the current dictionary by first byte, longest token first.
+    std::array<std::vector<std::uint8_t>, 256> candidates_;
+
+    mutable std::atomic<std::uint64_t> encoded_{0};
+    mutable std::atomic<std::uint64_t> raw_bytes_{0};
+    mutable std::atomic<std::uint64_t> encoded_bytes_{0};
+};
+
+} // namespace storage
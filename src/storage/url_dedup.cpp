@@ -0,0 +1,71 @@
+#include "url_dedup.hpp"
+#include <algorithm>
+#include <openssl/evp.h>
+#include <stdexcept>
+
+namespace storage
+{
+
+auto normalize_url(std::string_view url) -> std::string
+{
+    std::string normalized{url};
+
+    const auto scheme_end = normalized.find("://");
+    if (scheme_end == std::string::npos)
+    {
+        return normalized;
+    }
+
+    const auto host_begin = scheme_end + 3;
+    auto host_end = normalized.find_first_of("/?#", host_begin);
+    if (host_end == std::string::npos)
+    {
+        host_end = normalized.size();
+    }
+
+    // User info before '@' is case-sensitive; the scheme and the host are not.
+    const auto at = normalized.rfind('@', host_end);
+    const auto host_start = at != std::string::npos && at >= host_begin ? at + 1 : host_begin;
+    const auto lower = [](char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c; };
+    const auto begin = normalized.begin();
+    std::transform(begin, begin + static_cast<std::ptrdiff_t>(scheme_end), begin, lower);
+    std::transform(begin + static_cast<std::ptrdiff_t>(host_start), begin + static_cast<std::ptrdiff_t>(host_end),
+                   begin + static_cast<std::ptrdiff_t>(host_start), lower);
+
+    const std::string_view scheme{normalized.data(), scheme_end};
+    const std::string_view authority{normalized.data() + host_begin, host_end - host_begin};
+    const auto default_port = scheme == "http" ? std::string_view{":80"}
+                              : scheme == "https" ? std::string_view{":443"}
+                                                  : std::string_view{};
+    if (!default_port.empty() && authority.ends_with(default_port))
+    {
+        normalized.erase(host_end - default_port.size(), default_port.size());
+    }
+    return normalized;
+}
+
+auto digest_url(std::string_view url) -> UrlDigest
+{
+    const auto normalized = normalize_url(url);
+    UrlDigest digest{};
+    if (EVP_Digest(normalized.data(), normalized.size(), digest.data(), nullptr, EVP_sha256(), nullptr) != 1)
+    {
+        throw std::runtime_error("Failed to compute SHA256 digest of URL");
+    }
+    return digest;
+}
+
+auto to_hex(const UrlDigest &digest) -> std::string
+{
+    constexpr std::string_view kHexDigits = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(digest.size() * 2);
+    for (const auto byte : digest)
+    {
+        hex.push_back(kHexDigits[byte >> 4U]);
+        hex.push_back(kHexDigits[byte & 0x0fU]);
+    }
+    return hex;
+}
+
+} // namespace storage
@@ -0,0 +1,73 @@
+#pragma once
+
+#include "slru_cache.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+namespace storage
+{
+
+/// @brief A SHA-256 digest of a normalized URL.
+using UrlDigest = std::array<unsigned char, 32>;
+
+/**
+ * @brief Counters of create-time deduplication.
+ */
+struct DedupStats
+{
+    std::uint64_t local_hits{0};  ///< Creates answered from the local cache of recent URLs.
+    std::uint64_t remote_hits{0}; ///< Creates answered from the storage reverse index.
+    std::uint64_t created{0};     ///< Creates that stored a new link.
+};
+
+/**
+ * @brief Normalizes a URL so trivially different spellings deduplicate.
+ *
+ * Lowercases the scheme and host and drops the default port (`:80` for
+ * http, `:443` for https). Paths, queries and fragments are case-sensitive
+ * and kept as they are.
+ */
+[[nodiscard]] auto normalize_url(std::string_view url) -> std::string;
+
+/**
+ * @brief Returns the SHA-256 digest of the normalized URL.
+ *
+ * The reverse index trusts digests to identify URLs, so they must not collide,
+ * not even for URLs crafted to collide.
+ * @throws std::runtime_error If OpenSSL fails to compute the digest.
+ */
+[[nodiscard]] auto digest_url(std::string_view url) -> UrlDigest;
+
+/// @brief Formats a digest as 64 lowercase hex digits (the reverse index key suffix).
+[[nodiscard]] auto to_hex(const UrlDigest &digest) -> std::string;
+
+struct DigestHash
+{
+    auto operator()(const UrlDigest &digest) const noexcept -> std::size_t
+    {
+        // The digest is uniformly distributed, so any of its bytes make a good hash.
+        std::size_t hash = 0;
+        std::memcpy(&hash, digest.data(), sizeof(hash));
+        return hash;
+    }
+};
+
+struct DigestWeigher
+{
+    static constexpr std::size_t kEntryOverhead = 96;
+
+    auto operator()([[maybe_unused]] const UrlDigest &digest, [[maybe_unused]] std::uint64_t id) const noexcept
+        -> std::size_t
+    {
+        return kEntryOverhead;
+    }
+};
+
+/// @brief In-process cache of recently created links keyed by URL digest.
+using DedupCache = SlruCache<UrlDigest, std::uint64_t, DigestWeigher, DigestHash>;
+
+} // namespace storage
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <limits>
+
+namespace util
+{
+
+namespace detail
+{
+inline std::atomic<std::size_t> next_thread_slot{0};
+inline thread_local std::size_t this_thread_slot = std::numeric_limits<std::size_t>::max();
+} // namespace detail
+
+/**
+ * @brief Returns a small, stable index for the calling thread.
+ *
+ * Threads are numbered 0, 1, 2, ... in the order they first call this
+ * function, unless a slot was assigned explicitly with bind_thread_slot().
+ * Components use it to give each io thread its own shard of per-thread state
+ * (connections, counters) via `thread_slot() % shard_count`.
+ */
+[[nodiscard]] inline auto thread_slot() noexcept -> std::size_t
+{
+    if (detail::this_thread_slot == std::numeric_limits<std::size_t>::max()) [[unlikely]]
+    {
+        detail::this_thread_slot = detail::next_thread_slot.fetch_add(1, std::memory_order_relaxed);
+    }
+    return detail::this_thread_slot;
+}
+
+/**
+ * @brief Assigns an explicit slot to the calling thread.
+ *
+ * Used when threads have a natural index (e.g. one io_context per core), so
+ * that thread `i` maps to shard `i` of every per-thread structure.
+ */
+inline void bind_thread_slot(std::size_t slot) noexcept
+{
+    detail::this_thread_slot = slot;
+}
+
+} // namespace util
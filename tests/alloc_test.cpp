@@ -0,0 +1,216 @@
+#include "conf/conf.hpp"
+#include "encode/encoder.hpp"
+#include "http/handlers/not_found_handler.hpp"
+#include "http/handlers/short_code_handler.hpp"
+#include "http/io_context_pool.hpp"
+#include "http/router.hpp"
+#include "http/server.hpp"
+#include "logging/logger_setup.hpp"
+#include "storage/storage_service.hpp"
+#include <array>
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/executor_work_guard.hpp>
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_future.hpp>
+#include <boost/asio/write.hpp>
+#include <cstdint>
+#include <cstdlib>
+#include <format>
+#include <iostream>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+
+// Counts the heap allocations of cached redirects. Run it with a storage
+// backend that needs no server:
+//
+//   alloc_test --storage-backend log --log-store-path <file>
+//
+// It stores one link and requests its short code over a keep-alive loopback
+// connection served by Server::do_session(), with a router holding only the
+// redirect route. After a warm-up that fills the redirect cache and asio's
+// recycled memory, every operator new on the serving thread is counted; the
+// client and storage's background work run on threads of their own. Exits
+// with a non-zero status if a redirect allocated.
+
+namespace
+{
+// Allocations are only counted while the test measures, and only on the serving thread.
+thread_local bool counting = false;
+thread_local std::uint64_t allocations = 0;
+} // namespace
+
+// The test's global allocation functions: malloc and free, counting while measuring.
+auto operator new(std::size_t size) -> void *
+{
+    if (counting)
+    {
+        ++allocations;
+    }
+    if (auto *pointer = std::malloc(size == 0 ? 1 : size))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+auto operator new(std::size_t size, std::align_val_t alignment) -> void *
+{
+    if (counting)
+    {
+        ++allocations;
+    }
+    // aligned_alloc() wants a size that is a multiple of the alignment.
+    const auto align = static_cast<std::size_t>(alignment);
+    if (auto *pointer = std::aligned_alloc(align, size == 0 ? align : (size + align - 1) / align * align))
+    {
+        return pointer;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void *pointer) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t /*size*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::align_val_t /*alignment*/) noexcept
+{
+    std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t /*size*/, std::align_val_t /*alignment*/) noexcept
+{
+    std::free(pointer);
+}
+
+namespace
+{
+using tcp = boost::asio::ip::tcp;
+
+constexpr std::string_view kUrl = "https://example.com/alloc-test";
+constexpr int kWarmupRedirects = 1000;
+constexpr int kMeasuredRedirects = 10000;
+
+// Sends one request and reads the response up to the end of its header block (redirects have no body).
+// Returns true if it is a redirect.
+auto round_trip(tcp::socket &client, std::string_view request, std::array<char, 1024> &response) -> bool
+{
+    boost::asio::write(client, boost::asio::buffer(request));
+
+    std::size_t size = 0;
+    while (!std::string_view{response.data(), size}.ends_with("\r\n\r\n"))
+    {
+        if (size == response.size())
+        {
+            return false;
+        }
+        size += client.read_some(boost::asio::buffer(response.data() + size, response.size() - size));
+    }
+    return std::string_view{response.data(), size}.starts_with("HTTP/1.1 302");
+}
+
+// Sends `count` requests, throwing if one is not redirected.
+void redirect(tcp::socket &client, std::string_view request, int count)
+{
+    std::array<char, 1024> response{};
+    for (int i = 0; i < count; ++i)
+    {
+        if (!round_trip(client, request, response))
+        {
+            throw std::runtime_error{"The short code was not redirected"};
+        }
+    }
+}
+
+auto run(const conf::Config &config, logging::logger_t &logger) -> int
+{
+    // Storage runs its background work (flushes, merges, connections) on a thread of its own.
+    boost::asio::io_context storage_context;
+    auto storage_work = boost::asio::make_work_guard(storage_context);
+    storage::StorageService storage{storage_context.get_executor(), logger, config, {storage_context.get_executor()}};
+    storage.start();
+    std::thread storage_thread{[&storage_context] { storage_context.run(); }};
+
+    http::IoContextPool io_contexts{1, false, {}, logger};
+    auto &context = io_contexts.context(0);
+    auto serving_work = boost::asio::make_work_guard(context);
+    const encode::Encoder encoder{};
+
+    using http::beast::http::verb;
+    const http::StaticRouter router{
+        http::handler::NotFoundHandler{},
+        http::route<verb::get, "/{code}">(http::handler::ShortCodeHandler{context.get_executor(), encoder, storage})};
+    http::Server server{config, logger, router, io_contexts};
+
+    // One keep-alive connection over loopback, served like any accepted connection.
+    tcp::acceptor acceptor{context, {boost::asio::ip::address_v4::loopback(), 0}};
+    boost::asio::io_context client_context; // The client's operations are synchronous; this is never run.
+    tcp::socket client{client_context};
+    client.connect(acceptor.local_endpoint());
+    boost::asio::co_spawn(context, server.do_session(boost::beast::tcp_stream{acceptor.accept()}),
+                          boost::asio::detached);
+    std::thread serving_thread{[&context] { context.run(); }};
+
+    const auto id = boost::asio::co_spawn(context, storage.create_url(kUrl), boost::asio::use_future).get();
+    const auto request = std::format("GET /{} HTTP/1.1\r\nHost: localhost\r\n\r\n", encoder.encode(id));
+
+    redirect(client, request, kWarmupRedirects);
+    boost::asio::post(context, boost::asio::use_future([] {
+                          allocations = 0;
+                          counting = true;
+                      }))
+        .get();
+    redirect(client, request, kMeasuredRedirects);
+    const auto counted = boost::asio::post(context, boost::asio::use_future([] {
+                                               counting = false;
+                                               return allocations;
+                                           }))
+                             .get();
+
+    client.close();
+    serving_work.reset();
+    storage_work.reset();
+    context.stop();
+    storage_context.stop();
+    serving_thread.join();
+    storage_thread.join();
+
+    std::cout << std::format("Cached redirects:  {}\n", kMeasuredRedirects);
+    std::cout << std::format("Allocations:       {} ({:.2f} per redirect)\n", counted,
+                             static_cast<double>(counted) / kMeasuredRedirects);
+    return counted == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+} // namespace
+
+auto main(int argc, const char *argv[]) -> int
+{
+    conf::Config config;
+    if (auto result = config.load(argc, argv); !result)
+    {
+        std::cerr << "Error: Invalid configuration\n";
+        return EXIT_FAILURE;
+    }
+
+    try
+    {
+        logging::setup(config);
+        logging::logger_t logger;
+        return run(config, logger);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << std::format("Allocation test failed: {}\n", e.what());
+        return EXIT_FAILURE;
+    }
+}